@@ -109,11 +109,12 @@ else
 end
 
 % additional libraries:
-% (libut for ctrl-c detection, libdl for dynamic linkage on linux machines)
+% (libut for ctrl-c detection, libdl for dynamic linkage on linux machines,
+%  libpthread for worker threads)
 if ispc
     buildargs = [buildargs ' user32.lib advapi32.lib libut.lib'];
 else
-    buildargs = [buildargs ' -ldl -lut'];
+    buildargs = [buildargs ' -ldl -lut -lpthread'];
 end
 
 % Get computer architecture
@@ -52,9 +52,19 @@
         RESULT_TYPE_ARRAYOFSTRUCTS, ///< 0-Array of structs
         RESULT_TYPE_STRUCTOFARRAYS, ///< 1-Struct of arrays
         RESULT_TYPE_MATRIX,         ///< 2-Matrix/cell array
+        RESULT_TYPE_TYPEDCOLUMNS,   ///< 3-Struct of typed arrays (int64/double, NULL masks)
     
         /// Limit for bound checking only
-        RESULT_TYPE_MAX_ID = RESULT_TYPE_MATRIX
+        RESULT_TYPE_MAX_ID = RESULT_TYPE_TYPEDCOLUMNS
+    };
+
+    /**
+     * \brief text dictionary modes (TEXT columns of struct of arrays results)
+     */
+    enum TEXT_DICTIONARY_MODES {
+        TEXT_DICTIONARY_OFF,        ///< 0-Cell array of strings
+        TEXT_DICTIONARY_CODES,      ///< 1-Integer codes and cellstr dictionary
+        TEXT_DICTIONARY_CATEGORICAL ///< 2-MATLAB categorical array
     };
 
     #define MKSQLITE_CONFIG_VERSION_STRING           MKSQLITE_VERSION_MAJOR "." MKSQLITE_VERSION_MINOR    /**< mksqlite version string */
@@ -80,6 +90,48 @@
     /// Wrap parameters
     #define MKSQLITE_CONFIG_PARAM_WRAPPING           OFF                         ///< paramter wrapping is off by default
 
+    /// Number of prepared statements cached per database for reuse
+    #define MKSQLITE_CONFIG_STMT_CACHE_SIZE          0                           ///< statement cache is off by default
+
+    /// Number of rows committed per transaction for repeated executions (parameter wrapping)
+    #define MKSQLITE_CONFIG_AUTOTRANSACTION          0                           ///< automatic transactions are off by default
+
+    /// Map declared column types (INT16, REAL4, BOOL, ...) to MATLAB classes
+    #define MKSQLITE_CONFIG_DECLTYPE_CLASSES         OFF                         ///< off by default
+
+    /// Return NULL masks for numeric columns of result types 1 and 2, instead of cell arrays
+    #define MKSQLITE_CONFIG_NULL_MASK                OFF                         ///< off by default
+
+    /// Dictionary encoding of TEXT columns (struct of arrays results)
+    #define MKSQLITE_CONFIG_TEXT_DICTIONARY          TEXT_DICTIONARY_OFF         ///< off by default
+
+    /// Number of threads decompressing typed BLOBs (1 means no worker threads)
+    #define MKSQLITE_CONFIG_THREADS                  1                           ///< no worker threads by default
+
+    /// Raw data of typed BLOB parameters compressed in advance by worker threads
+    #define MKSQLITE_CONFIG_PACK_AHEAD_SIZE          (16*1024*1024)              ///< 16 MB per window
+
+    /// Max. number of read-only connections per database, used by tickets and parallel queries
+    #define MKSQLITE_CONFIG_READER_POOL              0                           ///< reader pool is off by default
+
+    /// Collect performance counters per database (see 'stats')
+    #define MKSQLITE_CONFIG_STATS                    OFF                         ///< off by default
+
+    /// Log statements running longer than this (seconds) to the log file, 0 turns off (see 'slow_query_log')
+    #define MKSQLITE_CONFIG_SLOW_QUERY_TIME          0                           ///< off by default
+
+    /// Log file is rotated when it exceeds this size (bytes), 0 turns rotation off
+    #define MKSQLITE_CONFIG_LOG_MAX_SIZE             (4*1024*1024)               ///< 4 MB
+
+    /// Number of rotated log files kept (mksqlite.log.1, mksqlite.log.2, ...)
+    #define MKSQLITE_CONFIG_LOG_BACKUPS              3                           ///< 3 backups
+
+    /// Queries are aborted, when their result buffers exceed this size (bytes), 0 turns the cap off
+    #define MKSQLITE_CONFIG_RESULT_MEMORY_CAP        0                           ///< no cap by default
+
+    /// Pages copied per step by 'load_into_memory' and 'backup', negative copies all at once
+    #define MKSQLITE_CONFIG_BACKUP_PAGES_PER_STEP    256                         ///< 1 MB with 4 KB pages
+
     /// Use blosc library
     #define MKSQLITE_CONFIG_USE_BLOSC                ON                          ///< 
 #endif
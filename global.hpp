@@ -253,28 +253,107 @@ typedef unsigned char byte;  ///< byte type
     #include "logging/src/log.h"
   }
 
-  /// Logger file class. Ensure file is closed at exit
+  /**
+   * \brief Logger file class. Ensure file is closed at exit
+   *
+   * The file is rotated when it exceeds \a MKSQLITE_CONFIG_LOG_MAX_SIZE bytes:
+   * mksqlite.log is renamed to mksqlite.log.1, mksqlite.log.1 to mksqlite.log.2
+   * and so on, keeping \a MKSQLITE_CONFIG_LOG_BACKUPS files.
+   */
   class LogFile
   {
-      FILE *fp;
+      FILE *fp;             ///< log file
+      char  m_name[260];    ///< file name
+      long  m_max_size;     ///< rotation size in bytes (0 = never)
+      int   m_backups;      ///< number of rotated files kept
 
   public:
     
-      LogFile(const char* name = NULL)
+      LogFile( const char* name = NULL, long max_size = MKSQLITE_CONFIG_LOG_MAX_SIZE, int backups = MKSQLITE_CONFIG_LOG_BACKUPS )
+      : m_max_size( max_size ), m_backups( backups )
       {
           // todo: Current directory?
-          fp = fopen( ( name ? name : "mksqlite.log" ), "at");
+          snprintf( m_name, sizeof( m_name ), "%s", ( name ? name : "mksqlite.log" ) );
+          fp = fopen( m_name, "at" );
+
+          if( fp )
+          {
+              fseek( fp, 0, SEEK_END );  // ftell() reports the current size
+          }
       }
 
       ~LogFile()
       {
-          fclose(fp);
+          if( fp )
+          {
+              fclose( fp );
+          }
       }
 
       FILE* get_fp()
       {
           return fp;
       }
+
+      /// Close the file, shift all backups by one and start a new file
+      void rotate()
+      {
+          char from[280], to[280];
+
+          if( fp )
+          {
+              fclose( fp );
+          }
+
+          for( int i = m_backups; i > 0; i-- )
+          {
+              snprintf( to, sizeof( to ), "%s.%d", m_name, i );
+
+              if( i > 1 )
+              {
+                  snprintf( from, sizeof( from ), "%s.%d", m_name, i - 1 );
+              }
+              else
+              {
+                  snprintf( from, sizeof( from ), "%s", m_name );
+              }
+
+              remove( to );     // rename() fails on existing files (Windows)
+              rename( from, to );
+          }
+
+          // Without backups the file is just truncated
+          fp = fopen( m_name, m_backups > 0 ? "at" : "wt" );
+      }
+
+      /// Callback for log_add_callback(), writes one event and rotates the file if necessary
+      static
+      void callback( log_Event* ev )
+      {
+          LogFile* self = (LogFile*)ev->udata;
+          char     buf[64];
+
+          if( !self || !self->fp )
+          {
+              return;
+          }
+
+          if( self->m_max_size > 0 && ftell( self->fp ) >= self->m_max_size )
+          {
+              self->rotate();
+
+              if( !self->fp )
+              {
+                  return;
+              }
+          }
+
+          buf[strftime( buf, sizeof( buf ), "%Y-%m-%d %H:%M:%S", ev->time )] = '\0';
+          fprintf( self->fp, "%s %-5s %s:%d: ", buf, log_level_string( ev->level ), ev->file, ev->line );
+          vfprintf( self->fp, ev->fmt, ev->ap );
+          fprintf( self->fp, "\n" );
+          fflush( self->fp );
+      }
   };
 #endif
 
@@ -320,6 +399,36 @@ const double    g_NaN                   = DBL_NAN;
     /// Wrap parameters
     int             g_param_wrapping        = MKSQLITE_CONFIG_PARAM_WRAPPING;
 
+    /// Max. number of cached prepared statements per database
+    int             g_stmt_cache_size       = MKSQLITE_CONFIG_STMT_CACHE_SIZE;
+
+    /// Max. number of rows per automatic transaction (parameter wrapping)
+    int             g_autotransaction       = MKSQLITE_CONFIG_AUTOTRANSACTION;
+
+    /// Flag: Map declared column types to MATLAB classes
+    int             g_decltype_classes      = MKSQLITE_CONFIG_DECLTYPE_CLASSES;
+
+    /// Flag: Return NULL masks for numeric columns (result types 1 and 2)
+    int             g_null_mask             = MKSQLITE_CONFIG_NULL_MASK;
+
+    /// Dictionary encoding of TEXT columns (struct of arrays results)
+    int             g_text_dictionary       = MKSQLITE_CONFIG_TEXT_DICTIONARY;
+
+    /// Number of threads decompressing typed BLOBs
+    int             g_threads               = MKSQLITE_CONFIG_THREADS;
+
+    /// Max. number of read-only connections per database (reader pool)
+    int             g_reader_pool_size      = MKSQLITE_CONFIG_READER_POOL;
+
+    /// Flag: Collect performance counters per database
+    int             g_stats                 = MKSQLITE_CONFIG_STATS;
+
+    /// Statements running longer than this (seconds) are logged, 0 = off
+    double          g_slow_query_time       = MKSQLITE_CONFIG_SLOW_QUERY_TIME;
+
+    /// Max. size of the result buffers of a query (bytes), 0 = no limit
+    double          g_result_memory_cap     = MKSQLITE_CONFIG_RESULT_MEMORY_CAP;
+
 #endif  // defined( MATLAB_MEX_FILE )
 
 #endif  // defined( MAIN_MODULE )
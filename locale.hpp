@@ -109,6 +109,18 @@ int           getLocale     ();
 #define MSG_ERRNULLDBID                 51
 #define MSG_ERRINTERNAL                 52
 #define MSG_ABORTED                     53
+#define MSG_INVALIDSTMTHANDLE           54
+#define MSG_ERRCATEGORICAL              55
+#define MSG_INVALIDBLOBHANDLE           56
+#define MSG_ERRBLOBRANGE                57
+#define MSG_INVALIDTICKET               58
+#define MSG_NODBFILE                    59
+#define MSG_NOREADER                    60
+#define MSG_NOLOGGING                   61
+#define MSG_RESULTCAP                   62
+#define MSG_ERRUNKOPENOPTION            63
+#define MSG_ERRSERIALIZE                64
+#define MSG_ERRDESERIALIZEMODE          65
 /** @}  */
 
 
@@ -384,6 +396,18 @@ static const char* messages_0[] =
 /* 51*/    "dbid of 0 only allowed for commands 'open' and 'close'!",
 /* 52*/    "Internal error!",
 /* 53*/    "Aborted (Ctrl+C)!",
+/* 54*/    "invalid statement handle!",
+/* 55*/    "can't create categorical array (MATLAB R2013b or later required)!",
+/* 56*/    "invalid BLOB handle!",
+/* 57*/    "range exceeds BLOB size!",
+/* 58*/    "invalid ticket!",
+/* 59*/    "database file required (no in-memory or temporary database)!",
+/* 60*/    "no connection of the reader pool available (see 'reader_pool')!",
+/* 61*/    "logging not available (compiled without MKSQLITE_CONFIG_USE_LOGGING)!",
+/* 62*/    "query result exceeds the memory cap (see 'result_memory_cap')!",
+/* 63*/    "unknown open profile or setting (profiles 'default', 'bulkload', 'analytics', 'safe')",
+/* 64*/    "database cannot be serialized (unknown schema or out of memory)",
+/* 65*/    "unknown deserialize mode (only 'readonly' or 'resizeable' accepted)",
 };
 
 
@@ -460,6 +484,18 @@ static const char* messages_1[] =
 /* 51*/    "0 als dbid ist nur fuer die Befehle 'open' und 'close' erlaubt! ",
 /* 52*/    "Interner Fehler! ",
 /* 53*/    "Ausfuehrung abgebrochen (Ctrl+C)!",
+/* 54*/    "ungueltiges Statement-Handle!",
+/* 55*/    "kann kategoriales Array nicht erzeugen (erfordert MATLAB R2013b oder neuer)!",
+/* 56*/    "ungueltiges BLOB-Handle!",
+/* 57*/    "Bereich ueberschreitet BLOB-Groesse!",
+/* 58*/    "ungueltiges Ticket!",
+/* 59*/    "Datenbankdatei erforderlich (keine In-Memory- oder temporaere Datenbank)!",
+/* 60*/    "keine Verbindung des Leser-Pools verfuegbar (siehe 'reader_pool')!",
+/* 61*/    "Logging nicht verfuegbar (ohne MKSQLITE_CONFIG_USE_LOGGING kompiliert)!",
+/* 62*/    "Abfrageergebnis ueberschreitet die Speichergrenze (siehe 'result_memory_cap')!",
+/* 63*/    "unbekanntes Profil oder unbekannte Einstellung (Profile 'default', 'bulkload', 'analytics', 'safe')",
+/* 64*/    "Datenbank kann nicht serialisiert werden (unbekanntes Schema oder Speichermangel)",
+/* 65*/    "unbekannter Deserialisierungsmodus (nur 'readonly' oder 'resizeable' moeglich)",
 };
 
 /**
@@ -469,7 +505,8 @@ static const char* messages_1[] =
 const char* STR_RESULT_TYPES[] = {
     "array of structs",   // RESULT_TYPE_ARRAYOFSTRUCTS
     "struct of arrays",   // RESULT_TYPE_STRUCTOFARRAYS  
-    "matrix/cell array"   // RESULT_TYPE_MATRIX
+    "matrix/cell array",  // RESULT_TYPE_MATRIX
+    "typed columns"       // RESULT_TYPE_TYPEDCOLUMNS
 };
 
 
@@ -133,15 +133,108 @@ public:
         {
             for( int i = 0; i < COUNT_DB; i++ )
             {
-                PRINTF( "DB Handle %d: %s\n", i+1, m_db[i].isOpen() ? "OPEN" : "CLOSED" );
+                printStatus( i );
             }
         }
         else
         {
             dbid = (dbid_req > 0) ? dbid_req : dbid;
-            PRINTF( "DB Handle %d: %s\n", dbid, m_db[dbid-1].isOpen() ? "OPEN" : "CLOSED" );
+            printStatus( dbid-1 );
         }
     }
+
+
+    /// Outputs current status of database slot \p index (base 0)
+    void printStatus( int index )
+    {
+        if( m_db[index].isOpen() && g_stmt_cache_size > 0 )
+        {
+            SQLstmtCache& cache = m_db[index].stmtCache();
+
+            PRINTF( "DB Handle %d: OPEN (statement cache: %d entries, %.0f hits, %.0f misses)\n",
+                    index+1, cache.size(), cache.hits(), cache.misses() );
+        }
+        else
+        {
+            PRINTF( "DB Handle %d: %s\n", index+1, m_db[index].isOpen() ? "OPEN" : "CLOSED" );
+        }
+
+        if( m_db[index].isOpen() && m_db[index].autoTransactionBatches() > 0 )
+        {
+            PRINTF( "             automatic transactions: %.0f batches, %.0f rows committed\n",
+                    m_db[index].autoTransactionBatches(), m_db[index].autoTransactionRows() );
+        }
+
+        if( m_db[index].isOpen() && m_db[index].readerCount() > 0 )
+        {
+            PRINTF( "             reader pool: %d connections\n", m_db[index].readerCount() );
+        }
+
+        SQLopenOptions& options = m_db[index].openOptions();
+
+        if( m_db[index].isOpen() && ( !options.m_profile.empty() || !options.m_applied.empty() ) )
+        {
+            string settings;
+
+            for( int i = 0; i < (int)options.m_applied.size(); i++ )
+            {
+                settings += ( i ? ", " : "" ) + options.m_applied[i].first + "=" + options.m_applied[i].second;
+            }
+
+            PRINTF( "             open profile: %s (%s)\n", 
+                    options.m_profile.empty() ? "none" : options.m_profile.c_str(), settings.c_str() );
+        }
+    }
+
+
+    /**
+     * \brief Returns a struct array with status details for each database slot
+     *
+     * \param[in] dbid_req Requested database id, 0 for all slots
+     * \param[in] dbid Selected database id (base 1)
+     */
+    mxArray* createStatusInfo( int dbid_req, int dbid )
+    {
+        static const char* fieldnames[] = { "stmt_cache_entries", "stmt_cache_hits", "stmt_cache_misses",
+                                            "autotransaction_batches", "autotransaction_rows", "reader_connections",
+                                            "open_profile", "open_settings" };
+
+        int first = ( dbid_req == 0 ) ? 0 : dbid-1;
+        int count = ( dbid_req == 0 ) ? COUNT_DB : 1;
+
+        mxArray* info = mxCreateStructMatrix( count, 1, sizeof( fieldnames ) / sizeof( fieldnames[0] ), fieldnames );
+
+        for( int i = 0; info && i < count; i++ )
+        {
+            SQLstmtCache& cache = m_db[first+i].stmtCache();
+
+            mxSetField( info, i, "stmt_cache_entries", mxCreateDoubleScalar( (double)cache.size() ) );
+            mxSetField( info, i, "stmt_cache_hits",    mxCreateDoubleScalar( cache.hits() ) );
+            mxSetField( info, i, "stmt_cache_misses",  mxCreateDoubleScalar( cache.misses() ) );
+            mxSetField( info, i, "autotransaction_batches", mxCreateDoubleScalar( m_db[first+i].autoTransactionBatches() ) );
+            mxSetField( info, i, "autotransaction_rows",    mxCreateDoubleScalar( m_db[first+i].autoTransactionRows() ) );
+            mxSetField( info, i, "reader_connections",      mxCreateDoubleScalar( (double)m_db[first+i].readerCount() ) );
+
+            // settings applied on opening, as reported by SQLite
+            SQLopenOptions& options  = m_db[first+i].openOptions();
+            mxArray*        settings = mxCreateStructMatrix( 1, 1, 0, NULL );
+
+            for( int j = 0; settings && j < (int)options.m_applied.size(); j++ )
+            {
+                int field = mxAddField( settings, options.m_applied[j].first.c_str() );
+
+                if( field >= 0 )
+                {
+                    mxSetFieldByNumber( settings, 0, field, mxCreateString( options.m_applied[j].second.c_str() ) );
+                }
+            }
+
+            mxSetField( info, i, "open_profile",  mxCreateString( options.m_profile.c_str() ) );
+            mxSetField( info, i, "open_settings", settings );
+        }
+
+        return info;
+    }
     
     
     /// Returns the first next free id slot (base 0). Database must be closed
@@ -351,11 +444,12 @@ ValueMex createItemFromValueSQL( const ValueSQL& value, int& err_id )
  * @param[in] bStreamable true, if serialization is active
  * @param[out] iTypeComplexity see ValueMex::type_complexity_e
  * @param[out] err_id Error ID (see \ref MSG_IDS)
+ * @param[in] pJob compression job of \p item, already run (optional, see BlobPackPipeline)
  * @returns a SQL value type
  *
  * @see g_result_type
  */
-ValueSQL createValueSQLFromItem( const ValueMex& item, bool bStreamable, int& iTypeComplexity, int& err_id )
+ValueSQL createValueSQLFromItem( const ValueMex& item, bool bStreamable, int& iTypeComplexity, int& err_id, BlobPackJob* pJob )
 {
     iTypeComplexity = item.Item() ? item.Complexity( bStreamable ) : ValueMex::TC_EMPTY;
 
@@ -398,7 +492,8 @@ ValueSQL createValueSQLFromItem( const ValueMex& item, bool bStreamable, int& iT
               double ratio         = 0.0;
 
               /* blob_pack() modifies g_finalize_msg */
-              err_id = blob_pack( item.Item(), bStreamable, &blob, &blob_size, &process_time, &ratio );
+              err_id = blob_pack( item.Item(), bStreamable, &blob, &blob_size, &process_time, &ratio,
+                                  g_compression_type, g_compression_level, pJob );
               
               if( MSG_NOERROR == err_id )
               {
@@ -491,6 +586,7 @@ class Mksqlite
     int               m_dbid;             ///< selected database slot (1..COUNT_DB)
     SQLerror          m_err;              ///< recent error
     SQLiface*         m_interface;        ///< interface (holding current SQLite statement) to current database
+    map<const mxArray*, mxArray*> m_unpacked;  ///< typed BLOBs unpacked in advance (BLOB => MATLAB array)
     
     /**
      * \name Inhibit assignment, default and copy ctors
@@ -521,15 +617,19 @@ public:
     /// Release object
     void Release()
     {
-        if( m_command )
+        // Interface may refer to m_command when its statement is cached
+        if( m_interface )
         {
-            ::utils_free_ptr( m_command );
+            delete m_interface;
+            m_interface = NULL;
         }
 
-        if( m_interface )
+        if( m_command )
         {
-            delete m_interface;
+            ::utils_free_ptr( m_command );
         }
+
+        releaseUnpackedBlobs();
     }
     
     
@@ -657,6 +757,45 @@ public:
         return true;
     }
 
+
+    /**
+     * \brief Get next value as 64 bit integer from argument list
+     *
+     * \param[out] refValue Result will be returned in
+     * 
+     * Read next parameter at current argument read position, and
+     * write to \p refValue. The argument must be a numeric scalar.
+     */
+    bool argGetNextInt64( sqlite3_int64& refValue )
+    {
+        if( errPending() ) return false;
+
+        if( m_narg < 1 ) 
+        {
+            m_err.set( MSG_MISSINGARG );
+            return false;
+        }
+        else if( !mxIsNumeric( m_parg[0] ) || !ValueMex( m_parg[0] ).IsScalar() )
+        {
+            m_err.set( MSG_NUMARGEXPCT );
+            return false;
+        }
+
+        if( ValueMex( m_parg[0] ).ClassID() == mxINT64_CLASS )
+        {
+            refValue = ValueMex( m_parg[0] ).GetInt64();
+        }
+        else
+        {
+            refValue = (sqlite3_int64)ValueMex( m_parg[0] ).GetScalar();
+        }
+
+        m_parg++;
+        m_narg--;
+
+        return true;
+    }
+
     
     /**
      * \brief Get next value as function handle from argument list
@@ -986,6 +1125,63 @@ public:
     }
     
     
+    /**
+     * \brief Handle text dictionary settings command 
+     * 
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     * 
+     * Try to interpret current command as text dictionary mode setting
+     * \p strCmdMatchName hold the mksqlite command name.
+     * m_plhs[0] will be set to the old setting.
+     */
+    bool cmdTryHandleTextDictionary( const char* strCmdMatchName )
+    {
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) )
+        {
+            return false;
+        }
+        
+        /*
+         * text_dictionary setting (struct of arrays results only):
+         *  0 --> TEXT columns as cell arrays
+         *  1 --> TEXT columns as uint32 codes and cellstr dictionary <name>_dict
+         *  2 --> TEXT columns as categorical arrays
+         */
+        
+        // Global command, dbid useless
+        warnOnDefDbid();
+
+        int old_mode = g_text_dictionary;
+        int new_mode = old_mode;
+
+        if( m_narg > 1 )
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+            return false;
+        }
+
+        if( m_narg > 0 && !argGetNextInteger( new_mode ) )
+        {
+            // argGetNextInteger() sets m_err
+            return false;
+        }
+
+        if( new_mode < TEXT_DICTIONARY_OFF || new_mode > TEXT_DICTIONARY_CATEGORICAL )
+        {
+            m_err.set( MSG_INVALIDARG );
+            return false;
+        }
+
+        g_text_dictionary = new_mode;
+
+        // always return the old value
+        m_plhs[0] = mxCreateDoubleScalar( (double)old_mode );
+
+        return true;
+    }
+    
+    
     /**
      * \brief Handle command to (en-/dis-)able loading extensions
      *
@@ -1379,135 +1575,2325 @@ public:
             {
                 m_plhs[0] = mxCreateString( SQLstack.m_db[m_dbid-1].isOpen() ? "OPEN" : "CLOSED" );
             }
+
+            // Details (statement cache f.e.) as second output
+            if( m_nlhs > 1 )
+            {
+                m_plhs[1] = SQLstack.createStatusInfo( m_dbid_req, m_dbid );
+            }
         }
-        
+
         return true;
     }
-    
-    
+
+
     /**
-     * \brief Handle language command
+     * \brief Handle performance counters command
      *
      * \param[in] strCmdMatchName Command name
      * \returns true on success
-     * 
-     * Try to interpret current command as status command.
-     * \p strCmdMatchName holds the mksqlite command name.
+     *
+     * With a numeric argument, collecting performance counters is switched
+     * on or off for all databases and the old setting is returned in m_plhs[0].
+     * Otherwise the counters of the database are returned as struct in 
+     * m_plhs[0], and cleared afterwards, if the argument 'reset' is given.
      */
-    bool cmdTryHandleLanguage( const char* strCmdMatchName )
+    bool cmdTryHandleStats( const char* strCmdMatchName )
     {
+        const mxArray* action = NULL;
+        bool           reset  = false;
+
         if( errPending() || !STRMATCH( m_command, strCmdMatchName ) ) 
         {
             return false;
         }
-        
-        // Global command, dbid useless
-        warnOnDefDbid();
-        
-        /*
-         * There should be one numeric argument
-         */
-        if( m_narg < 1 ) 
+
+        // numeric argument switches collecting on or off
+        if( m_narg > 0 && mxIsNumeric( m_parg[0] ) )
         {
-            m_err.set( MSG_MISSINGARG );
-            return false;
+            return cmdTryHandleFlag( strCmdMatchName, g_stats );
         }
-        else if( m_narg > 1 ) 
+
+        if( m_dbid < 1 )
         {
-            m_err.set( MSG_UNEXPECTEDARG );
+            m_err.set( MSG_ERRNULLDBID );
             return false;
         }
 
-        if( !mxIsNumeric( m_parg[0] ) )
+        if( m_narg > 0 )
         {
-            m_err.set( MSG_NUMARGEXPCT );
-            return false;
-        } else {
-            int iLang = ValueMex( m_parg[0] ).GetInt();
-            
-            if( !setLocale( iLang ) )
+            if( !argGetNextLiteral( action ) )
+            {
+                // argGetNextLiteral() sets m_err
+                return false;
+            }
+
+            char* action_str = ValueMex( action ).GetString();
+            reset = action_str && STRMATCH( action_str, "reset" );
+            ::utils_free_ptr( action_str );
+
+            if( !reset )
             {
                 m_err.set( MSG_INVALIDARG );
                 return false;
             }
         }
 
+        if( m_narg > 0 )
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+            return false;
+        }
+
+        static const char* fieldnames[] = { "enabled", "calls", "rows", "text_bytes", "blob_bytes", "blobs_packed", "blobs_unpacked",
+                                            "prepare_time", "step_time", "column_time", "convert_time", 
+                                            "pack_time", "unpack_time", "result_time", "total_time" };
+
+        SQLstats& stats  = SQLstack.m_db[m_dbid-1].stats();
+        mxArray*  result = mxCreateStructMatrix( 1, 1, sizeof( fieldnames ) / sizeof( fieldnames[0] ), fieldnames );
+
+        if( !result )
+        {
+            m_err.set( MSG_CANTCREATEOUTPUT );
+            return false;
+        }
+
+        mxSetField( result, 0, "enabled",        mxCreateDoubleScalar( g_stats ? 1.0 : 0.0 ) );
+        mxSetField( result, 0, "calls",          mxCreateDoubleScalar( stats.m_calls ) );
+        mxSetField( result, 0, "rows",           mxCreateDoubleScalar( stats.m_rows ) );
+        mxSetField( result, 0, "text_bytes",     mxCreateDoubleScalar( stats.m_text_bytes ) );
+        mxSetField( result, 0, "blob_bytes",     mxCreateDoubleScalar( stats.m_blob_bytes ) );
+        mxSetField( result, 0, "blobs_packed",   mxCreateDoubleScalar( stats.m_packed ) );
+        mxSetField( result, 0, "blobs_unpacked", mxCreateDoubleScalar( stats.m_unpacked ) );
+        mxSetField( result, 0, "prepare_time",   mxCreateDoubleScalar( stats.m_prepare_time ) );
+        mxSetField( result, 0, "step_time",      mxCreateDoubleScalar( stats.m_step_time ) );
+        mxSetField( result, 0, "column_time",    mxCreateDoubleScalar( stats.m_column_time ) );
+        mxSetField( result, 0, "convert_time",   mxCreateDoubleScalar( stats.m_convert_time ) );
+        mxSetField( result, 0, "pack_time",      mxCreateDoubleScalar( stats.m_pack_time ) );
+        mxSetField( result, 0, "unpack_time",    mxCreateDoubleScalar( stats.m_unpack_time ) );
+        mxSetField( result, 0, "result_time",    mxCreateDoubleScalar( stats.m_result_time ) );
+        mxSetField( result, 0, "total_time",     mxCreateDoubleScalar( stats.m_total_time ) );
+
+        m_plhs[0] = result;
+
+        if( reset )
+        {
+            stats.reset();
+        }
+
         return true;
     }
-    
-    
+
+
+    /// Returns a MATLAB string of an UTF-8 encoded text
+    mxArray* createStringFromUtf8( const string& text )
+    {
+        char*    text_str = ::utils_strnewdup( text.c_str(), g_convertUTF8 );
+        mxArray* result   = mxCreateString( text_str ? text_str : "" );
+
+        ::utils_free_ptr( text_str );
+
+        return result;
+    }
+
+
     /**
-     * @brief Get the filename of current database
-     * 
-     * @param strCmdMatchName Command name
-     * @return true on success
-     * 
-     * filename will be given in m_plhs[0]
+     * \brief Handle last_query_profile command
+     *
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     *
+     * Returns the counters of the statement fetched last on the database
+     * (sqlite3_stmt_status()) as struct in m_plhs[0]. Field 'loops' holds the
+     * loops of the query plan (sqlite3_stmt_scanstatus()), if SQLite was 
+     * compiled with SQLITE_ENABLE_STMT_SCANSTATUS, otherwise it's empty.
      */
-    bool cmdTryHandleFilename( const char* strCmdMatchName )
+    bool cmdTryHandleLastQueryProfile( const char* strCmdMatchName )
     {
-        char *db_filename = NULL;
-        char *db_name     = NULL;
-
-        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) )
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) ) 
         {
             return false;
         }
 
-        SQLstack.switchTo( m_dbid-1 );
-
-        // database must be open to change settings
-        if( !ensureDbIsOpen() )
+        if( !selectHandleDb() )
         {
-            // ensureDbIsOpen() sets m_err
             return false;
         }
-        
-        /*
-         * There should be not more than 1 argument to get the db filename
-         */
-        if( m_narg > 1 )
+
+        if( m_narg > 0 )
         {
             m_err.set( MSG_UNEXPECTEDARG );
             return false;
         }
 
-        // Check if database name is given (for attached databases)
-        if( m_narg == 1 )
-        {
-            if( !mxIsChar( m_parg[0] ) )
-            {
-                m_err.set( MSG_LITERALARGEXPCT );
-                return false;
-            } else {
-                db_name = ValueMex( m_parg[0] ).GetEncString();
-            }
-        }
+        static const char* fieldnames[] = { "query", "fullscan_steps", "sorts", "autoindexes", "vm_steps", "reprepares",
+                                            "runs", "filter_misses", "filter_hits", "memused", "loops" };
+        static const char* loopfields[] = { "name", "explain", "loops", "visits", "estimate" };
 
-        db_filename = ::utils_strnewdup( m_interface->getDbFilename( db_name ), /*flagConvertUTF8*/ true );
+        SQLprofile& profile = SQLstack.current().profile();
+        mxArray*    result  = mxCreateStructMatrix( 1, 1, sizeof( fieldnames ) / sizeof( fieldnames[0] ), fieldnames );
+        mxArray*    loops   = mxCreateStructMatrix( profile.m_loops.size(), 1, sizeof( loopfields ) / sizeof( loopfields[0] ), loopfields );
 
-        if( NULL == db_filename )
+        if( !result || !loops )
         {
-            m_plhs[0] = mxCreateString( "" );  // Memory based database
+            ::utils_destroy_array( result );
+            ::utils_destroy_array( loops );
+            m_err.set( MSG_CANTCREATEOUTPUT );
+            return false;
         }
-        else
+
+        for( int i = 0; i < (int)profile.m_loops.size(); i++ )
         {
-            m_plhs[0] = mxCreateString( db_filename );  // File based database
+            const SQLprofile::Loop& loop = profile.m_loops[i];
+
+            mxSetField( loops, i, "name",     createStringFromUtf8( loop.m_name ) );
+            mxSetField( loops, i, "explain",  createStringFromUtf8( loop.m_explain ) );
+            mxSetField( loops, i, "loops",    mxCreateDoubleScalar( loop.m_loops ) );
+            mxSetField( loops, i, "visits",   mxCreateDoubleScalar( loop.m_visits ) );
+            mxSetField( loops, i, "estimate", mxCreateDoubleScalar( loop.m_estimate ) );
         }
 
-        ::utils_free_ptr( db_name );
-        ::utils_free_ptr( db_filename );
+        mxSetField( result, 0, "query",          createStringFromUtf8( profile.m_query ) );
+        mxSetField( result, 0, "fullscan_steps", mxCreateDoubleScalar( profile.m_fullscan_steps ) );
+        mxSetField( result, 0, "sorts",          mxCreateDoubleScalar( profile.m_sorts ) );
+        mxSetField( result, 0, "autoindexes",    mxCreateDoubleScalar( profile.m_autoindexes ) );
+        mxSetField( result, 0, "vm_steps",       mxCreateDoubleScalar( profile.m_vm_steps ) );
+        mxSetField( result, 0, "reprepares",     mxCreateDoubleScalar( profile.m_reprepares ) );
+        mxSetField( result, 0, "runs",           mxCreateDoubleScalar( profile.m_runs ) );
+        mxSetField( result, 0, "filter_misses",  mxCreateDoubleScalar( profile.m_filter_misses ) );
+        mxSetField( result, 0, "filter_hits",    mxCreateDoubleScalar( profile.m_filter_hits ) );
+        mxSetField( result, 0, "memused",        mxCreateDoubleScalar( profile.m_memused ) );
+        mxSetField( result, 0, "loops",          loops );
+
+        m_plhs[0] = result;
 
         return true;
     }
 
 
     /**
-     * \brief Handle streaming setting command
+     * \brief Handle slow query log setting command
      *
      * \param[in] strCmdMatchName Command name
      * \returns true on success
-     * 
+     *
+     * Try to interpret current command as slow query log threshold (seconds).
+     * \p strCmdMatchName holds the mksqlite command name.
+     * SQL statements running longer are written to the log file, together
+     * with their query plan (see logSlowQuery()). 0 turns the log off.
+     * m_plhs[0] will be set to the old setting.
+     */
+    bool cmdTryHandleSlowQueryLog( const char* strCmdMatchName )
+    {
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) )
+        {
+            return false;
+        }
+
+        // Global command, dbid useless
+        warnOnDefDbid();
+
+        double old_time = g_slow_query_time;
+        double new_time = old_time;
+
+        /*
+         * There should be one numeric argument
+         */
+        if( m_narg > 1 )
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+            return false;
+        }
+
+        if( m_narg > 0 )
+        {
+            if( !mxIsNumeric( m_parg[0] ) || !ValueMex( m_parg[0] ).IsScalar() )
+            {
+                m_err.set( MSG_NUMARGEXPCT );
+                return false;
+            }
+
+            new_time = ValueMex( m_parg[0] ).GetScalar();
+
+            if( !( new_time >= 0.0 ) )
+            {
+                m_err.set( MSG_INVALIDARG );
+                return false;
+            }
+
+#if !MKSQLITE_CONFIG_USE_LOGGING
+            if( new_time > 0.0 )
+            {
+                m_err.set( MSG_NOLOGGING );
+                return false;
+            }
+#endif
+            g_slow_query_time = new_time;
+        }
+
+        // always return the old value
+        m_plhs[0] = mxCreateDoubleScalar( old_time );
+
+        return true;
+    }
+
+
+    /**
+     * \brief Handle memory statistics command
+     *
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     *
+     * Returns the memory used by SQLite overall (sqlite3_memory_used()) and 
+     * by the database connection (sqlite3_db_status()), the BLOB memory 
+     * allocated by mksqlite for packing typed BLOBs and the estimated size 
+     * of the result buffers, as struct in m_plhs[0]. 
+     * High-water marks and allocation counters are cleared afterwards, 
+     * if the argument 'reset' is given.
+     */
+    bool cmdTryHandleMemStats( const char* strCmdMatchName )
+    {
+        const mxArray* action = NULL;
+        bool           reset  = false;
+
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) ) 
+        {
+            return false;
+        }
+
+        if( m_dbid < 1 )
+        {
+            m_err.set( MSG_ERRNULLDBID );
+            return false;
+        }
+
+        if( m_narg > 0 )
+        {
+            if( !argGetNextLiteral( action ) )
+            {
+                // argGetNextLiteral() sets m_err
+                return false;
+            }
+
+            char* action_str = ValueMex( action ).GetString();
+            reset = action_str && STRMATCH( action_str, "reset" );
+            ::utils_free_ptr( action_str );
+
+            if( !reset )
+            {
+                m_err.set( MSG_INVALIDARG );
+                return false;
+            }
+        }
+
+        if( m_narg > 0 )
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+            return false;
+        }
+
+        static const char* fieldnames[] = { "memory_used", "memory_highwater", 
+                                            "cache_used", "schema_used", "stmt_used", "lookaside_used", "lookaside_highwater",
+                                            "blob_allocs", "blob_alloc_bytes", 
+                                            "result_bytes", "result_highwater", "result_memory_cap" };
+
+        SQLstackitem& dbitem        = SQLstack.m_db[m_dbid-1];
+        int           cache_used    = 0;
+        int           schema_used   = 0;
+        int           stmt_used     = 0;
+        int           lookaside     = 0;
+        int           lookaside_max = 0;
+        int           dummy         = 0;
+        mxArray*      result        = mxCreateStructMatrix( 1, 1, sizeof( fieldnames ) / sizeof( fieldnames[0] ), fieldnames );
+
+        if( !result )
+        {
+            m_err.set( MSG_CANTCREATEOUTPUT );
+            return false;
+        }
+
+        if( dbitem.isOpen() )
+        {
+            sqlite3* db = dbitem.dbid();
+
+            sqlite3_db_status( db, SQLITE_DBSTATUS_CACHE_USED,     &cache_used, &dummy,         0 );
+            sqlite3_db_status( db, SQLITE_DBSTATUS_SCHEMA_USED,    &schema_used, &dummy,        0 );
+            sqlite3_db_status( db, SQLITE_DBSTATUS_STMT_USED,      &stmt_used, &dummy,          0 );
+            sqlite3_db_status( db, SQLITE_DBSTATUS_LOOKASIDE_USED, &lookaside, &lookaside_max,  reset ? 1 : 0 );
+        }
+
+        mxSetField( result, 0, "memory_used",         mxCreateDoubleScalar( (double)sqlite3_memory_used() ) );
+        mxSetField( result, 0, "memory_highwater",    mxCreateDoubleScalar( (double)sqlite3_memory_highwater( reset ? 1 : 0 ) ) );
+        mxSetField( result, 0, "cache_used",          mxCreateDoubleScalar( (double)cache_used ) );
+        mxSetField( result, 0, "schema_used",         mxCreateDoubleScalar( (double)schema_used ) );
+        mxSetField( result, 0, "stmt_used",           mxCreateDoubleScalar( (double)stmt_used ) );
+        mxSetField( result, 0, "lookaside_used",      mxCreateDoubleScalar( (double)lookaside ) );
+        mxSetField( result, 0, "lookaside_highwater", mxCreateDoubleScalar( (double)lookaside_max ) );
+        mxSetField( result, 0, "blob_allocs",         mxCreateDoubleScalar( (double)g_blob_alloc_count ) );
+        mxSetField( result, 0, "blob_alloc_bytes",    mxCreateDoubleScalar( (double)g_blob_alloc_bytes ) );
+        mxSetField( result, 0, "result_bytes",        mxCreateDoubleScalar( dbitem.resultBytes() ) );
+        mxSetField( result, 0, "result_highwater",    mxCreateDoubleScalar( dbitem.resultPeak() ) );
+        mxSetField( result, 0, "result_memory_cap",   mxCreateDoubleScalar( g_result_memory_cap ) );
+
+        m_plhs[0] = result;
+
+        if( reset )
+        {
+            g_blob_alloc_count = 0;
+            g_blob_alloc_bytes = 0;
+            dbitem.resetResultPeak();
+        }
+
+        return true;
+    }
+
+
+    /**
+     * \brief Handle result memory cap setting command
+     *
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     *
+     * Try to interpret current command as memory cap of query results (bytes).
+     * \p strCmdMatchName holds the mksqlite command name.
+     * Queries whose result buffers grow beyond are aborted with an error,
+     * 0 turns the cap off. m_plhs[0] will be set to the old setting.
+     */
+    bool cmdTryHandleResultMemoryCap( const char* strCmdMatchName )
+    {
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) )
+        {
+            return false;
+        }
+
+        // Global command, dbid useless
+        warnOnDefDbid();
+
+        double old_cap = g_result_memory_cap;
+
+        /*
+         * There should be one numeric argument
+         */
+        if( m_narg > 1 )
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+            return false;
+        }
+
+        if( m_narg > 0 )
+        {
+            if( !mxIsNumeric( m_parg[0] ) || !ValueMex( m_parg[0] ).IsScalar() )
+            {
+                m_err.set( MSG_NUMARGEXPCT );
+                return false;
+            }
+
+            double new_cap = ValueMex( m_parg[0] ).GetScalar();
+
+            if( !( new_cap >= 0.0 ) )
+            {
+                m_err.set( MSG_INVALIDARG );
+                return false;
+            }
+
+            g_result_memory_cap = new_cap;
+        }
+
+        // always return the old value
+        m_plhs[0] = mxCreateDoubleScalar( old_cap );
+
+        return true;
+    }
+
+
+    /**
+     * \brief Handle serialize command
+     *
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     *
+     * Returns the image of a database schema ("main" by default) as uint8
+     * column vector in m_plhs[0] (sqlite3_serialize()). In-memory databases 
+     * are copied straight from their memory (SQLITE_SERIALIZE_NOCOPY), other 
+     * databases are read into a temporary copy first.
+     */
+    bool cmdTryHandleSerialize( const char* strCmdMatchName )
+    {
+        const mxArray* schema     = NULL;
+        char*          schema_str = NULL;
+
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) ) 
+        {
+            return false;
+        }
+
+        if( !selectHandleDb() )
+        {
+            return false;
+        }
+
+        if( m_narg > 0 )
+        {
+            if( !argGetNextLiteral( schema ) )
+            {
+                // argGetNextLiteral() sets m_err
+                return false;
+            }
+
+            schema_str = ValueMex( schema ).GetEncString();
+        }
+
+        if( m_narg > 0 )
+        {
+            ::utils_free_ptr( schema_str );
+            m_err.set( MSG_UNEXPECTEDARG );
+            return false;
+        }
+
+        sqlite3*        db       = SQLstack.current().dbid();
+        const char*     name     = schema_str ? schema_str : "main";
+        sqlite3_int64   bytes    = 0;
+        unsigned char*  data     = sqlite3_serialize( db, name, &bytes, SQLITE_SERIALIZE_NOCOPY );
+        bool            is_copy  = false;
+
+        if( !data )
+        {
+            // no contiguous memory image (database file), let SQLite make one
+            data    = sqlite3_serialize( db, name, &bytes, 0 );
+            is_copy = true;
+        }
+
+        mxArray* result = data ? mxCreateNumericMatrix( (mwSize)bytes, 1, mxUINT8_CLASS, mxREAL ) : NULL;
+
+        if( !data )
+        {
+            m_err.set( MSG_ERRSERIALIZE );
+        }
+        else if( !result )
+        {
+            m_err.set( MSG_CANTCREATEOUTPUT );
+        }
+        else
+        {
+            if( bytes )
+            {
+                memcpy( mxGetData( result ), data, (size_t)bytes );
+            }
+            m_plhs[0] = result;
+        }
+
+        if( is_copy )
+        {
+            sqlite3_free( data );
+        }
+
+        ::utils_free_ptr( schema_str );
+
+        return !errPending();
+    }
+
+
+    /**
+     * \brief Handle statement cache setting command
+     *
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     *
+     * Try to interpret current command as statement cache size.
+     * \p strCmdMatchName holds the mksqlite command name.
+     * m_plhs[0] will be set to the old setting.
+     */
+    bool cmdTryHandleStmtCache( const char* strCmdMatchName )
+    {
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) )
+        {
+            return false;
+        }
+
+        // Global command, dbid useless
+        warnOnDefDbid();
+
+        int old_size = g_stmt_cache_size;
+        int new_size = old_size;
+
+        /*
+         * There should be one integer argument
+         */
+        if( m_narg > 1 )
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+            return false;
+        }
+
+        if( m_narg > 0 && !argGetNextInteger( new_size, /*asBoolInt*/ false ) )
+        {
+            // argGetNextInteger() sets m_err
+            return false;
+        }
+
+        if( new_size < 0 )
+        {
+            m_err.set( MSG_INVALIDARG );
+            return false;
+        }
+
+        // action on change only
+        if( new_size != old_size )
+        {
+            g_stmt_cache_size = new_size;
+
+            // Shrink caches of all databases to the new limit
+            for( int i = 0; i < SQLstack.COUNT_DB; i++ )
+            {
+                SQLstack.m_db[i].stmtCache().trim( new_size );
+            }
+        }
+
+        // always return the old value
+        m_plhs[0] = mxCreateDoubleScalar( (double)old_size );
+
+        return true;
+    }
+    
+    
+    /**
+     * \brief Handle reader pool setting command
+     *
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     * 
+     * Try to interpret current command as reader pool setting.
+     * \p strCmdMatchName holds the mksqlite command name.
+     * The reader pool holds up to n read-only connections per database file,
+     * which are used by tickets and parallel queries (0 disables the pool).
+     * Idle connections exceeding the new size are closed. 
+     * The old size is returned in m_plhs[0].
+     */
+    bool cmdTryHandleReaderPool( const char* strCmdMatchName )
+    {
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) )
+        {
+            return false;
+        }
+
+        // Global command, dbid useless
+        warnOnDefDbid();
+
+        int old_size = g_reader_pool_size;
+        int new_size = old_size;
+
+        /*
+         * There should be one integer argument
+         */
+        if( m_narg > 1 )
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+            return false;
+        }
+
+        if( m_narg > 0 && !argGetNextInteger( new_size, /*asBoolInt*/ false ) )
+        {
+            // argGetNextInteger() sets m_err
+            return false;
+        }
+
+        if( new_size < 0 )
+        {
+            m_err.set( MSG_INVALIDARG );
+            return false;
+        }
+
+        // action on change only
+        if( new_size != old_size )
+        {
+            g_reader_pool_size = new_size;
+
+            // Shrink pools of all databases to the new limit
+            for( int i = 0; i < SQLstack.COUNT_DB; i++ )
+            {
+                SQLstack.m_db[i].trimReaders( new_size );
+            }
+        }
+
+        // always return the old value
+        m_plhs[0] = mxCreateDoubleScalar( (double)old_size );
+
+        return true;
+    }
+    
+    
+    /**
+     * \brief Handle automatic transaction setting command
+     *
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     * 
+     * Try to interpret current command as automatic transaction setting.
+     * \p strCmdMatchName holds the mksqlite command name.
+     * m_plhs[0] will be set to the old setting.
+     */
+    bool cmdTryHandleAutoTransaction( const char* strCmdMatchName )
+    {
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) )
+        {
+            return false;
+        }
+
+        // Global command, dbid useless
+        warnOnDefDbid();
+
+        int old_rows = g_autotransaction;
+        int new_rows = old_rows;
+
+        /*
+         * There should be one integer argument
+         */
+        if( m_narg > 1 )
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+            return false;
+        }
+
+        if( m_narg > 0 && !argGetNextInteger( new_rows, /*asBoolInt*/ false ) )
+        {
+            // argGetNextInteger() sets m_err
+            return false;
+        }
+
+        if( new_rows < 0 )
+        {
+            m_err.set( MSG_INVALIDARG );
+            return false;
+        }
+
+        g_autotransaction = new_rows;
+
+        // always return the old value
+        m_plhs[0] = mxCreateDoubleScalar( (double)old_rows );
+
+        return true;
+    }
+    
+    
+    /**
+     * \brief Handle threads setting command
+     *
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     * 
+     * Try to interpret current command as setting for the number of threads
+     * decompressing typed BLOBs. A number of 0 selects one thread per processor 
+     * core, 1 disables the worker threads.
+     * m_plhs[0] will be set to the old setting.
+     */
+    bool cmdTryHandleThreads( const char* strCmdMatchName )
+    {
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) )
+        {
+            return false;
+        }
+
+        // Global command, dbid useless
+        warnOnDefDbid();
+
+        int old_threads = g_threads;
+        int new_threads = old_threads;
+
+        /*
+         * There should be one integer argument
+         */
+        if( m_narg > 1 )
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+            return false;
+        }
+
+        if( m_narg > 0 && !argGetNextInteger( new_threads, /*asBoolInt*/ false ) )
+        {
+            // argGetNextInteger() sets m_err
+            return false;
+        }
+
+        if( new_threads < 0 )
+        {
+            m_err.set( MSG_INVALIDARG );
+            return false;
+        }
+
+        // hardware_concurrency() returns 0, if the number of cores is unknown
+        if( !new_threads )
+        {
+            new_threads = std::max( 1, (int)std::thread::hardware_concurrency() );
+        }
+
+        g_threads = new_threads;
+
+        // always return the old value
+        m_plhs[0] = mxCreateDoubleScalar( (double)old_threads );
+
+        return true;
+    }
+    
+    
+    /**
+     * \brief Select the database slot for commands on statement handles
+     *
+     * \returns true if database is open
+     */
+    bool selectHandleDb()
+    {
+        if( m_dbid < 1 )
+        {
+            m_err.set( MSG_ERRNULLDBID );
+            return false;
+        }
+
+        SQLstack.switchTo( m_dbid-1 );
+
+        // ensureDbIsOpen() sets m_err
+        return ensureDbIsOpen();
+    }
+
+
+    /**
+     * \brief Get next value as statement handle from argument list
+     *
+     * \param[out] refHandle Handle number will be returned in
+     * \param[in] isCursor true, if handle must be a cursor, false for a prepared statement
+     * \returns Prepared statement, or NULL if handle is unknown for current database
+     */
+    SQLhandle* argGetNextStmtHandle( int& refHandle, bool isCursor )
+    {
+        if( !argGetNextInteger( refHandle, /*asBoolInt*/ false ) )
+        {
+            // argGetNextInteger() sets m_err
+            return NULL;
+        }
+
+        SQLstackitem::SQLhandleMap& handles = SQLstack.current().handles();
+        SQLstackitem::SQLhandleMap::iterator it = handles.find( refHandle );
+
+        if( it == handles.end() || it->second.m_isCursor != isCursor )
+        {
+            m_err.set( MSG_INVALIDSTMTHANDLE );
+            return NULL;
+        }
+
+        return &it->second;
+    }
+
+
+    /**
+     * \brief Prepare a SQL statement and hold it by a new handle
+     *
+     * \param[in] query SQL statement (MATLAB string)
+     * \param[out] refHandle Handle number will be returned in
+     * \returns Prepared statement, or NULL on error (m_err is set)
+     */
+    SQLhandle* createStmtHandle( const mxArray* query, int& refHandle )
+    {
+        char* query_str  = ValueMex( query ).GetString();
+        char* query_utf8 = query_str ? createQueryString( query_str ) : NULL;
+
+        ::utils_free_ptr( query_str );
+
+        if( !query_utf8 )
+        {
+            m_err.set( MSG_ERRMEMORY );
+            return NULL;
+        }
+
+        // The handle owns the query string, the interface refers to it
+        int        handle = SQLstackitem::newHandle();
+        SQLhandle& item   = SQLstack.current().handles()[handle];
+
+        item.m_query = query_utf8;
+        item.m_iface = SQLstack.createInterface();
+        ::utils_free_ptr( query_utf8 );
+
+        if( !item.m_iface->setQuery( item.m_query.c_str() ) )
+        {
+            const char* errid = NULL;
+            // message text is copied (non-const), since the interface will be deleted
+            m_err.set( (char*)item.m_iface->getErr(&errid), errid );
+
+            delete item.m_iface;
+            SQLstack.current().handles().erase( handle );
+            return NULL;
+        }
+
+        refHandle = handle;
+
+        return &item;
+    }
+
+
+    /**
+     * \brief Handle prepare command
+     *
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     *
+     * Prepares the SQL statement given as argument once. The statement is
+     * held by a new handle, which is returned in m_plhs[0].
+     */
+    bool cmdTryHandlePrepare( const char* strCmdMatchName )
+    {
+        const mxArray* query = NULL;
+
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) )
+        {
+            return false;
+        }
+
+        if( !selectHandleDb() )
+        {
+            return false;
+        }
+
+        /*
+         * There should be exactly one string argument
+         */
+        if( !argGetNextLiteral( query ) )
+        {
+            // argGetNextLiteral() sets m_err
+            return false;
+        }
+
+        if( m_narg > 0 )
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+            return false;
+        }
+
+        int handle = 0;
+
+        if( !createStmtHandle( query, handle ) )
+        {
+            // createStmtHandle() sets m_err
+            return false;
+        }
+
+        m_plhs[0] = mxCreateDoubleScalar( (double)handle );
+
+        return true;
+    }
+
+
+    /**
+     * \brief Handle exec command
+     *
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     *
+     * Executes a statement prepared by 'prepare'. Remaining arguments are
+     * bound to the statement parameters, results are returned like for common
+     * SQL statements. The statement stays prepared.
+     */
+    bool cmdTryHandleExec( const char* strCmdMatchName )
+    {
+        int handle = 0;
+
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) )
+        {
+            return false;
+        }
+
+        if( !selectHandleDb() )
+        {
+            return false;
+        }
+
+        SQLhandle* item = argGetNextStmtHandle( handle, /*isCursor*/ false );
+
+        if( !item )
+        {
+            // argGetNextStmtHandle() sets m_err
+            return false;
+        }
+
+        (void)execStatement( item->m_iface, /*persistent*/ true );
+
+        return true;
+    }
+
+
+    /**
+     * \brief Handle reset, finalize and cursor_close commands
+     *
+     * \param[in] strCmdMatchName Command name
+     * \param[in] finalize If true, the statement will be finalized and the handle released
+     * \param[in] isCursor true, if handle must be a cursor
+     * \returns true on success
+     *
+     * Resets the statement held by a handle and clears its parameter bindings,
+     * or finalizes it.
+     */
+    bool cmdTryHandleResetFinalize( const char* strCmdMatchName, bool finalize, bool isCursor = false )
+    {
+        int handle = 0;
+
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) )
+        {
+            return false;
+        }
+
+        if( !selectHandleDb() )
+        {
+            return false;
+        }
+
+        SQLhandle* item = argGetNextStmtHandle( handle, isCursor );
+
+        if( !item )
+        {
+            // argGetNextStmtHandle() sets m_err
+            return false;
+        }
+
+        if( m_narg > 0 )
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+            return false;
+        }
+
+        if( finalize )
+        {
+            delete item->m_iface;
+            SQLstack.current().handles().erase( handle );
+        }
+        else
+        {
+            item->m_iface->reset();
+            item->m_iface->clearBindings();
+        }
+
+        return true;
+    }
+    
+    
+    /**
+     * \brief Bind the remaining arguments to a statement, which is executed once
+     *
+     * \param[in] iface Interface owning the prepared statement
+     * \param[in] firstParam Index number of the first parameter to bind (1 based)
+     * \returns true on success, otherwise m_err is set
+     *
+     * The arguments may be passed as a single cell argument, or as a single
+     * struct argument holding the named arguments. There is no parameter 
+     * wrapping. Arguments are bound as copies, so the statement may be 
+     * stepped after this call of mksqlite has returned (cursors, tickets).
+     * The argument list isn't consumed.
+     */
+    bool bindArguments( SQLiface* iface, int firstParam = 1 )
+    {
+        const mxArray**  nextBindParam   = m_parg;
+        int              countBindParam  = m_narg;
+        int              argsNeeded      = iface->getParameterCount() - ( firstParam - 1 );
+        bool             haveParamStruct = false;
+
+        // Single cell argument holds the arguments
+        if( countBindParam == 1 && ValueMex(*nextBindParam).IsCell() )
+        {
+            countBindParam = (int)ValueMex(*nextBindParam).NumElements();
+            nextBindParam  = (const mxArray**)ValueMex(*nextBindParam).Data();
+        }
+
+        // Single struct argument holds the named arguments
+        if( countBindParam == 1 && ValueMex(*nextBindParam).IsStruct() && ValueMex(*nextBindParam).NumElements() == 1 )
+        {
+            haveParamStruct = true;
+            countBindParam  = argsNeeded;
+        }
+
+        // Statement is executed once, no parameter wrapping
+        if( countBindParam > argsNeeded )
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+        }
+
+        // bind each argument to SQL statement placeholders 
+        for( int iParam = 0; !errPending() && iParam < countBindParam; iParam++ )
+        {
+            const mxArray* bindParam = NULL;
+
+            if( !haveParamStruct )
+            {
+                bindParam = nextBindParam[iParam];
+            }
+            else
+            {
+                const char* name = iface->getParameterName( iParam + firstParam );
+                bindParam = name ? ValueMex( *nextBindParam ).GetField( 0, name + 1 ) : NULL;  // adjusting name behind either '?', ':', '$' or '@'!
+
+                if( !bindParam )
+                {
+                    m_err.set_printf( MSG_MISSINGARG_STRUCT, NULL, name ? name + 1 : "(unnamed)" );
+                    break;
+                }
+            }
+
+            // Arguments are bound as copies, since they don't survive this call
+            if( !iface->bindParameter( iParam + firstParam, ValueMex( bindParam ), can_serialize() ) )
+            {
+                const char* errid = NULL;
+                // message text is copied (non-const), since the interface may be deleted
+                m_err.set( (char*)iface->getErr(&errid), errid );
+            }
+        }
+
+        return !errPending();
+    }
+    
+    
+    /**
+     * \brief Handle cursor_open command
+     *
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     *
+     * Prepares the SQL statement given as argument and binds the remaining
+     * arguments (or the elements of a single cell argument, or the fields of
+     * a single struct argument) to its parameters. Rows are fetched in chunks
+     * by 'cursor_fetch'. The cursor handle is returned in m_plhs[0].
+     */
+    bool cmdTryHandleCursorOpen( const char* strCmdMatchName )
+    {
+        const mxArray* query = NULL;
+        int handle = 0;
+
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) )
+        {
+            return false;
+        }
+
+        if( !selectHandleDb() )
+        {
+            return false;
+        }
+
+        if( !argGetNextLiteral( query ) )
+        {
+            // argGetNextLiteral() sets m_err
+            return false;
+        }
+
+        SQLhandle* item = createStmtHandle( query, handle );
+
+        if( !item )
+        {
+            // createStmtHandle() sets m_err
+            return false;
+        }
+
+        item->m_isCursor = true;
+
+        // bindArguments() sets m_err
+        (void)bindArguments( item->m_iface );
+
+        if( errPending() )
+        {
+            delete item->m_iface;
+            SQLstack.current().handles().erase( handle );
+            return false;
+        }
+
+        m_plhs[0] = mxCreateDoubleScalar( (double)handle );
+
+        return true;
+    }
+
+
+    /**
+     * \brief Handle cursor_fetch command
+     *
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     *
+     * Fetches the next (up to) nRows rows of a cursor. Results are returned 
+     * like for common SQL statements. When the cursor is exhausted, the 
+     * results are empty (row count 0). If the statement fails, the error is
+     * returned once and the cursor is exhausted.
+     */
+    bool cmdTryHandleCursorFetch( const char* strCmdMatchName )
+    {
+        int handle = 0;
+        int nRows  = 0;
+
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) )
+        {
+            return false;
+        }
+
+        if( !selectHandleDb() )
+        {
+            return false;
+        }
+
+        SQLhandle* item = argGetNextStmtHandle( handle, /*isCursor*/ true );
+
+        if( !item || !argGetNextInteger( nRows, /*asBoolInt*/ false ) )
+        {
+            // argGetNextStmtHandle() or argGetNextInteger() sets m_err
+            return false;
+        }
+
+        if( m_narg > 0 )
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+            return false;
+        }
+
+        if( nRows < 1 )
+        {
+            m_err.set( MSG_INVALIDARG );
+            return false;
+        }
+
+        ValueSQLCols cols;
+
+        // Stepping a finished statement would restart it, so return no rows then
+        if( !item->m_iface->fetch( cols, /*initialize*/ true, item->m_done ? 0 : nRows, item->m_done ? NULL : &item->m_done ) )
+        {
+            const char* errid = NULL;
+
+            // stepping the failed statement again would restart it (auto-reset), so no more rows follow
+            item->m_done = true;
+
+            // message text is copied (non-const), since the error is reported once only
+            m_err.set( (char*)item->m_iface->getErr(&errid), errid );
+            item->m_iface->clearErr();
+            return false;
+        }
+
+        setResults( cols, NULL, 0 );
+
+        return true;
+    }
+    
+    
+    /**
+     * \brief Get next value as ticket from argument list
+     *
+     * \param[out] refTicket Ticket number will be returned in
+     * \returns Query running in background, or NULL if ticket is unknown for current database
+     */
+    SQLticket* argGetNextTicket( int& refTicket )
+    {
+        if( !argGetNextInteger( refTicket, /*asBoolInt*/ false ) )
+        {
+            // argGetNextInteger() sets m_err
+            return NULL;
+        }
+
+        SQLstackitem::SQLticketMap& tickets = SQLstack.current().tickets();
+        SQLstackitem::SQLticketMap::iterator it = tickets.find( refTicket );
+
+        if( it == tickets.end() )
+        {
+            m_err.set( MSG_INVALIDTICKET );
+            return NULL;
+        }
+
+        return it->second;
+    }
+
+
+    /**
+     * \brief Handle submit command
+     *
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     *
+     * Runs the SQL statement given as argument in background. The statement 
+     * is prepared on a connection of the reader pool, or an own connection to
+     * the database file, if the pool is exhausted. The remaining
+     * arguments are bound like for 'cursor_open'. The ticket is returned in 
+     * m_plhs[0], results are redeemed by 'wait'.
+     */
+    bool cmdTryHandleSubmit( const char* strCmdMatchName )
+    {
+        const mxArray* query = NULL;
+
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) )
+        {
+            return false;
+        }
+
+        if( !selectHandleDb() )
+        {
+            return false;
+        }
+
+        if( !argGetNextLiteral( query ) )
+        {
+            // argGetNextLiteral() sets m_err
+            return false;
+        }
+
+        char* query_str  = ValueMex( query ).GetString();
+        char* query_utf8 = query_str ? createQueryString( query_str ) : NULL;
+
+        ::utils_free_ptr( query_str );
+
+        if( !query_utf8 )
+        {
+            m_err.set( MSG_ERRMEMORY );
+            return false;
+        }
+
+        SQLticket* ticket = new SQLticket;
+
+        if( ticket->open( SQLstack.current(), query_utf8, m_err ) )
+        {
+            // bindArguments() sets m_err
+            (void)bindArguments( ticket->iface() );
+        }
+
+        ::utils_free_ptr( query_utf8 );
+
+        if( errPending() )
+        {
+            delete ticket;
+            return false;
+        }
+
+        int handle = SQLstackitem::newHandle();
+
+        SQLstack.current().tickets()[handle] = ticket;
+        ticket->start();
+
+        m_plhs[0] = mxCreateDoubleScalar( (double)handle );
+
+        return true;
+    }
+
+
+    /**
+     * \brief Handle poll command
+     *
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     *
+     * Returns 1 in m_plhs[0], if the query of a ticket has finished, 
+     * otherwise 0. 
+     */
+    bool cmdTryHandlePoll( const char* strCmdMatchName )
+    {
+        int ticket = 0;
+
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) )
+        {
+            return false;
+        }
+
+        if( !selectHandleDb() )
+        {
+            return false;
+        }
+
+        SQLticket* item = argGetNextTicket( ticket );
+
+        if( !item )
+        {
+            // argGetNextTicket() sets m_err
+            return false;
+        }
+
+        if( m_narg > 0 )
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+            return false;
+        }
+
+        m_plhs[0] = mxCreateDoubleScalar( item->isDone() ? 1.0 : 0.0 );
+
+        return true;
+    }
+
+
+    /**
+     * \brief Handle wait command
+     *
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     *
+     * Waits for the query of a ticket, optional up to timeout seconds. Results
+     * are returned like for common SQL statements and the ticket is released.
+     * If the timeout elapses first, an empty array is returned and the ticket
+     * stays valid.
+     */
+    bool cmdTryHandleWait( const char* strCmdMatchName )
+    {
+        int    ticket  = 0;
+        double timeout = -1.0;
+
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) )
+        {
+            return false;
+        }
+
+        if( !selectHandleDb() )
+        {
+            return false;
+        }
+
+        SQLticket* item = argGetNextTicket( ticket );
+
+        if( !item )
+        {
+            // argGetNextTicket() sets m_err
+            return false;
+        }
+
+        // timeout in seconds may be fractional
+        if( m_narg > 0 )
+        {
+            if( !mxIsNumeric( m_parg[0] ) || !ValueMex( m_parg[0] ).IsScalar() )
+            {
+                m_err.set( MSG_NUMARGEXPCT );
+                return false;
+            }
+
+            timeout = ValueMex( m_parg[0] ).GetScalar();
+            m_parg++;
+            m_narg--;
+        }
+
+        if( m_narg > 0 )
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+            return false;
+        }
+
+        if( !item->wait( timeout ) )
+        {
+            m_plhs[0] = mxCreateDoubleMatrix( 0, 0, mxREAL );
+            return true;
+        }
+
+        ValueSQLCols cols;
+
+        if( !item->fetch( cols, SQLstack.current() ) )
+        {
+            const char* errid = NULL;
+            // message text is copied (non-const), since the ticket will be deleted
+            m_err.set( (char*)item->iface()->getErr(&errid), errid );
+        }
+        else
+        {
+            setResults( cols, NULL, 0 );
+        }
+
+        delete item;
+        SQLstack.current().tickets().erase( ticket );
+
+        return !errPending();
+    }
+    /**
+     * \brief Get next value as count of pages per step from argument list (optional)
+     *
+     * \param[out] refPages Count of pages, MKSQLITE_CONFIG_BACKUP_PAGES_PER_STEP if omitted
+     * \returns true on success
+     *
+     * Negative values copy all pages at once, 0 is rejected.
+     */
+    bool argGetNextPagesPerStep( int& refPages )
+    {
+        refPages = MKSQLITE_CONFIG_BACKUP_PAGES_PER_STEP;
+
+        if( m_narg > 0 )
+        {
+            if( !argGetNextInteger( refPages, /*asBoolInt*/ false ) )
+            {
+                // argGetNextInteger() sets m_err
+                return false;
+            }
+
+            if( !refPages )
+            {
+                m_err.set( MSG_INVALIDARG );
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+
+    /**
+     * \brief Wait for the copy running in background on the selected database
+     *
+     * \returns false, if the copy failed (m_err is set then)
+     *
+     * The connection is used by the worker thread of 'load_into_memory' and
+     * 'backup', so any other command on this database waits, until the copy
+     * has finished. 'backup_status', 'backup_wait' and 'backup_cancel' don't
+     * wait, 'open', 'close', 'deserialize' and 'load_into_memory' cancel the
+     * copy, when the database is closed.
+     */
+    bool cmdFinishBackup()
+    {
+        if(    m_dbid < 1 
+            || STRMATCH( m_command, "backup_status" ) 
+            || STRMATCH( m_command, "backup_wait" ) 
+            || STRMATCH( m_command, "backup_cancel" ) )
+        {
+            return true;
+        }
+
+        SQLstackitem& dbitem = SQLstack.m_db[m_dbid-1];
+        SQLbackup*    backup = dbitem.backup();
+
+        if( !backup )
+        {
+            return true;
+        }
+
+        (void)backup->wait();
+        (void)backup->getResult( m_err );
+        dbitem.releaseBackup();
+
+        return !errPending();
+    }
+
+
+    /**
+     * \brief Handle backup command
+     *
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     *
+     * Copies the database into the file given as argument (online backup 
+     * API), optional followed by the count of pages copied per step. The 
+     * pages are copied by a worker thread, so the command returns at once.
+     * Use 'backup_status', 'backup_wait' or 'backup_cancel' to follow the 
+     * copy.
+     */
+    bool cmdTryHandleBackup( const char* strCmdMatchName )
+    {
+        const mxArray* filename = NULL;
+        int            pages    = 0;
+
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) )
+        {
+            return false;
+        }
+
+        if( !selectHandleDb() )
+        {
+            return false;
+        }
+
+        if( !argGetNextLiteral( filename ) || !argGetNextPagesPerStep( pages ) )
+        {
+            // argGetNextLiteral() or argGetNextPagesPerStep() sets m_err
+            return false;
+        }
+
+        if( m_narg > 0 )
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+            return false;
+        }
+
+        char* filename_str = ValueMex( filename ).GetString();
+
+        if( !filename_str )
+        {
+            m_err.set( MSG_ERRMEMORY );
+            return false;
+        }
+
+        (void)SQLstack.current().backupToFile( filename_str, pages, m_err );
+
+        ::utils_free_ptr( filename_str );
+
+        return !errPending();
+    }
+
+
+    /**
+     * \brief Handle backup_status command
+     *
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     *
+     * Returns a struct with the progress of the copy in m_plhs[0]: 
+     * done (1 if finished or if there is no copy), pagecount and remaining.
+     * The count of pages is known after the first step.
+     */
+    bool cmdTryHandleBackupStatus( const char* strCmdMatchName )
+    {
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) )
+        {
+            return false;
+        }
+
+        if( !selectHandleDb() )
+        {
+            return false;
+        }
+
+        if( m_narg > 0 )
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+            return false;
+        }
+
+        static const char* fieldnames[] = { "done", "pagecount", "remaining" };
+
+        SQLbackup* backup = SQLstack.current().backup();
+        mxArray*   result = mxCreateStructMatrix( 1, 1, sizeof( fieldnames ) / sizeof( fieldnames[0] ), fieldnames );
+
+        if( !result )
+        {
+            m_err.set( MSG_CANTCREATEOUTPUT );
+            return false;
+        }
+
+        mxSetField( result, 0, "done",      mxCreateDoubleScalar( ( !backup || backup->isDone() ) ? 1.0 : 0.0 ) );
+        mxSetField( result, 0, "pagecount", mxCreateDoubleScalar( backup ? (double)backup->pagecount() : 0.0 ) );
+        mxSetField( result, 0, "remaining", mxCreateDoubleScalar( backup ? (double)backup->remaining() : 0.0 ) );
+
+        m_plhs[0] = result;
+
+        return true;
+    }
+
+
+    /**
+     * \brief Handle backup_wait command
+     *
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     *
+     * Waits for the copy, optional up to timeout seconds, and returns 1 in
+     * m_plhs[0], if it has finished (or if there is no copy). Errors of the 
+     * copy are reported then. If the timeout elapses first, 0 is returned.
+     */
+    bool cmdTryHandleBackupWait( const char* strCmdMatchName )
+    {
+        double timeout = -1.0;
+
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) )
+        {
+            return false;
+        }
+
+        if( !selectHandleDb() )
+        {
+            return false;
+        }
+
+        // timeout in seconds may be fractional
+        if( m_narg > 0 )
+        {
+            if( !mxIsNumeric( m_parg[0] ) || !ValueMex( m_parg[0] ).IsScalar() )
+            {
+                m_err.set( MSG_NUMARGEXPCT );
+                return false;
+            }
+
+            timeout = ValueMex( m_parg[0] ).GetScalar();
+            m_parg++;
+            m_narg--;
+        }
+
+        if( m_narg > 0 )
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+            return false;
+        }
+
+        SQLstackitem& dbitem = SQLstack.current();
+        SQLbackup*    backup = dbitem.backup();
+
+        if( backup && !backup->wait( timeout ) )
+        {
+            m_plhs[0] = mxCreateDoubleScalar( 0.0 );
+            return true;
+        }
+
+        if( backup )
+        {
+            (void)backup->getResult( m_err );
+            dbitem.releaseBackup();
+        }
+
+        m_plhs[0] = mxCreateDoubleScalar( 1.0 );
+
+        return !errPending();
+    }
+
+
+    /**
+     * \brief Handle backup_cancel command
+     *
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     *
+     * Aborts the copy. The destination is left unchanged, so a database 
+     * loaded by 'load_into_memory' stays empty.
+     */
+    bool cmdTryHandleBackupCancel( const char* strCmdMatchName )
+    {
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) )
+        {
+            return false;
+        }
+
+        if( !selectHandleDb() )
+        {
+            return false;
+        }
+
+        if( m_narg > 0 )
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+            return false;
+        }
+
+        SQLstack.current().releaseBackup();
+
+        return true;
+    }
+    
+    
+    /**
+     * \brief Handle parallel_query command
+     *
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     *
+     * Splits the rowid range [first, last] into contiguous parts, one per 
+     * connection taken from the reader pool. The first two parameters of the
+     * SQL statement take the bounds of each part, the remaining arguments are 
+     * bound like for 'cursor_open'. The parts are stepped by worker threads
+     * and their rows are concatenated in order of the parts. Results are 
+     * returned like for common SQL statements.
+     */
+    bool cmdTryHandleParallelQuery( const char* strCmdMatchName )
+    {
+        const mxArray* query = NULL;
+        sqlite3_int64  first = 0;
+        sqlite3_int64  last  = 0;
+
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) )
+        {
+            return false;
+        }
+
+        if( !selectHandleDb() )
+        {
+            return false;
+        }
+
+        if( !argGetNextLiteral( query ) || !argGetNextInt64( first ) || !argGetNextInt64( last ) )
+        {
+            // argGetNextLiteral() or argGetNextInt64() sets m_err
+            return false;
+        }
+
+        if( first > last )
+        {
+            m_err.set( MSG_INVALIDARG );
+            return false;
+        }
+
+        char* query_str  = ValueMex( query ).GetString();
+        char* query_utf8 = query_str ? createQueryString( query_str ) : NULL;
+
+        ::utils_free_ptr( query_str );
+
+        if( !query_utf8 )
+        {
+            m_err.set( MSG_ERRMEMORY );
+            return false;
+        }
+
+        SQLstackitem&           db      = SQLstack.current();
+        vector<SQLstackitem*>   readers;
+        vector<SQLiface*>       ifaces;
+        vector<SQLrowBuffer>    parts;
+        vector<int>             results;
+        // unsigned difference, since last - first may overflow sqlite3_int64
+        sqlite3_uint64          span    = (sqlite3_uint64)last - (sqlite3_uint64)first;
+
+        // the full int64 range has 2^64 values, one less doesn't matter for the partition
+        if( span < UINT64_MAX )
+        {
+            span++;
+        }
+
+        // One part per connection, but no empty parts
+        while( (sqlite3_uint64)readers.size() < span )
+        {
+            SQLstackitem* reader = db.acquireReader( m_err );
+
+            if( !reader )
+            {
+                break;
+            }
+
+            readers.push_back( reader );
+        }
+
+        if( readers.empty() && !errPending() )
+        {
+            m_err.set( MSG_NOREADER );
+        }
+
+        // Prepare and bind the statement on each connection
+        for( size_t i = 0; !errPending() && i < readers.size(); i++ )
+        {
+            sqlite3_uint64 size  = span / readers.size();
+            sqlite3_uint64 extra = span % readers.size();
+            sqlite3_uint64 start = (sqlite3_uint64)first + i * size + ( i < extra ? (sqlite3_uint64)i : extra );
+            sqlite3_int64  lo    = (sqlite3_int64)start;
+            // the last part ends at last, even if span was capped
+            sqlite3_int64  hi    = ( i + 1 == readers.size() ) ? last : (sqlite3_int64)( start + size + ( i < extra ? 1 : 0 ) - 1 );
+            SQLiface*      iface = new SQLiface( *readers[i] );
+
+            ifaces.push_back( iface );
+
+            if( !iface->setQuery( query_utf8 ) )
+            {
+                const char* errid = NULL;
+                m_err.set( (char*)iface->getErr(&errid), errid );
+            }
+            else if( iface->getParameterCount() < 2 )
+            {
+                m_err.set( MSG_MISSINGARG );
+            }
+            else if( !iface->bindElement( 1, &lo, mxINT64_CLASS, 0 ) || !iface->bindElement( 2, &hi, mxINT64_CLASS, 0 ) )
+            {
+                const char* errid = NULL;
+                m_err.set( (char*)iface->getErr(&errid), errid );
+            }
+            else
+            {
+                // bindArguments() sets m_err
+                (void)bindArguments( iface, /*firstParam*/ 3 );
+            }
+        }
+
+        // Worker threads step through the parts (no MATLAB API calls)
+        if( !errPending() )
+        {
+            parts.resize( ifaces.size() );
+            results.resize( ifaces.size() );
+
+            // all parts together are limited by the memory cap
+            std::atomic<size_t> total( 0 );
+
+            utils_parallel_for( ifaces.size(), (int)ifaces.size(), [&]( size_t i )
+            {
+                results[i] = ifaces[i]->fetchBuffer( parts[i], &total );
+            } );
+
+            for( size_t i = 0; !errPending() && i < ifaces.size(); i++ )
+            {
+                // fetch() reports stopping by the memory cap
+                if( SQLITE_DONE != results[i] && !parts[i].m_capped )
+                {
+                    const char* errid = NULL;
+                    ifaces[i]->setSqlError( results[i] );
+                    m_err.set( (char*)ifaces[i]->getErr(&errid), errid );
+                }
+            }
+        }
+
+        // Concatenate the parts
+        if( !errPending() )
+        {
+            ValueSQLCols cols;
+
+            for( size_t i = 0; !errPending() && i < parts.size(); i++ )
+            {
+                if( !ifaces[0]->fetch( cols, parts[i], /*initialize*/ i == 0, &db ) )
+                {
+                    const char* errid = NULL;
+                    m_err.set( (char*)ifaces[0]->getErr(&errid), errid );
+                }
+            }
+
+            if( !errPending() )
+            {
+                setResults( cols, NULL, 0 );
+            }
+        }
+
+        // query text is referenced by the interfaces
+        for( size_t i = 0; i < ifaces.size(); i++ )
+        {
+            delete ifaces[i];
+        }
+
+        ::utils_free_ptr( query_utf8 );
+
+        for( size_t i = 0; i < readers.size(); i++ )
+        {
+            db.releaseReader( readers[i] );
+        }
+
+        return !errPending();
+    }
+    
+    
+    /**
+     * \brief Get next value as BLOB handle from argument list
+     *
+     * \param[out] refHandle Handle number will be returned in
+     * \returns BLOB opened by 'blob_open', or NULL if handle is unknown for current database
+     */
+    sqlite3_blob* argGetNextBlobHandle( int& refHandle )
+    {
+        if( !argGetNextInteger( refHandle, /*asBoolInt*/ false ) )
+        {
+            // argGetNextInteger() sets m_err
+            return NULL;
+        }
+
+        SQLstackitem::SQLblobMap& blobs = SQLstack.current().blobs();
+        SQLstackitem::SQLblobMap::iterator it = blobs.find( refHandle );
+
+        if( it == blobs.end() )
+        {
+            m_err.set( MSG_INVALIDBLOBHANDLE );
+            return NULL;
+        }
+
+        return it->second;
+    }
+
+
+    /**
+     * \brief Handle blob_open command
+     *
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     *
+     * Opens the BLOB in a column of the row with given rowid for incremental 
+     * I/O, optional writable (mode 1) or read only (mode 0, the default). The 
+     * BLOB handle is returned in m_plhs[0], the BLOB size in bytes in m_plhs[1].
+     */
+    bool cmdTryHandleBlobOpen( const char* strCmdMatchName )
+    {
+        const mxArray* table  = NULL;
+        const mxArray* column = NULL;
+        sqlite3_int64  rowid  = 0;
+        int            mode   = 0;
+
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) )
+        {
+            return false;
+        }
+
+        if( !selectHandleDb() )
+        {
+            return false;
+        }
+
+        if( !argGetNextLiteral( table ) || !argGetNextLiteral( column ) )
+        {
+            // argGetNextLiteral() sets m_err
+            return false;
+        }
+
+        // rowid may exceed the integer range
+        if( m_narg < 1 )
+        {
+            m_err.set( MSG_MISSINGARG );
+            return false;
+        }
+        else if( !mxIsNumeric( m_parg[0] ) || !ValueMex( m_parg[0] ).IsScalar() )
+        {
+            m_err.set( MSG_NUMARGEXPCT );
+            return false;
+        }
+
+        rowid = ( ValueMex( m_parg[0] ).ClassID() == mxINT64_CLASS ) ?
+                ValueMex( m_parg[0] ).GetInt64() : (sqlite3_int64)ValueMex( m_parg[0] ).GetScalar();
+        m_parg++;
+        m_narg--;
+
+        if( m_narg > 0 && !argGetNextInteger( mode, /*asBoolInt*/ true ) )
+        {
+            // argGetNextInteger() sets m_err
+            return false;
+        }
+
+        if( m_narg > 0 )
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+            return false;
+        }
+
+        sqlite3*      db          = SQLstack.current().dbid();
+        sqlite3_blob* blob        = NULL;
+        char*         table_str   = ValueMex( table ).GetEncString();
+        char*         column_str  = ValueMex( column ).GetEncString();
+        int           rc;
+
+        rc = sqlite3_blob_open( db, "main", table_str, column_str, rowid, mode, &blob );
+
+        ::utils_free_ptr( table_str );
+        ::utils_free_ptr( column_str );
+
+        if( SQLITE_OK != rc )
+        {
+            m_err.setSqlError( db, rc );
+            sqlite3_blob_close( blob );
+            return false;
+        }
+
+        int handle = SQLstackitem::newHandle();
+        SQLstack.current().blobs()[handle] = blob;
+
+        m_plhs[0] = mxCreateDoubleScalar( (double)handle );
+
+        if( m_nlhs > 1 )
+        {
+            m_plhs[1] = mxCreateDoubleScalar( (double)sqlite3_blob_bytes( blob ) );
+        }
+
+        return true;
+    }
+
+
+    /**
+     * \brief Handle blob_read command
+     *
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     *
+     * Reads a number of bytes at a byte offset of a BLOB opened by 'blob_open'.
+     * The bytes are read straight into the column vector returned in m_plhs[0],
+     * which is of class uint8 or of the numeric class given as optional argument.
+     */
+    bool cmdTryHandleBlobRead( const char* strCmdMatchName )
+    {
+        int       handle  = 0;
+        int       offset  = 0;
+        int       bytes   = 0;
+        mxClassID clsid   = mxUINT8_CLASS;
+
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) )
+        {
+            return false;
+        }
+
+        if( !selectHandleDb() )
+        {
+            return false;
+        }
+
+        sqlite3_blob* blob = argGetNextBlobHandle( handle );
+
+        if( !blob || !argGetNextInteger( offset, /*asBoolInt*/ false ) || !argGetNextInteger( bytes, /*asBoolInt*/ false ) )
+        {
+            // argGetNextBlobHandle() or argGetNextInteger() sets m_err
+            return false;
+        }
+
+        if( m_narg > 0 )
+        {
+            const mxArray* clsname = NULL;
+
+            if( !argGetNextLiteral( clsname ) )
+            {
+                // argGetNextLiteral() sets m_err
+                return false;
+            }
+
+            char* clsname_str = ValueMex( clsname ).GetString();
+            clsid = clsname_str ? mxClassIDFromClassName( clsname_str ) : mxUNKNOWN_CLASS;
+            ::utils_free_ptr( clsname_str );
+        }
+
+        if( m_narg > 0 )
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+            return false;
+        }
+
+        // only numeric classes, bytes must fill whole elements
+        if( clsid < mxDOUBLE_CLASS || clsid > mxUINT64_CLASS || 
+            offset < 0 || bytes < 0 || bytes % utils_elbytes( clsid ) )
+        {
+            m_err.set( MSG_INVALIDARG );
+            return false;
+        }
+
+        if( (sqlite3_int64)offset + bytes > sqlite3_blob_bytes( blob ) )
+        {
+            m_err.set( MSG_ERRBLOBRANGE );
+            return false;
+        }
+
+        mxArray* data = mxCreateNumericMatrix( bytes / utils_elbytes( clsid ), 1, clsid, mxREAL );
+        int      rc   = bytes ? sqlite3_blob_read( blob, mxGetData( data ), bytes, offset ) : SQLITE_OK;
+
+        if( SQLITE_OK != rc )
+        {
+            ::utils_destroy_array( data );
+            m_err.setSqlError( SQLstack.current().dbid(), rc );
+            return false;
+        }
+
+        m_plhs[0] = data;
+
+        return true;
+    }
+
+
+    /**
+     * \brief Handle blob_write command
+     *
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     *
+     * Writes the raw data of a numeric array at a byte offset into a BLOB 
+     * opened writable by 'blob_open'. The BLOB size can't be changed.
+     */
+    bool cmdTryHandleBlobWrite( const char* strCmdMatchName )
+    {
+        int handle = 0;
+        int offset = 0;
+
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) )
+        {
+            return false;
+        }
+
+        if( !selectHandleDb() )
+        {
+            return false;
+        }
+
+        sqlite3_blob* blob = argGetNextBlobHandle( handle );
+
+        if( !blob || !argGetNextInteger( offset, /*asBoolInt*/ false ) )
+        {
+            // argGetNextBlobHandle() or argGetNextInteger() sets m_err
+            return false;
+        }
+
+        if( m_narg < 1 )
+        {
+            m_err.set( MSG_MISSINGARG );
+            return false;
+        }
+
+        ValueMex data( m_parg[0] );
+        m_parg++;
+        m_narg--;
+
+        if( m_narg > 0 )
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+            return false;
+        }
+
+        if( !data.IsNumeric() || data.IsComplex() || data.IsSparse() || offset < 0 )
+        {
+            m_err.set( MSG_INVALIDARG );
+            return false;
+        }
+
+        if( (sqlite3_int64)offset + (sqlite3_int64)data.ByData() > sqlite3_blob_bytes( blob ) )
+        {
+            m_err.set( MSG_ERRBLOBRANGE );
+            return false;
+        }
+
+        int rc = data.ByData() ? sqlite3_blob_write( blob, data.Data(), (int)data.ByData(), offset ) : SQLITE_OK;
+
+        if( SQLITE_OK != rc )
+        {
+            m_err.setSqlError( SQLstack.current().dbid(), rc );
+            return false;
+        }
+
+        return true;
+    }
+
+
+    /**
+     * \brief Handle blob_close command
+     *
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     *
+     * Closes a BLOB opened by 'blob_open' and releases its handle.
+     */
+    bool cmdTryHandleBlobClose( const char* strCmdMatchName )
+    {
+        int handle = 0;
+
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) )
+        {
+            return false;
+        }
+
+        if( !selectHandleDb() )
+        {
+            return false;
+        }
+
+        sqlite3_blob* blob = argGetNextBlobHandle( handle );
+
+        if( !blob )
+        {
+            // argGetNextBlobHandle() sets m_err
+            return false;
+        }
+
+        if( m_narg > 0 )
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+            return false;
+        }
+
+        SQLstack.current().blobs().erase( handle );
+
+        // The handle is released anyway, even if an error occurred
+        int rc = sqlite3_blob_close( blob );
+
+        if( SQLITE_OK != rc )
+        {
+            m_err.setSqlError( SQLstack.current().dbid(), rc );
+            return false;
+        }
+
+        return true;
+    }
+    
+    
+    /**
+     * \brief Handle language command
+     *
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     * 
+     * Try to interpret current command as status command.
+     * \p strCmdMatchName holds the mksqlite command name.
+     */
+    bool cmdTryHandleLanguage( const char* strCmdMatchName )
+    {
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) ) 
+        {
+            return false;
+        }
+        
+        // Global command, dbid useless
+        warnOnDefDbid();
+        
+        /*
+         * There should be one numeric argument
+         */
+        if( m_narg < 1 ) 
+        {
+            m_err.set( MSG_MISSINGARG );
+            return false;
+        }
+        else if( m_narg > 1 ) 
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+            return false;
+        }
+
+        if( !mxIsNumeric( m_parg[0] ) )
+        {
+            m_err.set( MSG_NUMARGEXPCT );
+            return false;
+        } else {
+            int iLang = ValueMex( m_parg[0] ).GetInt();
+            
+            if( !setLocale( iLang ) )
+            {
+                m_err.set( MSG_INVALIDARG );
+                return false;
+            }
+        }
+
+        return true;
+    }
+    
+    
+    /**
+     * @brief Get the filename of current database
+     * 
+     * @param strCmdMatchName Command name
+     * @return true on success
+     * 
+     * filename will be given in m_plhs[0]
+     */
+    bool cmdTryHandleFilename( const char* strCmdMatchName )
+    {
+        char *db_filename = NULL;
+        char *db_name     = NULL;
+
+        if( errPending() || !STRMATCH( m_command, strCmdMatchName ) )
+        {
+            return false;
+        }
+
+        SQLstack.switchTo( m_dbid-1 );
+
+        // database must be open to change settings
+        if( !ensureDbIsOpen() )
+        {
+            // ensureDbIsOpen() sets m_err
+            return false;
+        }
+        
+        /*
+         * There should be not more than 1 argument to get the db filename
+         */
+        if( m_narg > 1 )
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+            return false;
+        }
+
+        // Check if database name is given (for attached databases)
+        if( m_narg == 1 )
+        {
+            if( !mxIsChar( m_parg[0] ) )
+            {
+                m_err.set( MSG_LITERALARGEXPCT );
+                return false;
+            } else {
+                db_name = ValueMex( m_parg[0] ).GetEncString();
+            }
+        }
+
+        db_filename = ::utils_strnewdup( m_interface->getDbFilename( db_name ), /*flagConvertUTF8*/ true );
+
+        if( NULL == db_filename )
+        {
+            m_plhs[0] = mxCreateString( "" );  // Memory based database
+        }
+        else
+        {
+            m_plhs[0] = mxCreateString( db_filename );  // File based database
+        }
+
+        ::utils_free_ptr( db_name );
+        ::utils_free_ptr( db_filename );
+
+        return true;
+    }
+
+
+    /**
+     * \brief Handle streaming setting command
+     *
+     * \param[in] strCmdMatchName Command name
+     * \returns true on success
+     * 
      * Try to interpret current command as streaming switch.
      * \p strCmdMatchName holds the mksqlite command name.
      * m_plhs[0] will be set to the old setting.
@@ -1723,6 +4109,9 @@ public:
      * - typedBLOBs
      * - NULLasNaN
      * - param_wrapping
+     * - decltype_classes
+     * - null_mask
+     * - text_dictionary
      * - streaming
      * - result_type
      * - compression
@@ -1730,7 +4119,36 @@ public:
      * - show tables
      * - enable extension
      * - status
+     * - stats
+     * - last_query_profile
+     * - slow_query_log
+     * - memstats
+     * - result_memory_cap
+     * - serialize
      * - setbusytimeout
+     * - stmt_cache
+     * - reader_pool
+     * - autotransaction
+     * - threads
+     * - prepare
+     * - exec
+     * - reset
+     * - finalize
+     * - cursor_open
+     * - cursor_fetch
+     * - cursor_close
+     * - blob_open
+     * - blob_read
+     * - blob_write
+     * - blob_close
+     * - submit
+     * - poll
+     * - wait
+     * - backup
+     * - backup_status
+     * - backup_wait
+     * - backup_cancel
+     * - parallel_query
      */
     bool cmdTryHandleNonSqlStatement()
     {
@@ -1739,7 +4157,16 @@ public:
             || cmdTryHandleFlag( "NULLasNaN", g_NULLasNaN )
             || cmdTryHandleFlag( "compression_check", g_compression_check )
             || cmdTryHandleFlag( "param_wrapping", g_param_wrapping )
+            || cmdTryHandleFlag( "decltype_classes", g_decltype_classes )
+            || cmdTryHandleFlag( "null_mask", g_null_mask )
+            || cmdTryHandleTextDictionary( "text_dictionary" )
             || cmdTryHandleStatus( "status" )
+            || cmdTryHandleStats( "stats" )
+            || cmdTryHandleLastQueryProfile( "last_query_profile" )
+            || cmdTryHandleSlowQueryLog( "slow_query_log" )
+            || cmdTryHandleMemStats( "memstats" )
+            || cmdTryHandleResultMemoryCap( "result_memory_cap" )
+            || cmdTryHandleSerialize( "serialize" )
             || cmdTryHandleLanguage( "lang" )
             || cmdTryHandleFilename( "filename" )
             || cmdTryHandleVersion( "version mex", "version sql" )
@@ -1748,6 +4175,29 @@ public:
             || cmdTryHandleResultType( "result_type" )
             || cmdTryHandleCompression( "compression" )
             || cmdTryHandleSetBusyTimeout( "setbusytimeout" )
+            || cmdTryHandleStmtCache( "stmt_cache" )
+            || cmdTryHandleReaderPool( "reader_pool" )
+            || cmdTryHandleAutoTransaction( "autotransaction" )
+            || cmdTryHandleThreads( "threads" )
+            || cmdTryHandlePrepare( "prepare" )
+            || cmdTryHandleExec( "exec" )
+            || cmdTryHandleResetFinalize( "reset", /*finalize*/ false )
+            || cmdTryHandleResetFinalize( "finalize", /*finalize*/ true )
+            || cmdTryHandleCursorOpen( "cursor_open" )
+            || cmdTryHandleCursorFetch( "cursor_fetch" )
+            || cmdTryHandleResetFinalize( "cursor_close", /*finalize*/ true, /*isCursor*/ true )
+            || cmdTryHandleBlobOpen( "blob_open" )
+            || cmdTryHandleBlobRead( "blob_read" )
+            || cmdTryHandleBlobWrite( "blob_write" )
+            || cmdTryHandleBlobClose( "blob_close" )
+            || cmdTryHandleSubmit( "submit" )
+            || cmdTryHandlePoll( "poll" )
+            || cmdTryHandleWait( "wait" )
+            || cmdTryHandleBackup( "backup" )
+            || cmdTryHandleBackupStatus( "backup_status" )
+            || cmdTryHandleBackupWait( "backup_wait" )
+            || cmdTryHandleBackupCancel( "backup_cancel" )
+            || cmdTryHandleParallelQuery( "parallel_query" )
             || cmdTryHandleEnableExtension( "enable extension" )
             || cmdTryHandleCreateFunction( "create function" )
             || cmdTryHandleCreateAggregation( "create aggregation" ) )
@@ -1771,7 +4221,7 @@ public:
     
 
     /// Return values of cmdAnalyseCommand()
-    enum command_e { OPEN, CLOSE, QUERY, DONE, FAILED };
+    enum command_e { OPEN, CLOSE, QUERY, DESERIALIZE, LOAD_INTO_MEMORY, DONE, FAILED };
     
     /**
      * \brief Analyse command string and process if its neither open, close nor a sql command. 
@@ -1786,6 +4236,9 @@ public:
     {
         if( STRMATCH( m_command, "open" ) )     return OPEN;
         if( STRMATCH( m_command, "close" ) )    return CLOSE;
+        if( STRMATCH( m_command, "deserialize" ) ) return DESERIALIZE;
+        if( STRMATCH( m_command, "load_into_memory" ) ) return LOAD_INTO_MEMORY;
+        if( !cmdFinishBackup() )                return FAILED;
         if( cmdTryHandleNonSqlStatement() )     return DONE;
         if( errPending() )                      return FAILED;
         
@@ -1793,16 +4246,38 @@ public:
     }
 
     
+    /// Returns true, if the next argument names an open profile or setting (see cmdHandleOpen())
+    bool argIsOpenOption()
+    {
+        if( m_narg < 1 || !mxIsChar( m_parg[0] ) )
+        {
+            return false;
+        }
+
+        char* name   = ValueMex( m_parg[0] ).GetString();
+        bool  result = name && ( SQLopenOptions::isProfile( name ) || SQLopenOptions::find( name ) >= 0 );
+
+        ::utils_free_ptr( name );
+
+        return result;
+    }
+
+
     /**
      * \brief Handle open command
      *
      * Handle the open command. If the read dbid is -1 a new slot (dbid) 
      * will be used, otherwise the given dbid or, if no dbid was given, the 
      * recent dbid is used.
+     * Open mode and threading mode may be followed by a profile name and 
+     * pairs of setting names and values (see SQLopenOptions). The settings 
+     * are applied before the database is used. If one of them fails, the 
+     * database is closed again.
      */
     bool cmdHandleOpen()
     {
-        int openFlags = 0;
+        int            openFlags = 0;
+        SQLopenOptions options;
 
         if( errPending() ) return false;
         
@@ -1830,7 +4305,7 @@ public:
         /*
          * Open mode (optional)
          */
-        if( m_narg > 0 && !errPending() )
+        if( m_narg > 0 && !errPending() && !argIsOpenOption() )
         {
             char* iomode = ValueMex( m_parg[0] ).GetString();
             
@@ -1865,7 +4340,7 @@ public:
         /*
          * Threading mode (optional)
          */
-        if( m_narg > 0 && !errPending() )
+        if( m_narg > 0 && !errPending() && !argIsOpenOption() )
         {
             char* threadmode = ValueMex( m_parg[0] ).GetString();
             
@@ -1886,17 +4361,225 @@ public:
             } 
             else 
             {
-                m_err.set( MSG_ERRUNKTHREADMODE );
+                m_err.set( MSG_ERRUNKTHREADMODE );
+            }
+            
+            ::utils_free_ptr( threadmode );
+        } 
+        
+        /*
+         * Profile and settings (optional)
+         */
+        while( m_narg > 0 && !errPending() )
+        {
+            char* key = mxIsChar( m_parg[0] ) ? ValueMex( m_parg[0] ).GetString() : NULL;
+
+            m_parg++;
+            m_narg--;
+
+            if( key && options.setProfile( key ) )
+            {
+                /* settings preset */
+            }
+            else if( key && SQLopenOptions::find( key ) >= 0 )
+            {
+                string value;
+
+                if( m_narg < 1 )
+                {
+                    m_err.set( MSG_MISSINGARG );
+                }
+                else if( mxIsChar( m_parg[0] ) )
+                {
+                    char* value_str = ValueMex( m_parg[0] ).GetString();
+
+                    value = value_str ? value_str : "";
+                    ::utils_free_ptr( value_str );
+                }
+                else if( mxIsNumeric( m_parg[0] ) && ValueMex( m_parg[0] ).IsScalar() )
+                {
+                    char buffer[32];
+
+                    snprintf( buffer, sizeof( buffer ), "%lld", (long long)ValueMex( m_parg[0] ).GetScalar() );
+                    value = buffer;
+                }
+
+                if( !errPending() )
+                {
+                    m_parg++;
+                    m_narg--;
+
+                    if( !options.set( key, value ) )
+                    {
+                        m_err.set( MSG_INVALIDARG );
+                    }
+                }
+            }
+            else
+            {
+                m_err.set( MSG_ERRUNKOPENOPTION );
+            }
+
+            ::utils_free_ptr( key );
+        }
+
+        if( !errPending() )
+        {
+            SQLstack.current().openDb( dbname, openFlags, m_err );
+        }
+        
+        /*
+         * Set default busytimeout
+         */
+        if( !errPending() )
+        {
+            const char* errid = NULL;
+
+            delete m_interface;
+            m_interface = SQLstack.createInterface();
+
+            if( !m_interface->setBusyTimeout( MKSQLITE_CONFIG_BUSYTIMEOUT ) )
+            {
+                PRINTF( "%s\n", ::getLocaleMsg( MSG_BUSYTIMEOUTFAIL ) );
+                m_err.set( m_interface->getErr(&errid), errid );
+            }
+        }
+
+        /*
+         * Apply profile and settings, all or none
+         */
+        if( !errPending() )
+        {
+            SQLstackitem& dbitem = SQLstack.current();
+
+            dbitem.openOptions() = options;
+
+            // the database file can't be changed by read-only connections
+            if( SQLITE_OK != dbitem.openOptions().apply( dbitem.dbid(), 
+                                                         ( openFlags & SQLITE_OPEN_READONLY ) ? SQLopenOptions::FIRST_READONLY : 0 ) )
+            {
+                SQLerror close_err;
+
+                m_err.setSqlError( dbitem.dbid(), -1 );
+                (void)dbitem.closeDb( close_err );
+            }
+        }
+        
+        
+        /*
+         * always return the used database id
+         */
+        m_plhs[0] = mxCreateDoubleScalar( (double)m_dbid );
+
+        ::utils_free_ptr( dbname );
+        
+        return !errPending();
+    }
+    
+
+    /**
+     * \brief Handle deserialize command
+     *
+     * Opens the database slot as in-memory database, whose content is the 
+     * image given as uint8 array (see 'serialize'). Like 'open', a dbid of 0
+     * selects a free slot. The image is copied once into memory of SQLite, 
+     * which takes custody of it (SQLITE_DESERIALIZE_FREEONCLOSE), so there
+     * is no disk I/O. With 'readonly' the database can't be changed, with 
+     * 'resizeable' (default) it may grow.
+     */
+    bool cmdHandleDeserialize()
+    {
+        int flags = SQLITE_DESERIALIZE_FREEONCLOSE | SQLITE_DESERIALIZE_RESIZEABLE;
+
+        if( errPending() ) return false;
+
+        /*
+         * There has to be one uint8 array argument, the image
+         */
+        if( !m_narg || mxUINT8_CLASS != mxGetClassID( m_parg[0] ) || mxIsComplex( m_parg[0] ) )
+        {
+            m_err.set( MSG_INVALIDARG );
+            return false;
+        }
+
+        const mxArray* image = m_parg[0];
+        m_parg++;
+        m_narg--;
+
+        /*
+         * Mode (optional)
+         */
+        if( m_narg > 0 )
+        {
+            char* mode = ValueMex( m_parg[0] ).GetString();
+
+            m_parg++;
+            m_narg--;
+
+            if( STRMATCH( mode, "readonly" ) )
+            {
+                flags = SQLITE_DESERIALIZE_FREEONCLOSE | SQLITE_DESERIALIZE_READONLY;
+            }
+            else if( !STRMATCH( mode, "resizeable" ) )
+            {
+                m_err.set( MSG_ERRDESERIALIZEMODE );
+            }
+
+            ::utils_free_ptr( mode );
+        }
+
+        if( m_narg > 0 && !errPending() )
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+        }
+
+        // (re-)open as in-memory database, closes the database if open
+        if( !errPending() )
+        {
+            SQLstack.current().openDbUtf8( ":memory:", SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, m_err );
+        }
+
+        if( !errPending() )
+        {
+            SQLstackitem&   dbitem = SQLstack.current();
+            size_t          bytes  = mxGetNumberOfElements( image );
+            unsigned char*  buffer = (unsigned char*)sqlite3_malloc64( bytes ? bytes : 1 );
+            int             rc;
+
+            if( !buffer )
+            {
+                m_err.set( MSG_ERRMEMORY );
+            }
+            else
+            {
+                if( bytes )
+                {
+                    memcpy( buffer, mxGetData( image ), bytes );
+                }
+
+                // SQLite frees the buffer, even on failure
+                rc = sqlite3_deserialize( dbitem.dbid(), "main", buffer, (sqlite3_int64)bytes, (sqlite3_int64)bytes, flags );
+
+                // the image is read lazily, so check it's a database now
+                if( SQLITE_OK == rc )
+                {
+                    rc = sqlite3_exec( dbitem.dbid(), "SELECT count(*) FROM sqlite_master", NULL, NULL, NULL );
+                }
+
+                if( SQLITE_OK != rc )
+                {
+                    m_err.setSqlError( dbitem.dbid(), -1 );
+                }
+            }
+
+            if( errPending() )
+            {
+                SQLerror close_err;
+
+                (void)dbitem.closeDb( close_err );
             }
-            
-            ::utils_free_ptr( threadmode );
-        } 
-        
-        if( !errPending() )
-        {
-            SQLstack.current().openDb( dbname, openFlags, m_err );
         }
-        
+
         /*
          * Set default busytimeout
          */
@@ -1913,18 +4596,78 @@ public:
                 m_err.set( m_interface->getErr(&errid), errid );
             }
         }
-        
-        
+
+        /*
+         * always return the used database id
+         */
+        m_plhs[0] = mxCreateDoubleScalar( (double)m_dbid );
+
+        return !errPending();
+    }
+
+
+    /**
+     * \brief Handle load_into_memory command
+     *
+     * Opens the database slot as in-memory database and copies the database
+     * file given as argument into it (online backup API), optional followed
+     * by the count of pages copied per step. Like 'open', a dbid of 0 selects
+     * a free slot. The pages are copied by a worker thread, so the command
+     * returns at once. Other commands on this database wait, until the copy 
+     * has finished (see 'backup_status').
+     */
+    bool cmdHandleLoadIntoMemory()
+    {
+        int pages = 0;
+
+        if( errPending() ) return false;
+
+        /*
+         * There has to be one string argument, the database filename
+         */
+        if( !m_narg || !mxIsChar( m_parg[0] ) )
+        {
+            m_err.set( MSG_NOOPENARG );
+            return false;
+        }
+
+        char* dbname = ValueMex( m_parg[0] ).GetString();
+        m_parg++;
+        m_narg--;
+
+        if( argGetNextPagesPerStep( pages ) && m_narg > 0 )
+        {
+            m_err.set( MSG_UNEXPECTEDARG );
+        }
+
+        if( !dbname && !errPending() )
+        {
+            m_err.set( MSG_ERRMEMORY );
+        }
+
+        // (re-)open as in-memory database, closes the database if open
+        if( !errPending() )
+        {
+            (void)SQLstack.current().loadIntoMemory( dbname, pages, m_err );
+        }
+
+        // busy timeout is already set, the connection is used by the worker thread
+        if( !errPending() )
+        {
+            delete m_interface;
+            m_interface = SQLstack.createInterface();
+        }
+
         /*
          * always return the used database id
          */
         m_plhs[0] = mxCreateDoubleScalar( (double)m_dbid );
 
         ::utils_free_ptr( dbname );
-        
+
         return !errPending();
     }
-    
+
 
    /**
     * \brief Handle close command
@@ -1978,8 +4721,30 @@ public:
      */
     ValueMex createItemFromValueSQL( const ValueSQL& value )
     {
-        int err_id = MSG_NOERROR;
+        // typed BLOB unpacked in advance?
+        if( value.m_typeID == SQLITE_BLOB && !m_unpacked.empty() )
+        {
+            map<const mxArray*, mxArray*>::iterator it = m_unpacked.find( value.m_blob );
+            
+            if( it != m_unpacked.end() )
+            {
+                mxArray* item = it->second;
+                
+                m_unpacked.erase( it );
+                return ValueMex( item ).Adopt();
+            }
+        }
+        
+        int       err_id = MSG_NOERROR;
+        SQLstats* stats  = ( value.m_typeID == SQLITE_BLOB && typed_blobs_mode_on() ) ? SQLstack.current().activeStats() : NULL;
+        SQLstats::Timer timer( stats ? &stats->m_unpack_time : NULL );
+
         ValueMex item = ::createItemFromValueSQL( value, err_id );
+        
+        if( stats )
+        {
+            stats->m_unpacked++;
+        }
 
         if( MSG_NOERROR != err_id )
         {
@@ -1990,6 +4755,95 @@ public:
     }
     
     
+    /**
+     * \brief Decompress typed BLOBs of a fetched table in parallel
+     *
+     * @param[in] cols container for SQLite fetched table
+     *
+     * The MATLAB arrays for typed BLOBs are created in advance on the main
+     * thread, while compressed data is unpacked by \ref g_threads threads 
+     * directly into them. createItemFromValueSQL() takes the arrays from 
+     * \p m_unpacked then.
+     */
+    void unpackBlobs( ValueSQLCols& cols )
+    {
+        vector<BlobUnpackJob*> jobs;
+
+        if( g_threads < 2 || !typed_blobs_mode_on() )
+        {
+            return;
+        }
+
+        SQLstats* stats = SQLstack.current().activeStats();
+        SQLstats::Timer timer( stats ? &stats->m_unpack_time : NULL );
+
+        // iterate columns and rows, create MATLAB arrays and collect the decompression jobs
+        for( int i = 0; !errPending() && i < (int)cols.size(); i++ )
+        {
+            for( int row = 0; !errPending() && cols[i].m_isAnyType && row < (int)cols[i].size(); row++ )
+            {
+                const ValueSQL value = cols[i][row];
+
+                if( value.m_typeID != SQLITE_BLOB || !ValueMex( value.m_blob ).ByData() )
+                {
+                    continue;
+                }
+
+                mxArray*       item   = NULL;
+                BlobUnpackJob* job    = NULL;
+                double         dummy  = 0.0;
+                int            err_id = blob_unpack( ValueMex( value.m_blob ).Data(), ValueMex( value.m_blob ).ByData(), 
+                                                     can_serialize(), &item, &dummy, &dummy, &job );
+
+                if( MSG_NOERROR != err_id )
+                {
+                    m_err.set( err_id );
+                }
+                else
+                {
+                    m_unpacked[value.m_blob] = item;
+
+                    if( stats )
+                    {
+                        stats->m_unpacked++;
+                    }
+                }
+
+                if( job )
+                {
+                    jobs.push_back( job );
+                }
+            }
+        }
+
+        // decompression doesn't call MATLAB API functions, so it may run on worker threads
+        if( !errPending() )
+        {
+            ::utils_parallel_for( jobs.size(), g_threads, [&jobs]( size_t k ) { jobs[k]->run(); } );
+        }
+
+        for( size_t k = 0; k < jobs.size(); k++ )
+        {
+            if( !errPending() && !jobs[k]->m_ok )
+            {
+                m_err.set( MSG_ERRCOMPRESSION );
+            }
+            delete jobs[k];
+        }
+    }
+
+
+    /// Destroy typed BLOBs unpacked in advance, but not taken by the result
+    void releaseUnpackedBlobs()
+    {
+        for( map<const mxArray*, mxArray*>::iterator it = m_unpacked.begin(); it != m_unpacked.end(); it++ )
+        {
+            ::utils_destroy_array( it->second );
+        }
+        m_unpacked.clear();
+    }
+    
+    
     /**
      * \brief Create a MATLAB cell array of column names
      *
@@ -2092,6 +4946,74 @@ public:
     }
     
     
+    /**
+     * \brief Create the dictionary of a dictionary encoded column
+     *
+     * @param[in] col Dictionary encoded column
+     * @returns a MATLAB cellstr (Nx1) with the distinct TEXT values of
+     *  the column, where the column codes are the indices into it.
+     */
+    mxArray* createDictionaryFromCol( ValueSQLCol& col )
+    {
+        mxArray* dict = mxCreateCellMatrix( (mwSize)col.m_dict.size(), 1 );
+        
+        for( int i = 0; dict && i < (int)col.m_dict.size(); i++ )
+        {
+            mxArray* item = mxCreateString( col.m_dict[i].c_str() );
+            
+            if( !item )
+            {
+                ::utils_destroy_array( dict );
+            }
+            else
+            {
+                mxSetCell( dict, i, item );
+            }
+        }
+        
+        return dict;
+    }
+    
+    
+    /**
+     * \brief Transform dictionary codes to a MATLAB categorical array
+     *
+     * @param[in] codes Dictionary codes (uint32, 0=NULL)
+     * @param[in] dict Dictionary (cellstr)
+     * @returns a MATLAB categorical array, where codes of 0 are undefined
+     *  or NULL on failure (categorical arrays require MATLAB R2013b or later)
+     */
+    mxArray* createCategorical( mxArray* codes, mxArray* dict )
+    {
+        mxArray* result   = NULL;
+        mxArray* valueset = mxCreateNumericMatrix( mxGetNumberOfElements( dict ), 1, mxUINT32_CLASS, mxREAL );
+        
+        if( valueset )
+        {
+            unsigned int* code = (unsigned int*)mxGetData( valueset );
+            
+            for( int i = 0; i < (int)mxGetNumberOfElements( dict ); i++ )
+            {
+                code[i] = (unsigned int)i + 1;
+            }
+            
+            // categorical( codes, valueset, dict )
+            mxArray* args[]    = { codes, valueset, dict };
+            mxArray* exception = mexCallMATLABWithTrap( 1, &result, 3, args, "categorical" );
+            
+            if( exception )
+            {
+                ::utils_destroy_array( exception );
+                ::utils_destroy_array( result );
+            }
+        }
+        
+        ::utils_destroy_array( valueset );
+        
+        return result;
+    }
+    
+    
     /**
      * \brief Transform SQL fetch to MATLAB struct of arrays
      *
@@ -2110,18 +5032,50 @@ public:
          * Allocate a MATLAB struct of arrays to return as result
          */
         mxArray* result = mxCreateStructMatrix( 1, 1, 0, NULL );
+        int      rows   = (int)cols[0].size();  // column buffers will be released
+
+        // additional fields (<name>_dict, <name>_isnull) must not collide with column fields
+        unordered_set<string>     used;
+        unordered_map<string,int> suffixes;
+
+        for( int i = 0; i < (int)cols.size(); i++ )
+        {
+            used.insert( cols[i].m_name );
+        }
 
         // iterate columns
         for( int i = 0; !errPending() && i < (int)cols.size(); i++ )
         {
             mxArray* column = NULL;
+            mxArray* dict   = NULL;
             int j;
 
-            // Pure floating point can be archieved in a numeric matrix
+            // dictionary columns without any TEXT value are returned as common columns
+            if( cols[i].m_isDict && !cols[i].m_dict.size() )
+            {
+                cols[i].swapFromDict();
+            }
+
+            // Pure floating point (or int64, or declared type) can be archieved in a numeric matrix
             // mixed types must be stored in a cell matrix
-            column = cols[i].m_isAnyType ?
-                     mxCreateCellMatrix( (int)cols[0].size(), 1 ) :
-                     mxCreateDoubleMatrix( (int)cols[0].size(), 1, mxREAL );
+            if( cols[i].m_isAnyType )
+            {
+                column = mxCreateCellMatrix( rows, 1 );
+            }
+            else if( cols[i].m_isDict )
+            {
+                column = mxCreateNumericMatrix( 0, 1, mxUINT32_CLASS, mxREAL );
+            }
+            else if( cols[i].isNative() )
+            {
+                column = ( cols[i].m_class == mxLOGICAL_CLASS ) ?
+                         mxCreateLogicalMatrix( 0, 1 ) :
+                         mxCreateNumericMatrix( 0, 1, cols[i].m_class, mxREAL );
+            }
+            else
+            {
+                column = mxCreateNumericMatrix( 0, 1, cols[i].m_isInteger ? mxINT64_CLASS : mxDOUBLE_CLASS, mxREAL );
+            }
 
             // add a new field in the struct
             if( !result || !column || -1 == ( j = mxAddField( result, cols[i].m_name.c_str() ) ) )
@@ -2132,12 +5086,23 @@ public:
 
             if( !cols[i].m_isAnyType )
             {
-                // fast copy of pure floating point data, iterating rows
-                for( int row = 0; !errPending() && row < (int)cols[i].size(); row++ )
+                // pure floating point (or int64) data, the column buffer is adopted without copying
+                if( !errPending() && rows )
                 {
-                    assert( cols[i][row].m_typeID == SQLITE_FLOAT );
-                    mxGetPr(column)[row] = cols[i][row].m_float;
-                } /* end for (rows) */
+                    if( cols[i].m_isDict )
+                    {
+                        mxSetData( column, cols[i].m_codes.release() );
+                    }
+                    else if( cols[i].isNative() )
+                    {
+                        mxSetData( column, cols[i].m_native.release() );
+                    }
+                    else
+                    {
+                        mxSetData( column, cols[i].m_isInteger ? (void*)cols[i].m_int.release() : (void*)cols[i].m_float.release() );
+                    }
+                    mxSetM( column, (mwSize)rows );
+                }
             }
             else
             {
@@ -2164,12 +5129,88 @@ public:
                 } /* end for (rows) */
             } /* end if */
 
+            // dictionary codes are indices into the dictionary of distinct TEXT values
+            if( !errPending() && cols[i].m_isDict )
+            {
+                dict = createDictionaryFromCol( cols[i] );
+
+                if( !dict )
+                {
+                    m_err.set( MSG_ERRMEMORY );
+                    ::utils_destroy_array( column );
+                }
+                else if( g_text_dictionary == TEXT_DICTIONARY_CATEGORICAL )
+                {
+                    mxArray* item = createCategorical( column, dict );
+
+                    ::utils_destroy_array( column );
+                    ::utils_destroy_array( dict );
+
+                    if( !item )
+                    {
+                        m_err.set( MSG_ERRCATEGORICAL );
+                    }
+                    column = item;
+                }
+            }
+
             if( !errPending() )
             {
                 // assign columns data to struct field
                 mxSetFieldByNumber( result, 0, j, column );
                 column = NULL;  // Do not destroy! (Occupied by MATLAB struct now)
             }
+
+            // the dictionary is given by an additional field <name>_dict
+            if( !errPending() && dict )
+            {
+                string name = cols[i].m_name.substr( 0, g_namelengthmax - 5 ) + "_dict";
+
+                if( !SQLiface::makeUniqueName( name, used, suffixes ) )
+                {
+                    m_err.set( MSG_ERRVARNAME );
+                }
+                else if( -1 == ( j = mxAddField( result, name.c_str() ) ) )
+                {
+                    m_err.set( MSG_ERRMEMORY );
+                }
+                else
+                {
+                    mxSetFieldByNumber( result, 0, j, dict );
+                    dict = NULL;  // Do not destroy! (Occupied by MATLAB struct now)
+                }
+            }
+            ::utils_destroy_array( dict );
+
+            // NULLs of masked columns are given by an additional logical field <name>_isnull.
+            // With NULL masks the field is always present, so the fields don't depend on the data.
+            if( !errPending() && !cols[i].m_isAnyType && !cols[i].m_isDict && 
+                ( cols[i].hasNull() || ( g_null_mask && cols[i].m_isMasked ) ) )
+            {
+                string   name = cols[i].m_name.substr( 0, g_namelengthmax - 7 ) + "_isnull";
+                mxArray* mask = NULL;
+
+                if( !SQLiface::makeUniqueName( name, used, suffixes ) )
+                {
+                    m_err.set( MSG_ERRVARNAME );
+                }
+                else if( !( mask = mxCreateLogicalMatrix( 0, 1 ) ) || -1 == ( j = mxAddField( result, name.c_str() ) ) )
+                {
+                    m_err.set( MSG_ERRMEMORY );
+                    ::utils_destroy_array( mask );
+                }
+                else
+                {
+                    if( rows )
+                    {
+                        assert( cols[i].m_isnull.size() == (size_t)rows );
+                        mxSetData( mask, cols[i].m_isnull.release() );
+                        mxSetM( mask, (mwSize)rows );
+                    }
+                    mxSetFieldByNumber( result, 0, j, mask );
+                }
+            }
+            cols[i].m_isnull.clear();
         } /* end for (cols) */
         
         return result;
@@ -2180,13 +5221,14 @@ public:
      * \brief Transform SQL fetch to MATLAB (cell) array
      *
      * @param[in] cols SQLite fetched table
+     * @param[out] nullMask If not NULL, a logical MxN matrix marking the NULLs is returned here
      * @returns a MATLAB cell array. The array is organized as MxN matrix,
      *  where M is the row count of the table, that \a cols holds and N 
      *  is its column count. 
      *
      * @see g_result_type
      */
-    mxArray* createResultAsMatrix( ValueSQLCols& cols )
+    mxArray* createResultAsMatrix( ValueSQLCols& cols, mxArray** nullMask = NULL )
     {
         bool allFloat = true;
         
@@ -2203,9 +5245,48 @@ public:
         /*
          * Allocate a MATLAB matrix or cell array to return as result
          */
-        mxArray* result = allFloat ?
-                 mxCreateDoubleMatrix( (int)cols[0].size(), (int)cols.size(), mxREAL ) :
-                 mxCreateCellMatrix( (int)cols[0].size(), (int)cols.size() );
+        mxArray* result = NULL;
+        size_t   rows   = cols[0].size();  // column buffers will be released
+        
+        if( nullMask )
+        {
+            // NULL mask must be built before column buffers get released
+            *nullMask = mxCreateLogicalMatrix( rows, cols.size() );
+            
+            if( !*nullMask )
+            {
+                m_err.set( MSG_ERRMEMORY );
+                return NULL;
+            }
+            
+            mxLogical* mask = mxGetLogicals( *nullMask );
+            
+            for( int i = 0; i < (int)cols.size(); i++ )
+            {
+                for( int row = 0; row < (int)rows; row++ )
+                {
+                    *mask++ = cols[i].m_isAnyType ? cols[i].m_any[row].m_typeID == SQLITE_NULL : cols[i].isNull( row );
+                }
+            }
+        }
+        
+        if( allFloat && cols.size() == 1 && rows )
+        {
+            // single column, the column buffer is adopted without copying
+            result = mxCreateDoubleMatrix( 0, 1, mxREAL );
+
+            if( result )
+            {
+                mxSetData( result, cols[0].m_float.release() );
+                mxSetM( result, (mwSize)rows );
+            }
+        }
+        else
+        {
+            result = allFloat ?
+                     mxCreateDoubleMatrix( (int)cols[0].size(), (int)cols.size(), mxREAL ) :
+                     mxCreateCellMatrix( (int)cols[0].size(), (int)cols.size() );
+        }
 
         // iterate columns
         for( int i = 0; !errPending() && i < (int)cols.size(); i++ )
@@ -2216,34 +5297,35 @@ public:
                 ::utils_destroy_array( result );
             }
 
+            if( allFloat )
+            {
+                // fast copy of pure floating point data, column buffer is released afterwards
+                if( !errPending() && cols[i].size() )
+                {
+                    memcpy( mxGetPr(result) + i * rows, cols[i].m_float.data(), rows * sizeof(double) );
+                    cols[i].m_float.clear();
+                }
+                continue;
+            }
+
             // iterate rows
             for( int row = 0; !errPending() && row < (int)cols[i].size(); row++ )
             {
-                if( allFloat )
-                {
-                    assert( cols[i][row].m_typeID == SQLITE_FLOAT );
-                    double dVal = cols[i][row].m_float;
+                mxArray* item = createItemFromValueSQL( cols[i][row] ).Detach();
 
-                    mxGetPr(result)[i * (int)cols[0].size() + row] = dVal;
+                if( !item )
+                {
+                    m_err.set( MSG_ERRMEMORY );
                 }
                 else
                 {
-                    mxArray* item = createItemFromValueSQL( cols[i][row] ).Detach();
-
-                    if( !item )
-                    {
-                        m_err.set( MSG_ERRMEMORY );
-                    }
-                    else
-                    {
-                        // destroy previous item
-                        mxDestroyArray( mxGetCell( result, i * (int)cols[i].size() + row ) );
-                        // and replace with new one
-                        mxSetCell( result, i * (int)cols[i].size() + row, item );
+                    // destroy previous item
+                    mxDestroyArray( mxGetCell( result, i * (int)cols[i].size() + row ) );
+                    // and replace with new one
+                    mxSetCell( result, i * (int)cols[i].size() + row, item );
 
-                        cols[i].Destroy(row);  // release memory
-                        item = NULL;  // Do not destroy! (Occupied by MATLAB cell array now)
-                    }
+                    cols[i].Destroy(row);  // release memory
+                    item = NULL;  // Do not destroy! (Occupied by MATLAB cell array now)
                 }
             } /* end for (rows) */
         } /* end for (cols) */
@@ -2277,58 +5359,346 @@ public:
         // m_query can be already set i.e. in case of command 'show tables'
         if( !m_query )
         {
-            // Do the charset conversion and append a semicolon
-            char* new_command = NULL;
-            int cmd_length = ::utils_latin2utf( (const unsigned char*)m_command );
+            char* new_command = createQueryString( m_command );
             
-            if( cmd_length < strlen( m_command ) )
+            if( !new_command )
             {
-                cmd_length = (int)strlen( m_command );
+                m_err.set( MSG_ERRMEMORY );
+                return false;
             }
             
-            new_command = (char*)MEM_ALLOC( cmd_length + 2, 1 );
+            ::utils_free_ptr( m_command );
+            m_command = new_command;
             
-            if( !new_command )
+            m_query = m_command;
+        }
+        
+        SQLstackitem&   dbitem  = SQLstack.current();
+        bool            slowlog = MKSQLITE_CONFIG_USE_LOGGING && g_slow_query_time > 0.0;
+        SQLstats        start;  // counters before, for the slow query log
+        bool            result;
+
+        if( slowlog )
+        {
+            start = dbitem.stats();
+            dbitem.setSampling( true );
+        }
+
+        {
+            SQLstats* stats = dbitem.activeStats();
+            SQLstats::Timer timer( stats ? &stats->m_total_time : NULL );
+
+            if( stats )
+            {
+                stats->m_calls++;
+            }
+
+            /*** prepare statement ***/
+
+            if( !m_interface->setQuery( m_query ) )
+            {
+                const char* errid = NULL;
+                m_err.set( m_interface->getErr(&errid), errid );
+                result = false;
+            }
+            else
+            {
+                result = execStatement( m_interface, /*persistent*/ false );
+            }
+        }
+
+        if( slowlog )
+        {
+            SQLstats delta = dbitem.stats().since( start );
+
+            dbitem.setSampling( false );
+
+            if( !g_stats )
+            {
+                // counters were sampled for this statement only
+                dbitem.stats() = start;
+            }
+
+            if( delta.m_total_time >= g_slow_query_time )
+            {
+                logSlowQuery( delta, result );
+            }
+        }
+
+        return result;
+        
+    } /* end cmdHandleSQLStatement() */
+
+
+    /**
+     * \brief Write a slow SQL statement to the log file
+     *
+     * \param[in] delta Counters collected while the statement was running
+     * \param[in] succeeded false, if the statement failed
+     *
+     * The entry holds the SQL text, the shapes of the bound arguments, the 
+     * row count, the timing breakdown and the query plan, captured by a 
+     * side statement "EXPLAIN QUERY PLAN ...".
+     */
+    void logSlowQuery( const SQLstats& delta, bool succeeded )
+    {
+#if MKSQLITE_CONFIG_USE_LOGGING
+        string params;
+        string plan;
+        char   buffer[64];
+
+        for( int i = 0; i < m_narg; i++ )
+        {
+            const mwSize* dims  = mxGetDimensions( m_parg[i] );
+            mwSize        ndims = mxGetNumberOfDimensions( m_parg[i] );
+
+            params += i ? ", " : "";
+
+            for( mwSize d = 0; d < ndims; d++ )
+            {
+                snprintf( buffer, sizeof( buffer ), d ? "x%lu" : "%lu", (unsigned long)dims[d] );
+                params += buffer;
+            }
+
+            params += string( " " ) + mxGetClassName( m_parg[i] );
+        }
+
+        // indent the plan below the entry
+        string steps = m_interface->explainQueryPlan( m_query );
+        size_t pos   = 0;
+
+        while( pos < steps.size() )
+        {
+            size_t eol = steps.find( '\n', pos );
+
+            if( eol == string::npos )
+            {
+                eol = steps.size();
+            }
+
+            plan += "\n    " + steps.substr( pos, eol - pos );
+            pos   = eol + 1;
+        }
+
+        // times in milliseconds
+        log_warn( "slow query (%.3f ms%s): %s\n"
+                  "  parameters: %s\n"
+                  "  rows: %.0f\n"
+                  "  timing: prepare %.3f ms, step %.3f ms, columns %.3f ms, convert %.3f ms, "
+                  "pack %.3f ms, unpack %.3f ms, results %.3f ms\n"
+                  "  query plan:%s",
+                  1e3 * delta.m_total_time, succeeded ? "" : ", failed", m_query,
+                  params.empty() ? "(none)" : params.c_str(),
+                  delta.m_rows,
+                  1e3 * delta.m_prepare_time, 1e3 * delta.m_step_time, 1e3 * delta.m_column_time, 1e3 * delta.m_convert_time,
+                  1e3 * delta.m_pack_time, 1e3 * delta.m_unpack_time, 1e3 * delta.m_result_time,
+                  plan.empty() ? " (none)" : plan.c_str() );
+#else
+        (void)delta;
+        (void)succeeded;
+#endif
+    }
+
+
+    /**
+     * \brief Convert a query string to UTF-8 (optional) and append a semicolon
+     *
+     * \param[in] command Query string
+     * \returns New allocated string (MEM_ALLOC), or NULL if out of memory
+     */
+    char* createQueryString( const char* command )
+    {
+        char*  new_command = NULL;
+        size_t cmd_length  = strlen( command );
+        
+        // each character takes 2 bytes at most, so one pass converts the query
+        new_command = (char*)MEM_ALLOC( ( g_convertUTF8 ? 2 * cmd_length : cmd_length ) + 2, 1 );
+        
+        if( !new_command )
+        {
+            return NULL;
+        }
+        
+        if( g_convertUTF8 )
+        {
+            int bytes = ::utils_latin2utf_n( (const unsigned char*)command, cmd_length, (unsigned char*)new_command );
+            sprintf( new_command + bytes - 1, ";" );
+        }
+        else
+        {
+            sprintf( new_command, "%s;", command );
+        }
+
+        return new_command;
+    }
+
+
+    /**
+     * \brief Get the columns of a columnar bind argument
+     *
+     * \param[in] iface SQL interface holding the prepared statement
+     * \param[in] arg Numeric NxK matrix (K is the parameter count), or scalar struct
+     *                with Nx1 numeric, logical or cell fields named by the parameters
+     * \param[out] columns Array holding the column, one per parameter
+     * \param[out] offsets Element offset of the column in its array, one per parameter
+     * \param[out] rows Row count N
+     * \returns true, if \p arg is a columnar bind argument
+     */
+    bool getBindColumns( SQLiface* iface, const ValueMex& arg, vector<const mxArray*>& columns, vector<size_t>& offsets, int& rows )
+    {
+        int argsNeeded = iface->getParameterCount();
+        
+        columns.clear();
+        offsets.clear();
+        
+        if( arg.IsNumeric() )
+        {
+            // NxK matrix, each matrix column is bound to one parameter
+            if( arg.IsComplex() || arg.IsSparse() || arg.NumDims() != 2 || (int)arg.GetN() != argsNeeded )
             {
-                m_err.set( MSG_ERRMEMORY );
                 return false;
             }
             
-            if( g_convertUTF8 )
+            rows = (int)arg.GetM();
+            
+            for( int iParam = 0; iParam < argsNeeded; iParam++ )
             {
-                ::utils_latin2utf( (const unsigned char*)m_command, (unsigned char*)new_command );
-                sprintf( new_command + strlen( new_command ), ";" );
+                columns.push_back( arg.Item() );
+                offsets.push_back( (size_t)iParam * rows );
             }
-            else
+            return true;
+        }
+        
+        if( arg.IsStruct() && arg.IsScalar() )
+        {
+            // scalar struct, each field (column vector) is bound to the parameter of the same name
+            bool haveCell = false;
+            
+            for( int iParam = 0; iParam < argsNeeded; iParam++ )
             {
-                sprintf( new_command, "%s;", m_command );
+                const char* name = iface->getParameterName( iParam + 1 );
+                int fieldnum     = name ? arg.GetFieldNumber( ++name ) : -1;  // adjusting name behind either '?', ':', '$' or '@'!
+                ValueMex column  = ValueMex( fieldnum >= 0 ? arg.GetFieldByNumber( 0, fieldnum ) : NULL );
+                
+                if( !column.Item() || !( column.IsNumeric() || column.IsCell() ) || column.IsComplex() || 
+                    column.IsSparse() || column.NumDims() != 2 || column.GetN() != 1 ||
+                    ( iParam > 0 && (int)column.GetM() != rows ) )
+                {
+                    return false;
+                }
+                
+                rows      = (int)column.GetM();
+                haveCell |= column.IsCell();
+                
+                columns.push_back( column.Item() );
+                offsets.push_back( 0 );
             }
-            ::utils_free_ptr( m_command );
-            m_command = new_command;
             
-            m_query = m_command;
+            // single row of cells is bound as usual
+            return argsNeeded > 0 && ( rows > 1 || !haveCell );
         }
         
-        /*** prepare statement ***/
+        return false;
+    }
+
+
+    /**
+     * \brief Commit a transaction opened by automatic transactions
+     *
+     * \param[in] iface SQL interface holding the prepared statement
+     * \param[in] savepoint true, if the transaction is a savepoint within an open transaction
+     * \param[in] rows Number of rows committed
+     * \param[in] restart If true, a new transaction is opened afterwards
+     * \returns true on success
+     *
+     * A pending error is kept, rows executed so far are committed anyway (as 
+     * without automatic transactions). If the commit fails, the transaction
+     * is rolled back, so the connection is left as before the call. The 
+     * error of the commit is appended to a pending error then.
+     */
+    bool commitAutoTransaction( SQLiface* iface, bool savepoint, int rows, bool restart )
+    {
+        const char* query = savepoint ? "RELEASE mksqlite_autotransaction;" : "COMMIT;";
+        bool        pending       = errPending();
+        const char* pending_errid = NULL;
+        string      pending_err;
+
+        if( restart )
+        {
+            query = savepoint ? "RELEASE mksqlite_autotransaction; SAVEPOINT mksqlite_autotransaction;" : "COMMIT; BEGIN;";
+        }
+
+        // message text may be held by the interface and overwritten by the commit
+        if( pending )
+        {
+            pending_err = m_err.get( &pending_errid );
+        }
+
+        // statement must not be active while committing
+        iface->reset();
 
-        if( !m_interface->setQuery( m_query ) )
+        if( !iface->execute( query ) )
         {
             const char* errid = NULL;
-            m_err.set( m_interface->getErr(&errid), errid );
+            string      commit_err = iface->getErr( &errid );
+
+            // don't leave the transaction open, rows of this batch are discarded
+            (void)iface->execute( savepoint ? "ROLLBACK TO mksqlite_autotransaction; RELEASE mksqlite_autotransaction;" : "ROLLBACK;" );
+
+            if( pending )
+            {
+                m_err.set_printf( "%s (%s)", pending_errid, pending_err.c_str(), commit_err.c_str() );
+            }
+            else
+            {
+                // message text is copied (non-const)
+                m_err.set( (char*)commit_err.c_str(), errid );
+            }
             return false;
         }
 
+        if( rows > 0 )
+        {
+            SQLstack.current().countAutoTransaction( rows );
+        }
+
+        return true;
+    }
+
+
+    /**
+     * \brief Bind arguments to a prepared statement, execute it and return the results
+     *
+     * \param[in] iface SQL interface holding the prepared statement
+     * \param[in] persistent If true, the statement is only reset afterwards (statement
+     *                       handles), otherwise it will be finalized
+     * \returns true on success
+     *
+     * Remaining arguments are bound to the statement parameters, results are
+     * set in m_plhs.
+     */
+    bool execStatement( SQLiface* iface, bool persistent )
+    {
         /*** Progress parameters for subsequent queries ***/
 
         ValueSQLCols     cols;
         const mxArray**  nextBindParam       = m_parg;
         int              countBindParam      = m_narg;
-        int              argsNeeded          = m_interface->getParameterCount();
+        int              argsNeeded          = iface->getParameterCount();
         bool             haveParamCell       = false;
         bool             haveParamStruct     = false;
+        bool             haveParamColumns    = false;
         long*            last_insert_row     = NULL;  // kv69: for storing last_insert_row_id after each statement reuse
         bool             initialize          = true;  // kv69: flag indicating initialization within first call of fetch procedure
         int              count               = 1;     // kv69: number of repeated statements calls 
+        vector<int>      fieldNumbers;                // field numbers of struct argument, one per parameter
+        vector<const mxArray*> bindColumns;           // columns of columnar argument, one per parameter
+        vector<size_t>   bindOffsets;                 // element offsets of bindColumns
+        bool             haveAutoTransaction = false; // transaction opened by automatic transactions
+        bool             haveSavepoint       = false; // automatic transaction is a savepoint
+        int              autoTransactionRows = 0;     // rows executed in current automatic transaction
+        const mxArray**  firstBindParam      = NULL;  // first wrapped argument
+        BlobPackPipeline* pipeline           = NULL;  // typed BLOBs compressed in advance by worker threads
 
 
 
@@ -2368,8 +5738,15 @@ public:
             }
         }
 
+        // Check if a single NxK matrix or a scalar struct of column vectors is passed,
+        // then each row is bound straight from the column memory (parameter wrapping only)
+        if( g_param_wrapping && countBindParam == 1 && !haveParamCell && argsNeeded > 1 )
+        {
+            haveParamColumns = getBindColumns( iface, ValueMex(*nextBindParam), bindColumns, bindOffsets, count );
+        }
+
         // Check if a single struct argument is passed
-        if( countBindParam == 1 && ValueMex(*nextBindParam).IsStruct() )
+        if( !haveParamColumns && countBindParam == 1 && ValueMex(*nextBindParam).IsStruct() )
         {
             haveParamStruct = true;
 
@@ -2400,7 +5777,12 @@ public:
          * statement may be passed. 
          */
         
-        if( g_param_wrapping )
+        if( haveParamColumns )
+        {
+            // count is the row count of the columns
+            countBindParam = argsNeeded * count;
+        }
+        else if( g_param_wrapping )
         {
             // exceeding argument list allowed to omit multiple queries
             
@@ -2456,6 +5838,16 @@ public:
             }
         }
 
+        // Resolve field names for parameters once, not for each struct element
+        if( haveParamStruct )
+        {
+            for( int iParam = 0; iParam < argsNeeded; iParam++ )
+            {
+                const char* name = iface->getParameterName( iParam + 1 );
+                fieldNumbers.push_back( name ? ValueMex( *nextBindParam ).GetFieldNumber( ++name ) : -1 );  // adjusting name behind either '?', ':', '$' or '@'!
+            }
+        }
+
         last_insert_row = new long[count];
         
         if( !last_insert_row )
@@ -2464,12 +5856,51 @@ public:
             goto finalize;
         }
 
+        // repeated executions are wrapped in transactions of g_autotransaction rows, a
+        // savepoint is used if a transaction is already open
+        if( g_autotransaction > 0 && count > 1 )
+        {
+            haveSavepoint = !iface->isAutoCommit();
+            
+            if( !iface->execute( haveSavepoint ? "SAVEPOINT mksqlite_autotransaction;" : "BEGIN;" ) )
+            {
+                const char* errid = NULL;
+                m_err.set( iface->getErr(&errid), errid );
+                goto finalize;
+            }
+            haveAutoTransaction = true;
+        }
+
+        // compress typed BLOBs of upcoming rows by worker threads, 
+        // while the statement is stepped
+        if( count > 1 && g_threads > 1 && typed_blobs_mode_on() && g_compression_level )
+        {
+            firstBindParam = nextBindParam;
+            
+            pipeline = new BlobPackPipeline( count, argsNeeded, g_threads, 
+                [&]( size_t row, int iParam ) -> const mxArray*
+                {
+                    if( haveParamColumns )
+                    {
+                        const mxArray* column = bindColumns[iParam];
+                        return mxIsCell( column ) ? mxGetCell( column, bindOffsets[iParam] + row ) : NULL;
+                    }
+                    
+                    if( haveParamStruct )
+                    {
+                        return ValueMex( *firstBindParam ).GetFieldByNumber( (int)row, fieldNumbers[iParam] );
+                    }
+                    
+                    return firstBindParam[row * argsNeeded + iParam];
+                } );
+        }
+
         // loop over parameters
         for( int i = 0; i < count; i++ ) // kv69: fixed length loop because we know how often the stmt should be repeated
         {
             // reset SQL statement and clear bindings
-            m_interface->reset();
-            m_interface->clearBindings();
+            iface->reset();
+            iface->clearBindings();
 
             /*** Bind parameters ***/
         
@@ -2478,26 +5909,45 @@ public:
             {
                 const mxArray* bindParam = NULL;
 
+                if( haveParamColumns )
+                {
+                    const mxArray* column  = bindColumns[iParam];
+                    size_t         element = bindOffsets[iParam] + i;
+                    
+                    // numeric elements are bound without creating a MATLAB array
+                    if( mxIsCell( column ) ?
+                        !iface->bindParameter( iParam + 1, ValueMex( mxGetCell( column, element ) ), can_serialize(), /*bStatic*/ true, 
+                                               pipeline ? pipeline->job( i, iParam ) : NULL ) :
+                        !iface->bindElement( iParam + 1, mxGetData( column ), mxGetClassID( column ), element ) )
+                    {
+                        const char* errid = NULL;
+                        m_err.set( iface->getErr(&errid), errid );
+                        goto finalize;
+                    }
+                    continue;
+                }
+
                 if( !haveParamStruct )
                 {
                    bindParam = *nextBindParam++;
                 }
                 else
                 {
-                    const char* name = m_interface->getParameterName( iParam + 1 );
-                    bindParam = name ? ValueMex( *nextBindParam ).GetField( i, ++name ) : NULL;  // adjusting name behind either '?', ':', '$' or '@'!
+                    bindParam = ValueMex( *nextBindParam ).GetFieldByNumber( i, fieldNumbers[iParam] );
 
                     if( !bindParam )
                     {
-                        m_err.set_printf( MSG_MISSINGARG_STRUCT, NULL, name ? name : "(unnamed)");
+                        const char* name = iface->getParameterName( iParam + 1 );
+                        m_err.set_printf( MSG_MISSINGARG_STRUCT, NULL, name ? name + 1 : "(unnamed)");
                         goto finalize;
                     }
                 }
 
-                if( !m_interface->bindParameter( iParam + 1, ValueMex( bindParam ), can_serialize() ) )
+                if( !iface->bindParameter( iParam + 1, ValueMex( bindParam ), can_serialize(), /*bStatic*/ true, 
+                                           pipeline ? pipeline->job( i, iParam ) : NULL ) )
                 {
                     const char* errid = NULL;
-                    m_err.set( m_interface->getErr(&errid), errid );
+                    m_err.set( iface->getErr(&errid), errid );
                     goto finalize;
                 }
             }
@@ -2505,26 +5955,84 @@ public:
             /*** fetch results and store results for output ***/
 
             // cumulate in "cols"
-            if( !errPending() && !m_interface->fetch( cols, initialize ) )
+            if( !errPending() && !iface->fetch( cols, initialize ) )
             {
                 const char* errid = NULL;
-                m_err.set( m_interface->getErr(&errid), errid );
+                m_err.set( iface->getErr(&errid), errid );
                 goto finalize;
             }
             initialize = false; // kv69: for next statement use do not initialize query results again but accumulated it
 
             // kv69: collect last_insert_row_id
-            last_insert_row[i] = m_interface->getLastRowID();
+            last_insert_row[i] = iface->getLastRowID();
+
+            // commit rows and begin next automatic transaction
+            if( haveAutoTransaction && ++autoTransactionRows == g_autotransaction && i + 1 < count )
+            {
+                if( !commitAutoTransaction( iface, haveSavepoint, autoTransactionRows, /*restart*/ true ) )
+                {
+                    // rolled back, nothing left to commit
+                    haveAutoTransaction = false;
+                    goto finalize;
+                }
+                autoTransactionRows = 0;
+            }
         }
 
 finalize:
+        // wait for pending compressions
+        delete pipeline;
+
+        // commit remaining rows of the automatic transaction
+        if( haveAutoTransaction )
+        {
+            // commitAutoTransaction() sets m_err and rolls back on failure
+            (void)commitAutoTransaction( iface, haveSavepoint, autoTransactionRows, /*restart*/ false );
+        }
+
         /*
-         * finalize current sql statement
+         * finalize current sql statement, or keep it prepared for the next call
          */
-        m_interface->finalize();
+        if( persistent )
+        {
+            iface->reset();
+            iface->clearBindings();
+        }
+        else
+        {
+            iface->finalize();
+        }
 
         /*** Prepare results to return ***/
+
+        setResults( cols, last_insert_row, count );
+
+        // kv69: clear array for last insert row 
+        delete[] last_insert_row;
+
+        return !errPending();
         
+    } /* end execStatement() */
+
+
+    /**
+     * \brief Set query results as return values
+     *
+     * \param[in] cols Column vectors holding the results
+     * \param[in] last_insert_row Row ids after each statement execution
+     * \param[in] count Number of elements in \p last_insert_row
+     *
+     * m_plhs[0] will be set to the results (depending on g_result_type), 
+     * m_plhs[1] to the row count, m_plhs[2] to the column names, 
+     * m_plhs[3] to the last inserted row ids and m_plhs[4] to the NULL
+     * mask (matrix results with g_null_mask set only, empty otherwise).
+     */
+    void setResults( ValueSQLCols& cols, const long* last_insert_row, int count )
+    {
+        // column buffers may be adopted by the result, so count rows in advance
+        int      row_count = cols.size() > 0 ? (int)cols[0].size() : 0;
+        mxArray* nullMask  = NULL;
+
         if( !errPending() )
         {
             // check if result is empty (no columns)
@@ -2549,7 +6057,13 @@ finalize:
             }
             else
             {
-                mxArray* result = NULL;
+                mxArray*  result = NULL;
+                SQLstats* stats  = SQLstack.current().activeStats();
+                
+                // typed BLOBs may be decompressed in parallel beforehand
+                unpackBlobs( cols );
+
+                SQLstats::Timer timer( stats ? &stats->m_result_time : NULL, stats ? &stats->m_unpack_time : NULL );
                 
                 // dispatch regarding result type
                 switch( g_result_type )
@@ -2559,11 +6073,12 @@ finalize:
                         break;
                     
                     case RESULT_TYPE_STRUCTOFARRAYS:
+                    case RESULT_TYPE_TYPEDCOLUMNS:
                         result = createResultAsStructOfArrays( cols );
                         break;
                     
                     case RESULT_TYPE_MATRIX:
-                        result = createResultAsMatrix( cols );
+                        result = createResultAsMatrix( cols, ( g_null_mask && m_nlhs > 4 ) ? &nullMask : NULL );
                         break;
                     
                     default:
@@ -2587,7 +6102,6 @@ finalize:
             // If more than 1 return parameter, output the row count 
             if( m_nlhs > 1 )
             {
-                int row_count = cols.size() > 0 ? (int)cols[0].size() : 0;
                 m_plhs[1] = mxCreateDoubleScalar( (double)row_count );
                 assert( NULL != m_plhs[1] );
             }
@@ -2617,14 +6131,21 @@ finalize:
                 m_plhs[3] = result;
             } 
             
+            // If more than 4 return parameters, output the NULL mask (matrix results only)
+            if( m_nlhs > 4 && cols.size() )
+            {
+                m_plhs[4] = nullMask ? nullMask : mxCreateLogicalMatrix( 0, 0 );
+                nullMask  = NULL;
+                
+                if( !m_plhs[4] )
+                {
+                    m_err.set( MSG_CANTCREATEOUTPUT );
+                }
+            }
         }
-
-        // kv69: clear array for last insert row 
-        delete[] last_insert_row;
-
-        return !errPending();
         
-    } /* end cmdHandleSQLStatement() */
+        ::utils_destroy_array( nullMask );
+    }
 
 
     /**
@@ -2635,12 +6156,12 @@ finalize:
      */
     bool switchDBSlot( command_e command )
     {
-        if( command < DONE )  // OPEN, CLOSE, QUERY
+        if( command < DONE )  // OPEN, CLOSE, QUERY, DESERIALIZE, LOAD_INTO_MEMORY
         {
             // Check if user entered an id of 0
             if( !m_dbid_req )
             {
-                if( command == OPEN )
+                if( command == OPEN || command == DESERIALIZE || command == LOAD_INTO_MEMORY )
                 {
                     if( !m_dbid )
                     {
@@ -2692,6 +6213,14 @@ finalize:
                     (void)cmdHandleClose(); // "close" command
                     break;
                   
+                case Mksqlite::DESERIALIZE:
+                    (void)cmdHandleDeserialize(); // "deserialize" command
+                    break;
+                  
+                case Mksqlite::LOAD_INTO_MEMORY:
+                    (void)cmdHandleLoadIntoMemory(); // "load_into_memory" command
+                    break;
+                  
                 case Mksqlite::QUERY:
                     (void)cmdHandleSQLStatement();  // common sql query
                     break;
@@ -2739,7 +6268,7 @@ void mexFunction( int nlhs, mxArray* plhs[], int nrhs, const mxArray*prhs[] )
 
     if( !logfile_open )
     {
-        log_add_fp( g_logFile.get_fp(), LOG_TRACE );
+        log_add_callback( &LogFile::callback, &g_logFile, LOG_TRACE );
         logfile_open = true;
     }
     log_set_level( LOG_TRACE );  // All levels below will be ignored
@@ -80,6 +80,25 @@
 % ausgefhrt werden soll, so muss das so genannte Parameter Wrapping aktiviert
 % werden:
 % mksqlite('param_wrapping', 0|1)
+% Mit Parameter Wrapping knnen Zeilen auch spaltenweise bergeben werden,
+% entweder als numerische NxK Matrix (K Platzhalter, K>1) oder als skalare
+% Struktur mit Nx1 Spaltenvektoren (numerisch, logisch oder Cell), deren
+% Namen den Platzhaltern entsprechen:
+%  mksqlite( 'INSERT INTO t (a,b,c) VALUES (?,?,?)', M );  % M ist Nx3
+%  s.a = (1:N)'; s.b = rand(N,1);
+%  mksqlite( 'INSERT INTO t (a,b) VALUES (:a,:b)', s );
+% Numerische Werte werden dann direkt aus den Spaltenvektoren gelesen.
+% (siehe sqlite_test_bulk_insert.m)
+%
+% Wiederholte Ausfhrungen durch Parameter Wrapping knnen automatisch in
+% Transaktionen zusammengefasst werden, die alle n Zeilen abgeschlossen
+% werden. Ist bereits eine Transaktion offen, wird statt dessen ein
+% Savepoint verwendet:
+%
+%   mksqlite( 'autotransaction', n );   % n=0 schaltet ab (Standard)
+%
+% Abgeschlossene Transaktionen und Zeilen liefert der Befehl 'status'.
+%
 % Ein Argument darf ein realer numerischer Wert (Skalar oder Array)
 % oder ein String sein. Nichtskalare Werte werden als Vektor vom SQL Datentyp
 % BLOB (uint8) verarbeitet. ( BLOB = (B)inary (L)arge (OB)ject) )
@@ -160,6 +179,19 @@
 % Unterschiedliche Kompressionsraten werden auch hier nicht untersttzt,
 % sie sollten ebenfalls immer auf 1 gesetzt werden.
 %
+% Das Entpacken typisierter BLOBs kann von mehreren Threads bernommen
+% werden, wenn eine Abfrage viele komprimierte BLOBs liefert:
+%
+%   mksqlite( 'threads', n );   % n=1 schaltet ab (Vorgabe), n=0 nutzt alle Kerne
+%
+% Dieselben Threads komprimieren typisierte BLOB-Argumente im Voraus, wenn
+% eine Anweisung durch Parameter Wrapping wiederholt ausgefhrt wird:
+% Whrend der Haupt-Thread die Anweisung ausfhrt, werden die BLOBs der
+% folgenden Zeilen (bis zu 16 MB Rohdaten je Schritt) bereits komprimiert.
+%
+% Serialisierte Variablen (Structs, Cells, ...) werden immer vom MATLAB
+% Thread gepackt und entpackt.
+%
 % =======================================================================
 %
 % Steuerung der Rckgabewerte von Queries
@@ -172,14 +204,366 @@
 % [result,rowcount,colnames] = mksqlite(...)
 %
 % Per Voreinstellung wird ein Strukturarray (array of structs) zurckgegeben.
-% Wahlweise sind insgesamt drei Rckgabetypen mglich:
+% Wahlweise sind insgesamt vier Rckgabetypen mglich:
 % (0) array of structs (Vorgabe)
 % (1) struct of arrays
 % (2) cell matrix
+% (3) struct of typed arrays
 % Die Voreinstellung (n=0) kann mit folgendem Befehl gendert werden:
 % mksqlite( 'result_type', n );
 % (see sqlite_test_result_types.m)
 %
+% Der Rckgabetyp 3 entspricht "struct of arrays", jedoch werden INTEGER
+% Spalten als int64 Arrays zurckgegeben (ohne Genauigkeitsverlust) und
+% NULL Werte erzwingen kein Cell-Array. Ein NULL Wert wird als 0 (int64)
+% bzw. NaN (double) abgelegt, ein zustzliches logisches Feld <name>_isnull
+% kennzeichnet die NULL Werte einer Spalte.
+% (siehe sqlite_test_typed_columns.m)
+%
+% Deklarierte Spaltentypen (z.B. "v INT16" in CREATE TABLE) knnen bei
+% den Ergebnistypen 1 und 3 auf MATLAB-Klassen abgebildet werden:
+%
+%   mksqlite( 'decltype_classes', 1 );  % 0=aus (Standard)
+%
+% Untersttzt werden INT8, INT16, INT32, INT64 (TINYINT, SMALLINT, BIGINT),
+% UINT8 ... UINT64, REAL4 (FLOAT4, SINGLE) und BOOL (BOOLEAN).
+% Eine solche Spalte wird als int8 ... uint64, single oder logical Array
+% zurckgegeben. Passt ein Wert nicht in die deklarierte Klasse (berlauf,
+% Nachkommastellen, Text), wird die Spalte wie blich konvertiert.
+% (siehe sqlite_test_decltype_classes.m)
+%
+% Bei den Rckgabetypen 1 und 2 erzwingt ein einziger NULL Wert in einer
+% numerischen Spalte ein Cell-Array. Mit NULL-Masken bleiben solche
+% Spalten numerisch (NULL als NaN), die NULL Werte werden stattdessen in
+% einer logischen Maske gekennzeichnet:
+%
+%   mksqlite( 'null_mask', 1 );  % 0=aus (Standard)
+%
+% Rckgabetyp 1 liefert fr jede numerische Spalte mit NULL Werten ein
+% zustzliches logisches Feld <name>_isnull. Rckgabetyp 2 liefert die
+% Maske aller Zellen als 5. Rckgabewert:
+%   [result, count, colnames, rowids, isnull] = mksqlite(...)
+% (siehe sqlite_test_null_mask.m)
+%
+% TEXT Spalten mit vielen sich wiederholenden Werten knnen bei den
+% Rckgabetypen 1 und 3 als Wrterbuch kodiert zurckgegeben werden.
+% Jeder unterschiedliche Text wird dabei nur einmal abgelegt:
+%
+%   mksqlite( 'text_dictionary', n );
+%
+% (0) Cell-Array von Strings (Standard)
+% (1) uint32 Codes und ein zustzliches Feld <name>_dict mit den
+%     unterschiedlichen Texten (cellstr), <name>_dict(<name>) ergibt also
+%     die Texte. NULL Werte haben den Code 0.
+% (2) categorical Array (ab MATLAB R2013b)
+% Spalten mit anderen Werten als TEXT oder NULL werden wie blich
+% zurckgegeben. Bei Cursorn hat jeder abgerufene Block sein eigenes
+% Wrterbuch.
+% (siehe sqlite_test_text_dictionary.m)
+%
+% =======================================================================
+%
+% Statement Cache:
+% Vorbereitete SQL Anweisungen (prepared statements) koennen zur
+% Wiederverwendung vorgehalten werden, so dass wiederholte Abfragen mit
+% gleichem SQL Text nicht erneut uebersetzt werden muessen. Jede Datenbank
+% besitzt einen eigenen Cache mit bis zu n Eintraegen (die am laengsten
+% unbenutzten werden verworfen). Anweisungen, die das Datenbankschema
+% aendern (CREATE, DROP, ALTER, ...) leeren den Cache, ebenso das
+% Schliessen der Datenbank.
+%
+%   mksqlite( 'stmt_cache', n );   % n=0 schaltet den Cache ab (Vorgabe)
+%
+% Treffer und Fehlversuche meldet der Befehl 'status':
+%   [status, info] = mksqlite( 'status' );
+%
+% =======================================================================
+%
+% Statement Handles:
+% Eine SQL Anweisung kann einmal vorbereitet und beliebig oft ausgefuehrt
+% werden, womit das Uebersetzen des SQL Textes bei jedem Aufruf entfaellt:
+%
+%   h = mksqlite( 'prepare', 'INSERT INTO t (a,b) VALUES (?,?)' );
+%   mksqlite( 'exec', h, 1, 'erster' );   % Argumente binden und ausfuehren
+%   mksqlite( 'exec', h, 2, 'zweiter' );
+%   mksqlite( 'reset', h );               % Anweisung zuruecksetzen, Bindungen loeschen
+%   mksqlite( 'finalize', h );            % Anweisung und Handle freigeben
+%
+% 'exec' nimmt Argumente entgegen und liefert Ergebnisse wie gewoehnliche
+% SQL Abfragen. Eine dbid kann dem Befehl vorangestellt werden, Handles
+% gehoeren zu ihrer Datenbank und werden mit deren Schliessen freigegeben.
+% (siehe sqlite_test_prepare.m)
+%
+% =======================================================================
+%
+% Cursor:
+% Grosse Ergebnismengen koennen abschnittsweise abgerufen werden, so dass
+% jeweils nur ein Abschnitt im Speicher gehalten werden muss:
+%
+%   c = mksqlite( 'cursor_open', 'SELECT * FROM t WHERE a>?', 0 );
+%   while true
+%     [result, count] = mksqlite( 'cursor_fetch', c, 10000 );  % naechste 10000 Zeilen
+%     if ~count, break, end
+%     ...
+%   end
+%   mksqlite( 'cursor_close', c );
+%
+% Die Ergebnisse werden im eingestellten Ergebnistyp geliefert, Parameter
+% werden wie bei gewoehnlichen SQL Abfragen gebunden (ohne "parameter
+% wrapping").
+% (siehe sqlite_test_cursor.m)
+%
+% =======================================================================
+%
+% Inkrementelle BLOB Ein-/Ausgabe:
+% Teile eines BLOBs koennen gelesen oder geschrieben werden, ohne den
+% ganzen Wert abzufragen. Ein BLOB wird ueber Tabellenname, Spaltenname
+% und rowid geoeffnet, nur lesend (mode 0, Vorgabe) oder beschreibbar
+% (mode 1):
+%
+%   [h, bytes] = mksqlite( 'blob_open', 'wave', 'data', rowid, mode );
+%   teil = mksqlite( 'blob_read', h, offset, n );             % n Bytes als uint8
+%   teil = mksqlite( 'blob_read', h, offset, n, 'double' );   % n Bytes als double
+%   mksqlite( 'blob_write', h, offset, data );  % Rohdaten eines numerischen Arrays
+%   mksqlite( 'blob_close', h );
+%
+% Offsets und Groessen werden in Bytes angegeben, die Bytes werden direkt
+% in den zurueckgegebenen Spaltenvektor gelesen. Schreiben kann die Groesse
+% eines BLOBs nicht aendern. BLOB-Handles werden mit dem Schliessen ihrer
+% Datenbank freigegeben.
+% (siehe sqlite_test_blob_io.m)
+%
+% =======================================================================
+%
+% Abfragen im Hintergrund (Tickets):
+% Eine Abfrage kann im Hintergrund ausgefhrt werden, whrend MATLAB
+% weiterarbeitet. 'submit' gibt sofort eine Ticketnummer zurck, 'poll'
+% zeigt an, ob die Abfrage beendet ist und 'wait' liefert ihre Ergebnisse:
+%
+%   t = mksqlite( 'submit', 'SELECT * FROM t WHERE a>?', 0 );
+%   ...
+%   if mksqlite( 'poll', t ) % 1, wenn das Ergebnis bereit ist, sonst 0
+%     ...
+%   end
+%   [result, count, colnames] = mksqlite( 'wait', t );          % wartet bis zum Ende
+%   [result, count, colnames] = mksqlite( 'wait', t, timeout ); % oder bis Timeout (Sekunden)
+%
+% Luft der Timeout ab, gibt 'wait' ein leeres Array zurck und das Ticket
+% bleibt gltig. Andernfalls wird das Ticket von 'wait' freigegeben.
+% Jedes Ticket verwendet eine eigene Verbindung zur Datenbankdatei, daher
+% werden nur Datenbankdateien untersttzt, und MATLAB Funktionen oder die
+% Builtin SQL Funktionen stehen diesen Abfragen nicht zur Verfgung. Das
+% Schlieen der Datenbank bricht ihre offenen Tickets ab.
+% (siehe sqlite_test_tickets.m)
+%
+% =======================================================================
+%
+% Leser-Pool und parallele Abfragen:
+% Jede Datenbank kann einen Pool von bis zu n Verbindungen zu ihrer Datei
+% halten, die nur lesen (0, die Vorgabe, schaltet den Pool ab). Die
+% Gre wird fr alle Datenbanken festgelegt, die bisherige Gre wird
+% zurckgegeben:
+%
+%   old_size = mksqlite( 'reader_pool', n );
+%
+% Tickets verwenden eine Verbindung aus dem Pool, solange eine verfgbar
+% ist, ihre Abfragen knnen dann nur lesen. Verbindungen werden bei
+% Bedarf geffnet und bleiben bis zum Schlieen der Datenbank offen.
+% Eine parallele Abfrage teilt einen Bereich von rowids in Teile, einen
+% je Verbindung des Pools. Die ersten beiden Parameter der SQL Anweisung
+% erhalten die Grenzen jedes Teils, die brigen Argumente werden wie
+% gewohnt gebunden:
+%
+%   [result, count, colnames] = mksqlite( 'parallel_query', ...
+%       'SELECT * FROM t WHERE rowid BETWEEN ? AND ? AND a>?', first, last, 0 );
+%
+% Die Teile werden von Worker-Threads abgefragt und die Zeilen in der
+% Reihenfolge der Teile aneinandergehngt, daher darf die Anweisung nicht
+% ber den ganzen Bereich aggregieren oder sortieren. Leser sehen nur
+% besttigte Daten, fr gleichzeitige Leser und einen Schreiber sollte die
+% Datenbank im WAL Modus sein (PRAGMA journal_mode=WAL).
+% (siehe sqlite_test_reader_pool.m)
+%
+% =======================================================================
+%
+% Leistungszhler:
+% mksqlite kann aufzeichnen, wofr die Zeit von SQL Anweisungen verwendet
+% wird. Die Aufzeichnung wird fr alle Datenbanken ein- oder ausgeschaltet
+% (Vorgabe ist aus):
+%
+%   old_flag = mksqlite( 'stats', 1 );
+%   stats    = mksqlite( [dbid,] 'stats' );           % Zhler einer Datenbank
+%   stats    = mksqlite( [dbid,] 'stats', 'reset' );  % abfragen und lschen
+%
+% Die Struktur enthlt Anzahlen (calls, rows, text_bytes, blob_bytes,
+% blobs_packed, blobs_unpacked) und Zeiten in Sekunden:
+%   prepare_time: Vorbereiten der Anweisungen
+%   step_time:    Ausfhren der Anweisungen (SQLite)
+%   column_time:  Auslesen der Spaltenwerte
+%   convert_time: Umwandeln von Texten (UTF-8)
+%   pack_time:    Packen typisierter BLOB Argumente
+%   unpack_time:  Entpacken typisierter BLOBs der Ergebnisse
+%   result_time:  Erzeugen der MATLAB Ergebnisse
+%   total_time:   SQL Anweisungen insgesamt
+% Die Zeiten berschneiden sich nicht, auer total_time. Die Zhler werden
+% beim ffnen der Datenbank gelscht.
+% (siehe sqlite_test_stats.m)
+%
+% =======================================================================
+%
+% Abfrageprofil:
+% Die SQLite Zhler der zuletzt abgefragten Anweisung einer Datenbank
+% werden als Struktur zurckgegeben, um vollstndige Tabellendurchlufe
+% oder fehlende Indizes zu finden:
+%
+%   profile = mksqlite( [dbid,] 'last_query_profile' );
+%
+%   query:          SQL Text
+%   fullscan_steps: Schritte vollstndiger Tabellendurchlufe
+%   sorts:          Sortiervorgnge
+%   autoindexes:    in automatische Indizes eingefgte Zeilen
+%   vm_steps:       Operationen der virtuellen Maschine
+%   reprepares:     erneute Vorbereitungen wegen Schemanderungen
+%   runs:           vollstndige Ausfhrungen
+%   filter_misses, filter_hits: Ergebnisse des Bloom-Filters
+%   memused:        von der Anweisung belegter Speicher (Bytes)
+%   loops:          Struktur-Array (name, explain, loops, visits, estimate)
+%                   mit jeder Schleife des Abfrageplans. Es wird nur
+%                   gefllt, wenn mksqlite mit SQLITE_ENABLE_STMT_SCANSTATUS
+%                   erstellt wurde.
+%
+% Mit Parameter Wrapping werden die Zhler aller Ausfhrungen summiert.
+% (siehe sqlite_test_query_profile.m)
+%
+% =======================================================================
+%
+% Protokoll langsamer Abfragen:
+% SQL Anweisungen, die lnger als ein Schwellwert (Sekunden) laufen,
+% werden in die Protokolldatei mksqlite.log im aktuellen Verzeichnis
+% geschrieben, 0 schaltet das Protokoll ab (Voreinstellung). Der alte
+% Schwellwert wird zurckgegeben:
+%
+%   old = mksqlite( 'slow_query_log', seconds );
+%
+% Jeder Eintrag enthlt den SQL Text, Form und Klasse der Argumente, die
+% Anzahl der Zeilen, die Aufteilung der Zeiten (wie 'stats') und den
+% Abfrageplan, der mit einer Nebenanweisung "EXPLAIN QUERY PLAN ..."
+% ermittelt wird. Die Protokolldatei wird bei 4 MB rotiert, bis zu 3
+% ltere Dateien bleiben erhalten (mksqlite.log.1 ...).
+% Das Protokoll ist nur verfgbar, wenn mksqlite mit
+% MKSQLITE_CONFIG_USE_LOGGING erstellt wurde.
+% (siehe sqlite_test_slow_query_log.m)
+%
+% =======================================================================
+%
+% Speicherstatistik:
+% Der von SQLite und mksqlite belegte Speicher wird als Struktur
+% zurckgegeben:
+%
+%   mem = mksqlite( [dbid,] 'memstats' [, 'reset'] );
+%
+%   memory_used, memory_highwater: von SQLite insgesamt belegter
+%                       Speicher (Bytes)
+%   cache_used, schema_used, stmt_used: Speicher des Seitencaches, des
+%                       Schemas und der vorbereiteten Anweisungen der
+%                       Datenbankverbindung
+%   lookaside_used, lookaside_highwater: Lookaside Slots der Verbindung
+%   blob_allocs, blob_alloc_bytes: Anforderungen zum Packen typisierter
+%                       BLOBs
+%   result_bytes:       geschtzte Gre der Ergebnispuffer der zuletzt
+%                       abgefragten Anweisung
+%   result_highwater:   bisher grter Wert von result_bytes
+%   result_memory_cap:  aktuelle Grenze (siehe unten)
+%
+% Mit 'reset' werden die Hchstwerte und die Zhler der BLOB Anforderungen
+% nach der Rckgabe gelscht.
+%
+% Eine weiche Grenze bricht Abfragen, deren Ergebnispuffer die angegebene
+% Gre (Bytes) berschreiten, mit einem Fehler ab, bevor MATLAB der
+% Speicher ausgeht. 0 schaltet die Grenze ab (Voreinstellung), die alte
+% Grenze wird zurckgegeben:
+%
+%   old = mksqlite( 'result_memory_cap', bytes );
+%
+% (siehe sqlite_test_memstats.m)
+%
+% =======================================================================
+%
+% Profile und Einstellungen beim ffnen:
+% Dem Zugriffsmodus und dem Threadingmodus knnen ein Profilname und
+% Paare aus Einstellungsnamen und Werten folgen, die beim ffnen per
+% PRAGMA gesetzt werden:
+%
+%   mksqlite( 'open', filename [, iomode] [, threadmode] ...
+%             [, profile] [, name, value, ...] );
+%
+%   'default':   keine Einstellungen
+%   'bulkload':  journal_mode MEMORY, locking_mode EXCLUSIVE,
+%                synchronous OFF, cache_size -262144 (256 MB),
+%                temp_store MEMORY
+%   'analytics': journal_mode WAL, synchronous NORMAL,
+%                cache_size -131072 (128 MB), mmap_size 1 GB,
+%                temp_store MEMORY
+%   'safe':      journal_mode DELETE, locking_mode NORMAL,
+%                synchronous FULL, mmap_size 0
+%
+% Dem Profil folgende Einstellungen berschreiben es: page_size,
+% journal_mode, locking_mode, synchronous, cache_size, mmap_size und
+% temp_store, z.B.
+%
+%   mksqlite( 'open', 'data.db', 'analytics', 'cache_size', -65536 );
+%
+% Schlgt eine Einstellung fehl, wird die Datenbank wieder geschlossen.
+% Bei schreibgeschtzten Datenbanken entfallen page_size und
+% journal_mode. Verbindungen des Leser-Pools bernehmen cache_size,
+% mmap_size und temp_store. Die von SQLite gemeldeten Werte zeigt
+% 'status' an (Felder open_profile und open_settings).
+% (siehe sqlite_test_open_profiles.m)
+%
+% =======================================================================
+%
+% Serialisieren und Deserialisieren:
+% Ein Datenbankschema (voreingestellt "main") wird als Abbild in einem
+% uint8 Spaltenvektor zurckgegeben:
+%
+%   bytes = mksqlite( [dbid,] 'serialize' [, schema] );
+%
+% In-Memory Datenbanken werden direkt aus ihrem Speicher kopiert. Das
+% Abbild wird ohne Plattenzugriff wieder als In-Memory Datenbank geffnet:
+%
+%   dbid = mksqlite( [dbid,] 'deserialize', bytes [, mode] );
+%
+% mode ist 'resizeable' (Voreinstellung, die Datenbank darf gendert
+% werden und wachsen) oder 'readonly'. Wie bei 'open' whlt eine dbid
+% von 0 einen freien Platz, eine geffnete Datenbank wird zuvor
+% geschlossen.
+% (siehe sqlite_test_serialize.m)
+%
+% =======================================================================
+%
+% In den Speicher laden und sichern:
+% Eine Datenbankdatei wird in eine In-Memory Datenbank kopiert, z.B. fr
+% viele Leseabfragen, und mit der Online-Backup-API von SQLite
+% zurckgeschrieben:
+%
+%   dbid = mksqlite( [dbid,] 'load_into_memory', filename [, pagesPerStep] );
+%   mksqlite( [dbid,] 'backup', filename [, pagesPerStep] );
+%
+% Wie bei 'open' whlt eine dbid von 0 fr 'load_into_memory' einen
+% freien Platz. Beide Befehle kehren sofort zurck, die Seiten werden von
+% einem Worker-Thread kopiert, jeweils pagesPerStep Seiten (Standard 256,
+% negativ kopiert alle auf einmal). Die Kopie wird verfolgt mit:
+%
+%   status = mksqlite( [dbid,] 'backup_status' );  % done, pagecount, remaining
+%   done   = mksqlite( [dbid,] 'backup_wait' [, timeout] );
+%   mksqlite( [dbid,] 'backup_cancel' );
+%
+% 'backup_wait' gibt 0 zurck, wenn zuerst das Timeout (Sekunden)
+% abluft, und meldet Fehler der Kopie. Jeder andere Befehl auf der
+% Datenbank wartet, bis die Kopie beendet ist. Ein abgebrochenes
+% 'load_into_memory' hinterlsst eine leere In-Memory Datenbank.
+% (siehe sqlite_test_backup.m)
+%
 % =======================================================================
 %
 % Builtin SQL Funktionen:
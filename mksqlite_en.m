@@ -75,6 +75,23 @@
 % If it is intended, that implicit calls with the same command and the remaining
 % arguments shall be done, so called parameter wrapping must be activated:
 % mksqlite('param_wrapping', 0|1)
+% With parameter wrapping, rows can also be passed column by column, either
+% as numeric NxK matrix (K placeholders, K>1) or as scalar struct of Nx1
+% column vectors (numeric, logical or cell), named like the placeholders:
+%  mksqlite( 'INSERT INTO t (a,b,c) VALUES (?,?,?)', M );  % M is Nx3
+%  s.a = (1:N)'; s.b = rand(N,1);
+%  mksqlite( 'INSERT INTO t (a,b) VALUES (:a,:b)', s );
+% Numeric values are then read straight from the column vectors.
+% (see sqlite_test_bulk_insert.m)
+%
+% Repeated executions by parameter wrapping can be wrapped in transactions
+% automatically, committed every n rows. If a transaction is already open,
+% a savepoint is used instead:
+%
+%   mksqlite( 'autotransaction', n );   % n=0 disables (default)
+%
+% Committed batches and rows are reported by the 'status' command.
+%
 % An argument may be a real value (scalar or array) or a string.
 % Non-scalar values are treated as a BLOB (unit8) SQL datatype.
 % ( BLOB = (B)inary (L)arge (OB)ject) )
@@ -152,6 +169,19 @@
 % NULL, Nan, and infinity are still accepted.  Similarly, differing
 % compression rates are not supported, so should always be set to 1.
 %
+% Decompression of typed BLOBs can be done by several threads, when a
+% query returns many compressed BLOBs:
+%
+%   mksqlite( 'threads', n );   % n=1 disables (default), n=0 uses all cores
+%
+% The same threads compress typed BLOB arguments ahead of time, when a
+% statement is executed repeatedly by parameter wrapping: while the main
+% thread steps the statement, the BLOBs of the upcoming rows (up to 16 MB
+% raw data per step) are already compressed.
+%
+% Serialized variables (structs, cells, ...) are always (un)packed by the
+% MATLAB thread.
+%
 % =======================================================================
 %
 % Control the format of result for queries
@@ -164,14 +194,342 @@
 % [result,rowcount,colnames] = mksqlite(...)
 %
 % Per default an array of structs will be returned for table queries.
-% You can decide between three differet kinds of result types:
+% You can decide between four differet kinds of result types:
 % (0) array of structs (default)
 % (1) struct of arrays
 % (2) cell matrix
+% (3) struct of typed arrays
 % You can change the default setting (n=0) with following call:
 % mksqlite( 'result_type', n );
 % (see sqlite_test_result_types.m)
 %
+% Result type 3 is like a struct of arrays, but INTEGER columns are
+% returned as int64 arrays (no loss of precision) and NULLs don't force
+% a cell array. A NULL is stored as 0 (int64) or NaN (double), and an
+% additional logical field <name>_isnull marks the NULLs of a column.
+% (see sqlite_test_typed_columns.m)
+%
+% Declared column types (e.g. "v INT16" in CREATE TABLE) can be mapped to
+% MATLAB classes for result types 1 and 3:
+%
+%   mksqlite( 'decltype_classes', 1 );  % 0=off (default)
+%
+% Supported declarations are INT8, INT16, INT32, INT64 (TINYINT, SMALLINT,
+% BIGINT), UINT8 ... UINT64, REAL4 (FLOAT4, SINGLE) and BOOL (BOOLEAN).
+% Such a column is returned as int8 ... uint64, single or logical array.
+% If a value doesn't fit into the declared class (overflow, fraction,
+% text), the column falls back to the common conversion.
+% (see sqlite_test_decltype_classes.m)
+%
+% For result types 1 and 2 a single NULL in a numeric column forces a
+% cell array. With NULL masks, such columns stay numeric (NULL as NaN),
+% and the NULLs are marked by a logical mask instead:
+%
+%   mksqlite( 'null_mask', 1 );  % 0=off (default)
+%
+% Result type 1 returns an additional logical field <name>_isnull for
+% each numeric column, even if it contains no NULLs. Result type 2 returns the mask of
+% all cells as 5th output:
+%   [result, count, colnames, rowids, isnull] = mksqlite(...)
+% (see sqlite_test_null_mask.m)
+%
+% TEXT columns with many repeated values can be returned dictionary
+% encoded for result types 1 and 3. Each distinct text is stored only
+% once:
+%
+%   mksqlite( 'text_dictionary', n );
+%
+% (0) cell array of strings (default)
+% (1) uint32 codes and an additional field <name>_dict holding the
+%     distinct texts (cellstr), so <name>_dict(<name>) are the texts.
+%     NULLs have code 0.
+% (2) categorical array (MATLAB R2013b or later)
+% Columns with other values than TEXT or NULL are returned as usual.
+% For cursors each fetched chunk has its own dictionary.
+% (see sqlite_test_text_dictionary.m)
+%
+% =======================================================================
+%
+% Statement cache:
+% Prepared statements can be kept for reuse, so repeated queries with
+% the same SQL text don't need to be parsed again. Each database has its
+% own cache, holding up to n statements (least recently used ones are
+% dropped). Statements changing the database schema (CREATE, DROP, ALTER,
+% ...) clear the cache, closing the database also.
+%
+%   mksqlite( 'stmt_cache', n );   % n=0 disables the cache (default)
+%
+% Cache hits and misses are reported by the 'status' command:
+%   [status, info] = mksqlite( 'status' );
+%
+% =======================================================================
+%
+% Statement handles:
+% A statement can be prepared once and executed many times, which saves
+% the parsing of the SQL text on each call:
+%
+%   h = mksqlite( 'prepare', 'INSERT INTO t (a,b) VALUES (?,?)' );
+%   mksqlite( 'exec', h, 1, 'first' );    % bind arguments and execute
+%   mksqlite( 'exec', h, 2, 'second' );
+%   mksqlite( 'reset', h );               % reset statement, clear bindings
+%   mksqlite( 'finalize', h );            % release statement and handle
+%
+% 'exec' takes arguments and returns results like common SQL queries.
+% A dbid may be given in front of the command, handles belong to their
+% database and are released when it is closed.
+% (see sqlite_test_prepare.m)
+%
+% =======================================================================
+%
+% Cursors:
+% Large result sets can be fetched in chunks of rows, so only one chunk
+% must be held in memory at a time:
+%
+%   c = mksqlite( 'cursor_open', 'SELECT * FROM t WHERE a>?', 0 );
+%   while true
+%     [result, count] = mksqlite( 'cursor_fetch', c, 10000 );  % next 10000 rows
+%     if ~count, break, end
+%     ...
+%   end
+%   mksqlite( 'cursor_close', c );
+%
+% Results are returned in the current result type, parameters are bound
+% like for common SQL queries (without parameter wrapping).
+% (see sqlite_test_cursor.m)
+%
+% =======================================================================
+%
+% Incremental BLOB I/O:
+% Parts of a BLOB can be read or written without fetching the whole value.
+% A BLOB is opened by table name, column name and rowid, read only
+% (mode 0, default) or writable (mode 1):
+%
+%   [h, bytes] = mksqlite( 'blob_open', 'wave', 'data', rowid, mode );
+%   part = mksqlite( 'blob_read', h, offset, n );             % n bytes as uint8
+%   part = mksqlite( 'blob_read', h, offset, n, 'double' );   % n bytes as double
+%   mksqlite( 'blob_write', h, offset, data );  % raw bytes of a numeric array
+%   mksqlite( 'blob_close', h );
+%
+% Offsets and sizes are given in bytes, the bytes are read directly into
+% the returned column vector. Writing can't change the size of a BLOB.
+% BLOB handles are released when their database is closed.
+% (see sqlite_test_blob_io.m)
+%
+% =======================================================================
+%
+% Background queries (tickets):
+% A query can be submitted to run in the background, while MATLAB
+% continues. 'submit' returns a ticket number immediately, 'poll' tells
+% if the query has finished, and 'wait' returns its results:
+%
+%   t = mksqlite( 'submit', 'SELECT * FROM t WHERE a>?', 0 );
+%   ...
+%   if mksqlite( 'poll', t ) % 1 if the result is ready, 0 otherwise
+%     ...
+%   end
+%   [result, count, colnames] = mksqlite( 'wait', t );          % blocks until done
+%   [result, count, colnames] = mksqlite( 'wait', t, timeout ); % or until timeout (seconds)
+%
+% If the timeout elapses, 'wait' returns an empty array and the ticket
+% remains valid. Otherwise the ticket is released by 'wait'.
+% Each ticket runs on its own connection to the database file, so only
+% file databases are supported, and MATLAB functions or the builtin SQL
+% functions aren't available for these queries. Closing the database
+% cancels its pending tickets.
+% (see sqlite_test_tickets.m)
+%
+% =======================================================================
+%
+% Reader pool and parallel queries:
+% Each database may hold a pool of up to n read-only connections to its
+% file (0, the default, disables the pool). The pool size is set for all
+% databases and the previous size is returned:
+%
+%   old_size = mksqlite( 'reader_pool', n );
+%
+% Tickets take their connection from the pool, as long as one is
+% available, so their queries are read only then. Connections are opened
+% on demand and stay open until the database is closed.
+% A parallel query splits a range of rowids into parts, one per pool
+% connection. The first two parameters of the SQL statement take the
+% bounds of each part, the remaining arguments are bound as usual:
+%
+%   [result, count, colnames] = mksqlite( 'parallel_query', ...
+%       'SELECT * FROM t WHERE rowid BETWEEN ? AND ? AND a>?', first, last, 0 );
+%
+% The parts are queried by worker threads and the rows are concatenated
+% in order of the parts, so the statement must not aggregate or sort over
+% the whole range. Readers see only committed data, concurrent readers
+% and a writer should use a database in WAL mode
+% (PRAGMA journal_mode=WAL).
+% (see sqlite_test_reader_pool.m)
+%
+% =======================================================================
+%
+% Performance counters:
+% mksqlite can record where the time of SQL statements goes. Collecting
+% is switched on or off for all databases (off by default):
+%
+%   old_flag = mksqlite( 'stats', 1 );
+%   stats    = mksqlite( [dbid,] 'stats' );           % counters of a database
+%   stats    = mksqlite( [dbid,] 'stats', 'reset' );  % get and clear them
+%
+% The struct holds counts (calls, rows, text_bytes, blob_bytes,
+% blobs_packed, blobs_unpacked) and times in seconds:
+%   prepare_time: preparing statements
+%   step_time:    stepping statements (SQLite)
+%   column_time:  extracting column values
+%   convert_time: converting texts (UTF-8)
+%   pack_time:    packing typed BLOB arguments
+%   unpack_time:  unpacking typed BLOBs of results
+%   result_time:  creating the MATLAB results
+%   total_time:   SQL statement calls overall
+% The times don't overlap, except total_time. Counters are cleared when
+% the database is opened.
+% (see sqlite_test_stats.m)
+%
+% =======================================================================
+%
+% Query profile:
+% The SQLite counters of the statement fetched last on a database are
+% returned as struct, to find full table scans or missing indices:
+%
+%   profile = mksqlite( [dbid,] 'last_query_profile' );
+%
+%   query:          SQL text
+%   fullscan_steps: steps of full table scans
+%   sorts:          sort operations
+%   autoindexes:    rows inserted into automatic indices
+%   vm_steps:       virtual machine operations
+%   reprepares:     reprepares due to schema changes
+%   runs:           completed runs
+%   filter_misses, filter_hits: bloom filter results
+%   memused:        memory used by the statement (bytes)
+%   loops:          struct array (name, explain, loops, visits, estimate)
+%                   for each loop of the query plan. It's only filled,
+%                   if mksqlite was built with SQLITE_ENABLE_STMT_SCANSTATUS.
+%
+% With parameter wrapping the counters of all executions are summed up.
+% (see sqlite_test_query_profile.m)
+%
+% =======================================================================
+%
+% Slow query log:
+% SQL statements running longer than a threshold (seconds) are written to
+% the log file mksqlite.log in the current directory, 0 turns the log off
+% (default). The old threshold is returned:
+%
+%   old = mksqlite( 'slow_query_log', seconds );
+%
+% Each entry holds the SQL text, the shapes and classes of the arguments,
+% the count of rows, the timing breakdown (as 'stats') and the query plan,
+% captured by a side statement "EXPLAIN QUERY PLAN ...". The log file is
+% rotated at 4 MB, up to 3 older files are kept (mksqlite.log.1 ...).
+% The log is only available, if mksqlite was built with
+% MKSQLITE_CONFIG_USE_LOGGING.
+% (see sqlite_test_slow_query_log.m)
+%
+% =======================================================================
+%
+% Memory statistics:
+% The memory used by SQLite and mksqlite is returned as struct:
+%
+%   mem = mksqlite( [dbid,] 'memstats' [, 'reset'] );
+%
+%   memory_used, memory_highwater: memory used by SQLite overall (bytes)
+%   cache_used, schema_used, stmt_used: memory used by the page cache,
+%                       the schema and the prepared statements of the
+%                       database connection
+%   lookaside_used, lookaside_highwater: lookaside slots of the connection
+%   blob_allocs, blob_alloc_bytes: allocations for packing typed BLOBs
+%   result_bytes:       estimated size of the result buffers of the query
+%                       fetched last
+%   result_highwater:   largest result_bytes so far
+%   result_memory_cap:  current cap (see below)
+%
+% With 'reset' the high-water marks and the BLOB allocation counters are
+% cleared after returning them.
+%
+% A soft cap aborts queries, whose result buffers grow beyond the given
+% size (bytes) with an error, before MATLAB runs out of memory. 0 turns
+% the cap off (default), the old cap is returned:
+%
+%   old = mksqlite( 'result_memory_cap', bytes );
+%
+% (see sqlite_test_memstats.m)
+%
+% =======================================================================
+%
+% Open profiles and settings:
+% The open mode and threading mode may be followed by a profile name and
+% pairs of setting names and values, applied by PRAGMAs at opening:
+%
+%   mksqlite( 'open', filename [, iomode] [, threadmode] ...
+%             [, profile] [, name, value, ...] );
+%
+%   'default':   no settings
+%   'bulkload':  journal_mode MEMORY, locking_mode EXCLUSIVE,
+%                synchronous OFF, cache_size -262144 (256 MB),
+%                temp_store MEMORY
+%   'analytics': journal_mode WAL, synchronous NORMAL,
+%                cache_size -131072 (128 MB), mmap_size 1 GB,
+%                temp_store MEMORY
+%   'safe':      journal_mode DELETE, locking_mode NORMAL,
+%                synchronous FULL, mmap_size 0
+%
+% Settings following the profile override it: page_size, journal_mode,
+% locking_mode, synchronous, cache_size, mmap_size and temp_store, e.g.
+%
+%   mksqlite( 'open', 'data.db', 'analytics', 'cache_size', -65536 );
+%
+% If a setting fails, the database is closed again. Read-only databases
+% skip page_size and journal_mode. Connections of the reader pool use
+% cache_size, mmap_size and temp_store as well. The values reported by
+% SQLite are shown by 'status' (fields open_profile and open_settings).
+% (see sqlite_test_open_profiles.m)
+%
+% =======================================================================
+%
+% Serialize and deserialize:
+% A database schema ("main" by default) is returned as an image in a uint8
+% column vector:
+%
+%   bytes = mksqlite( [dbid,] 'serialize' [, schema] );
+%
+% In-memory databases are copied straight from their memory. The image
+% is opened as in-memory database again, without disk I/O:
+%
+%   dbid = mksqlite( [dbid,] 'deserialize', bytes [, mode] );
+%
+% mode is 'resizeable' (default, the database may be changed and grow)
+% or 'readonly'. Like 'open', a dbid of 0 selects a free slot and an
+% open database is closed first.
+% (see sqlite_test_serialize.m)
+%
+% =======================================================================
+%
+% Load into memory and backup:
+% A database file is copied into an in-memory database, e.g. for many
+% read queries, and written back with the online backup API of SQLite:
+%
+%   dbid = mksqlite( [dbid,] 'load_into_memory', filename [, pagesPerStep] );
+%   mksqlite( [dbid,] 'backup', filename [, pagesPerStep] );
+%
+% Like 'open', a dbid of 0 selects a free slot for 'load_into_memory'.
+% Both commands return at once, the pages are copied by a worker thread,
+% pagesPerStep pages at a time (default 256, negative copies all at once).
+% The copy is followed by:
+%
+%   status = mksqlite( [dbid,] 'backup_status' );  % done, pagecount, remaining
+%   done   = mksqlite( [dbid,] 'backup_wait' [, timeout] );
+%   mksqlite( [dbid,] 'backup_cancel' );
+%
+% 'backup_wait' returns 0, if the timeout (seconds) elapsed first, and
+% reports errors of the copy. Any other command on the database waits
+% until the copy has finished. A cancelled 'load_into_memory' leaves the
+% in-memory database empty.
+% (see sqlite_test_backup.m)
+%
 % =======================================================================
 %
 % Extra SQL functions:
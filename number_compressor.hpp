@@ -35,6 +35,8 @@ extern "C"
 #endif
 //#include "global.hpp"
 #include "locale.hpp"
+#include <cmath>
+#include <limits>
 
 /**
  * \name blosc IDs
@@ -85,6 +87,8 @@ private:
     const char*             m_strCompressorType;      ///< name of compressor to use
     compressor_type_e       m_eCompressorType;        ///< enum type of compressor to use
     int                     m_iCompressionLevel;      ///< compression level (0 to 9)
+    size_t                  m_reserve;                ///< bytes to reserve in front of compressed data
+    size_t                  m_result_offset;          ///< offset of \p m_result to its allocated memory
 public:
     void*                   m_rdata;                  ///< uncompressed data
     size_t                  m_rdata_size;             ///< size of uncompressed data in bytes
@@ -107,7 +111,7 @@ private:
 public:
     /// Ctor
     explicit
-    NumberCompressor() : m_result(0)
+    NumberCompressor() : m_result(0), m_reserve(0), m_result_offset(0)
     {
         m_Allocator   = malloc;  // using C memory allocators
         m_DeAllocator = free;
@@ -125,15 +129,37 @@ public:
     {
         if( m_result && !m_result_is_const )
         {
-            m_DeAllocator( m_result );
+            m_DeAllocator( (char*)m_result - m_result_offset );
         }
 
         m_result            = NULL;
         m_result_size       = 0;
         m_result_is_const   = true;
+        m_result_offset     = 0;
     }            
 
     
+    /**
+     * \brief Release custody of self created results
+     *
+     * \returns Pointer to the reserved bytes (see setReserve()), followed by
+     * the compressed data. Memory must be freed with the deallocator.
+     */
+    void* detachResult()
+    {
+        void* result = NULL;
+        
+        if( m_result && !m_result_is_const )
+        {
+            result   = (char*)m_result - m_result_offset;
+            m_result = NULL;
+        }
+        
+        free_result();
+        return result;
+    }
+
+    
     /// Reset input data (compressed and uncompressed) memory without deallocation!
     void clear_data()
     {
@@ -188,6 +214,20 @@ public:
     }
     
     
+    /**
+     * \brief Reserve space in front of compressed data
+     *
+     * \param[in] szBytes Count of bytes to allocate ahead of the compressor output
+     *
+     * Lets the caller put a header in front of the compressed data
+     * without copying it (see detachResult()).
+     */
+    void setReserve( size_t szBytes )
+    {
+        m_reserve = szBytes;
+    }
+    
+    
     /**
      * \brief Converts compressor ID string to category enum
      *
@@ -375,6 +415,7 @@ failed:
         m_result_is_const   = false;
         m_result            = m_cdata;
         m_result_size       = m_cdata_size;
+        m_result_offset     = m_cdata ? m_reserve : 0;
         
         return status;
     }
@@ -452,6 +493,20 @@ failed:
     
     
 private:
+    /**
+     * \brief Allocates memory for compressed data behind the reserved bytes
+     *
+     * \param[in] szBytes Size of compressed data in bytes
+     * \returns Pointer to space for compressed data or NULL on error
+     */
+    void* allocCompressed( size_t szBytes )
+    {
+        char* ptr = (char*)m_Allocator( m_reserve + szBytes );
+        
+        return ptr ? ptr + m_reserve : NULL;
+    }
+    
+    
     /**
      * \brief Allocates memory for compressed data and use it to store results (lossless data compression)
      *
@@ -468,7 +523,7 @@ private:
         // BLOSC grants for that compressed data never 
         // exceeds original size + BLOSC_MAX_OVERHEAD
         m_cdata_size  = m_rdata_size + BLOSC_MAX_OVERHEAD; 
-        m_cdata       = m_Allocator( m_cdata_size );
+        m_cdata       = allocCompressed( m_cdata_size );
 
         if( NULL == m_cdata )
         {
@@ -477,14 +532,18 @@ private:
         }
 
         /* compress raw data (rdata) and store it in cdata */
-        m_cdata_size = blosc_compress( 
+        /* context version, since BLOBs may be packed by worker threads */
+        m_cdata_size = blosc_compress_ctx( 
           /*clevel*/     m_iCompressionLevel, 
           /*doshuffle*/  BLOSC_DOSHUFFLE, 
           /*typesize*/   m_rdata_element_size, 
           /*nbytes*/     m_rdata_size, 
           /*src*/        m_rdata, 
           /*dest*/       m_cdata, 
-          /*destsize*/   m_cdata_size );
+          /*destsize*/   m_cdata_size,
+          /*compressor*/ m_strCompressorType,
+          /*blocksize*/  0,
+          /*numthreads*/ 1 );
         
 #if MKSQLITE_CONFIG_USE_LOGGING
         log_trace( "Leaving bloscCompress()" );
@@ -522,7 +581,8 @@ private:
         }
         
         // decompress directly into items memory space
-        if( blosc_decompress( m_cdata, m_rdata, m_rdata_size ) <= 0 )
+        // (the context version doesn't use global settings, so it's thread safe)
+        if( blosc_decompress_ctx( m_cdata, m_rdata, m_rdata_size, 1 ) <= 0 )
         {
             m_err.set( MSG_ERRCOMPRESSION );
             return false;
@@ -561,7 +621,7 @@ private:
         
         // compressor converts each value to float type
         m_cdata_size = cntElements * sizeof( float );  
-        m_cdata      = m_Allocator( m_cdata_size );
+        m_cdata      = allocCompressed( m_cdata_size );
 
         if( !m_cdata )
         {
@@ -648,9 +708,11 @@ private:
         }
         
         // seek data limits for quantization
+        // (std::isfinite() etc. instead of DBL_ISFINITE() etc., since the latter call
+        // the MATLAB API, which isn't allowed in worker threads (see BlobPackPipeline))
         for( size_t i = 0; i < cntElements; i++ )
         {
-            if( DBL_ISFINITE( rdata[i] ) && rdata[i] != 0.0 )
+            if( std::isfinite( rdata[i] ) && rdata[i] != 0.0 )
             {
                 if( !bMinValSet || rdata[i] < dMinVal )
                 {
@@ -676,7 +738,7 @@ private:
         // compressor converts each value to uint16_t
         // 2 additional floats for offset and scale
         m_cdata_size = 2 * sizeof( float ) + cntElements * sizeof( uint16_t );  
-        m_cdata      = m_Allocator( m_cdata_size );
+        m_cdata      = allocCompressed( m_cdata_size );
 
         if( !m_cdata )
         {
@@ -718,7 +780,7 @@ private:
         for( size_t i = 0; i < cntElements; i++ )
         {
             // non-finite values and zero are mapped to special values
-            if( DBL_ISFINITE( rdata[i] ) && rdata[i] != 0.0 )
+            if( std::isfinite( rdata[i] ) && rdata[i] != 0.0 )
             {
                 double dValue = bDoLog ? log( rdata[i] ) : rdata[i];
 
@@ -731,11 +793,11 @@ private:
                 {
                     *pUintData++ = 0xFFF8u + 1 + ( _copysign( 1.0, rdata[i] ) < 0.0 );
                 }
-                else if( DBL_ISINF( rdata[i] ) )
+                else if( std::isinf( rdata[i] ) )
                 {
                     *pUintData++ = 0xFFF8u + 3 + ( _copysign( 1.0, rdata[i] ) < 0.0 );
                 }
-                else if( DBL_ISNAN( rdata[i] ) )
+                else if( std::isnan( rdata[i] ) )
                 {
                     *pUintData++ = 0xFFF8u + 5;
                 }
@@ -790,9 +852,11 @@ private:
                 {
                     case 1: *rdata = +0.0;      break;
                     case 2: *rdata = -0.0;      break;
-                    case 3: *rdata = +DBL_INF;  break;  // pos. infinity
-                    case 4: *rdata = -DBL_INF;  break;  // neg. infinity
-                    case 5: *rdata = DBL_NAN;   break;  // not a number (NaN)
+                    // std::numeric_limits instead of DBL_INF and DBL_NAN, since the latter
+                    // call the MATLAB API, which isn't allowed in worker threads (see unpackBlobs())
+                    case 3: *rdata = +std::numeric_limits<double>::infinity();  break;  // pos. infinity
+                    case 4: *rdata = -std::numeric_limits<double>::infinity();  break;  // neg. infinity
+                    case 5: *rdata = std::numeric_limits<double>::quiet_NaN();  break;  // not a number (NaN)
                 }
 
                 pUintData++;
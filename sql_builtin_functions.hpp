@@ -26,6 +26,10 @@
 #include "number_compressor.hpp"
 #include "serialize.hpp"
 #include "deelx/deelx.h"
+#include <functional>
+#include <thread>
+#include <vector>
+#include <atomic>
 //#include "utils.hpp"
 
 extern "C"
@@ -48,18 +52,240 @@ void exp_func( sqlite3_context *ctx, int argc, sqlite3_value **argv );
 void ln_func( sqlite3_context *ctx, int argc, sqlite3_value **argv );
 #endif
 
+/// Deferred decompression of a typed BLOB, which may be run by a worker thread
+struct BlobUnpackJob
+{
+    NumberCompressor    m_compressor;       ///< compressor, set up by blob_unpack()
+    void*               m_cdata;            ///< compressed data (owned by the BLOB)
+    size_t              m_cdata_size;       ///< size of compressed data in bytes
+    void*               m_rdata;            ///< data space of the MATLAB array to decompress into
+    size_t              m_rdata_size;       ///< size of \p m_rdata in bytes
+    size_t              m_element_size;     ///< size of one element in bytes
+    bool                m_ok;               ///< true, if data was decompressed
+
+    /// Decompress data (no MATLAB API functions are called)
+    void run()
+    {
+        m_ok = m_compressor.unpack( m_cdata, m_cdata_size, m_rdata, m_rdata_size, m_element_size );
+    }
+};
+
+/// Compression of a typed BLOB in advance, which may be run by a worker thread
+struct BlobPackJob
+{
+    NumberCompressor    m_compressor;       ///< compressor, set up by blob_pack_job()
+    void*               m_rdata;            ///< data space of the MATLAB array to compress
+    size_t              m_rdata_size;       ///< size of \p m_rdata in bytes
+    size_t              m_element_size;     ///< size of one element in bytes
+    bool                m_isDouble;         ///< true, if MATLAB array is of class double
+    double              m_process_time;     ///< processing time in seconds
+    bool                m_ok;               ///< true, if data was compressed
+
+    /// Compress data (no MATLAB API functions are called)
+    void run()
+    {
+        double start_time = utils_get_wall_time();
+        
+        m_ok = m_compressor.pack( m_rdata, m_rdata_size, m_element_size, m_isDouble );
+        m_process_time = utils_get_wall_time() - start_time;
+    }
+};
+
 // Forward declarations
+BlobPackJob* blob_pack_job( const mxArray* pcItem,
+                            const char* compressor = g_compression_type, 
+                            int level = g_compression_level );
 int  blob_pack    ( const mxArray* pcItem, bool bStreamable, 
                     void** ppBlob, size_t* pBlob_size, 
                     double *pdProcess_time, double* pdRatio,
                     const char* compressor = g_compression_type, 
-                    int level = g_compression_level );
+                    int level = g_compression_level,
+                    BlobPackJob* pJob = NULL );
 int  blob_unpack  ( const void* pBlob, size_t blob_size, 
                     bool bStreamable, mxArray** ppItem, 
-                    double* pProcess_time, double* pdRatio );
+                    double* pProcess_time, double* pdRatio,
+                    BlobUnpackJob** ppJob = NULL );
 void blob_free    ( void** pBlob );
 
 
+/**
+ * \brief Compresses typed BLOB parameters of upcoming rows in advance
+ *
+ * Rows are grouped into windows, each holding raw data of about
+ * MKSQLITE_CONFIG_PACK_AHEAD_SIZE bytes (at least one row). While the rows
+ * of the current window are bound and stepped by the main thread, the next 
+ * window is compressed by worker threads. So at most two windows are kept
+ * in memory.
+ *
+ * Only numeric vectors and arrays are compressed in advance (see blob_pack_job()),
+ * all other parameters are converted by the main thread as usual.
+ */
+class BlobPackPipeline
+{
+public:
+    /// Returns the MATLAB array of a parameter (called by the main thread only)
+    typedef std::function<const mxArray*( size_t row, int param )> ArgFcn;
+    
+private:
+    /// Consecutive rows compressed at once
+    struct Window
+    {
+        size_t                      m_first;    ///< first row
+        size_t                      m_end;      ///< row behind the last one
+        std::vector<BlobPackJob*>   m_jobs;     ///< jobs by row and parameter (NULL if not compressed in advance)
+        std::thread                 m_worker;   ///< background thread running the jobs
+        int                         m_threads;  ///< number of compressing threads of this window
+        
+        Window() : m_first(0), m_end(0), m_threads(1) {}
+    };
+    
+    size_t      m_rows;         ///< number of rows
+    int         m_params;       ///< number of parameters per row
+    int         m_threads;      ///< number of compressing threads, shared by both windows
+    ArgFcn      m_arg;          ///< parameter access
+    Window      m_window[2];    ///< current and next window
+    int         m_current;      ///< index of current window
+    
+    // Non-copyable
+    BlobPackPipeline( const BlobPackPipeline& );
+    BlobPackPipeline& operator=( const BlobPackPipeline& );
+    
+    /// Run all jobs of a window
+    static void runJobs( Window* window, int threads )
+    {
+        utils_parallel_for( window->m_jobs.size(), threads, [window]( size_t i )
+        {
+            if( window->m_jobs[i] )
+            {
+                window->m_jobs[i]->run();
+            }
+        } );
+    }
+    
+    /// Set up jobs of a window starting at row \p first, and start compressing them in background
+    void fill( Window& window, size_t first )
+    {
+        size_t bytes = 0;
+        bool   busy  = false;
+        
+        window.m_first = window.m_end = first;
+        
+        while( window.m_end < m_rows && ( window.m_end == first || bytes < MKSQLITE_CONFIG_PACK_AHEAD_SIZE ) )
+        {
+            for( int iParam = 0; iParam < m_params; iParam++ )
+            {
+                const mxArray* item = m_arg( window.m_end, iParam );
+                BlobPackJob*   job  = item ? blob_pack_job( item ) : NULL;
+                
+                if( job )
+                {
+                    bytes += job->m_rdata_size + sizeof( BlobPackJob );
+                    busy = true;
+                }
+                
+                window.m_jobs.push_back( job );
+            }
+            
+            window.m_end++;
+        }
+        
+        if( busy )
+        {
+            try
+            {
+                window.m_worker = std::thread( runJobs, &window, window.m_threads );
+            }
+            catch( ... )
+            {
+                // no thread available, compress in place
+                runJobs( &window, 1 );
+            }
+        }
+    }
+    
+    /// Wait for the background thread and delete all jobs of a window
+    void release( Window& window )
+    {
+        if( window.m_worker.joinable() )
+        {
+            window.m_worker.join();
+        }
+        
+        for( size_t i = 0; i < window.m_jobs.size(); i++ )
+        {
+            delete window.m_jobs[i];
+        }
+        
+        window.m_jobs.clear();
+        window.m_first = window.m_end;
+    }
+    
+public:
+    /**
+     * \brief Standard ctor, starts compressing the first two windows
+     *
+     * \param[in] rows Number of rows
+     * \param[in] params Number of parameters per row
+     * \param[in] threads Number of compressing threads
+     * \param[in] arg Parameter access
+     *
+     * Both windows may be compressed at the same time, so each one gets its
+     * share of \p threads.
+     */
+    BlobPackPipeline( size_t rows, int params, int threads, const ArgFcn& arg )
+    : m_rows( rows ), m_params( params ), m_threads( threads ), m_arg( arg ), m_current( 0 )
+    {
+        m_window[0].m_threads = std::max( 1, ( m_threads + 1 ) / 2 );
+        m_window[1].m_threads = std::max( 1, m_threads / 2 );
+
+        fill( m_window[0], 0 );
+        fill( m_window[1], m_window[0].m_end );
+    }
+    
+    /// Dtor, waits for the worker threads
+    ~BlobPackPipeline()
+    {
+        release( m_window[0] );
+        release( m_window[1] );
+    }
+    
+    /**
+     * \brief Get the compressed parameter of a row
+     *
+     * \param[in] row Row number (must not decrease with subsequent calls)
+     * \param[in] param Parameter number (0 based)
+     * \returns the finished job (owned by the pipeline) or NULL, if the parameter
+     *          wasn't compressed in advance
+     */
+    BlobPackJob* job( size_t row, int param )
+    {
+        while( row >= m_window[m_current].m_end && m_window[m_current].m_end < m_rows )
+        {
+            // current window is done, refill it with the rows after the next window
+            Window& done = m_window[m_current];
+            
+            release( done );
+            m_current = 1 - m_current;
+            fill( done, m_window[m_current].m_end );
+        }
+        
+        Window& window = m_window[m_current];
+        
+        if( row < window.m_first || row >= window.m_end || param < 0 || param >= m_params )
+        {
+            return NULL;
+        }
+        
+        if( window.m_worker.joinable() )
+        {
+            window.m_worker.join();
+        }
+        
+        return window.m_jobs[( row - window.m_first ) * m_params + param];
+    }
+};
+
+
 #ifdef MAIN_MODULE
 
 /* sqlite builtin functions, implementations */
@@ -770,6 +996,74 @@ void blob_free( void** ppBlob )
 }
 
 
+/// Count of BLOB allocations by blob_alloc() (see 'memstats')
+static std::atomic<unsigned long long> g_blob_alloc_count( 0 );
+
+/// Bytes allocated by blob_alloc() (see 'memstats')
+static std::atomic<unsigned long long> g_blob_alloc_bytes( 0 );
+
+
+/**
+ * \brief Allocates BLOB memory by SQLite allocator
+ *
+ * \param[in] size Size in bytes
+ *
+ * Allocations are counted, worker threads may call this function.
+ */
+static
+void* blob_alloc( size_t size )
+{
+    g_blob_alloc_count++;
+    g_blob_alloc_bytes += size;
+
+    return sqlite3_malloc64( size );
+}
+
+
+/**
+ * \brief Prepare the compression of a MATLAB array for a worker thread
+ *
+ * \param[in] pcItem MATLAB array to compress (must outlive the job)
+ * \param[in] compressor name of compressor to use (optional). 
+ *            Default is global setting g_compression_type
+ * \param[in] level compression level (optional). 
+ *            Default is global setting g_compression_level
+ * \returns a new job (to be deleted by the caller) or NULL, if \p pcItem
+ *          is no numeric vector or array (scalars, texts, serialization)
+ *
+ * The job is run by BlobPackJob::run() and finally passed to blob_pack().
+ */
+BlobPackJob* blob_pack_job( const mxArray* pcItem, const char* compressor, int level )
+{
+    ValueMex     value( pcItem );
+    BlobPackJob* job = NULL;
+    int          iTypeComplexity = value.Complexity();
+    
+    // only non-complex numeric arrays, no scalars or serialized data
+    if( !level || ( iTypeComplexity != ValueMex::TC_SIMPLE_VECTOR && 
+                    iTypeComplexity != ValueMex::TC_SIMPLE_ARRAY ) )
+    {
+        return NULL;
+    }
+    
+    job = new BlobPackJob;
+    
+    // setCompressor() always returns true, since parameters had been checked already
+    (void)job->m_compressor.setCompressor( compressor, level );
+    job->m_compressor.setAllocator( blob_alloc, sqlite3_free );
+    job->m_compressor.setReserve( TypedBLOBHeaderV2::dataOffset( value.NumDims() ) );
+    
+    job->m_rdata        = value.Data();
+    job->m_rdata_size   = value.ByData();
+    job->m_element_size = value.ByElement();
+    job->m_isDouble     = value.IsDoubleClass();
+    job->m_process_time = 0.0;
+    job->m_ok           = false;
+    
+    return job;
+}
+
+
 /**
  * \brief create a compressed typed blob from a Matlab item (deep copy)
  *
@@ -783,11 +1077,14 @@ void blob_free( void** ppBlob )
  *            Default is global setting g_compression_type
  * \param[in] level compression level (optional). 
  *            Default is global setting g_compression_level
+ * \param[in] pJob already run compression job of \p pcItem (optional),
+ *            see blob_pack_job(). The compressed data is taken from the job.
  */
 int blob_pack( const mxArray* pcItem, bool bStreamable, 
                void** ppBlob, size_t* pBlob_size, 
                double *pdProcess_time, double* pdRatio,
-               const char* compressor, int level )
+               const char* compressor, int level,
+               BlobPackJob* pJob )
 {
     Err err;
     
@@ -795,7 +1092,8 @@ int blob_pack( const mxArray* pcItem, bool bStreamable,
     
     ValueMex          value( pcItem );           // object wrapper
     mxArray*          byteStream        = NULL;  // for stream preprocessing
-    NumberCompressor  numericSequence;           // compressor
+    NumberCompressor  localSequence;             // compressor
+    NumberCompressor& numericSequence   = pJob ? pJob->m_compressor : localSequence;
     
     // BLOB packaging in 3 steps:
     // 1. Serialize
@@ -824,20 +1122,41 @@ int blob_pack( const mxArray* pcItem, bool bStreamable,
      * create a typed blob. Header information is generated
      * according to value and type of the matrix and the machine
      */
-    // setCompressor() always returns true, since parameters had been checked already
-    (void)numericSequence.setCompressor( compressor, level );
+    // jobs are set up by blob_pack_job() already
+    if( !pJob )
+    {
+        // setCompressor() always returns true, since parameters had been checked already
+        (void)numericSequence.setCompressor( compressor, level );
+        
+        // compressed data is placed right behind the typed blob header
+        // in memory, which is provided by the SQLite allocator
+        numericSequence.setAllocator( blob_alloc, sqlite3_free );
+        numericSequence.setReserve( TypedBLOBHeaderV2::dataOffset( value.NumDims() ) );
+    }
     
     // only if compression is desired
-    if( g_compression_level )
+    if( pJob || g_compression_level )
     {
-        double start_time = utils_get_wall_time();
         bool   status;
         
+        if( pJob )
+        {
+            // data has been compressed by a worker thread
+            status          = pJob->m_ok;
+            *pdProcess_time = pJob->m_process_time;
+        }
+        else
+        {
+            double start_time = utils_get_wall_time();
+            
 #if MKSQLITE_CONFIG_USE_LOGGING
-        log_trace( "Start compression" );
+            log_trace( "Start compression" );
 #endif
-        status = numericSequence.pack( value.Data(), value.ByData(), value.ByElement(), 
-                                       value.IsDoubleClass() );  // allocates m_rdata
+            status = numericSequence.pack( value.Data(), value.ByData(), value.ByElement(), 
+                                           value.IsDoubleClass() );  // allocates m_rdata
+            
+            *pdProcess_time = utils_get_wall_time() - start_time;
+        }
         
 #if MKSQLITE_CONFIG_USE_LOGGING
         if( !status )
@@ -845,7 +1164,6 @@ int blob_pack( const mxArray* pcItem, bool bStreamable,
             log_trace( "Compression failed" );
         }
 #endif
-        *pdProcess_time = utils_get_wall_time() - start_time;
         
         // any compressed data omitted?
         if( numericSequence.m_result_size > 0 )
@@ -890,22 +1208,15 @@ int blob_pack( const mxArray* pcItem, bool bStreamable,
                 goto finalize;
             }
 
-            // allocate space for a typed blob containing compressed data
-            tbh2 = (TypedBLOBHeaderV2*)sqlite3_malloc( (int)*pBlob_size );
-            if( NULL == tbh2 )
-            {
-                err.set( MSG_ERRMEMORY );
-                goto finalize;
-            }
+            // take custody of the typed blob containing compressed data
+            tbh2 = (TypedBLOBHeaderV2*)numericSequence.detachResult();
+            assert( tbh2 );
 
-            // blob typing...
-            tbh2->init( value.Item() );
-            tbh2->setCompressor( numericSequence.getCompressorName() );
-
-            // ...and copy compressed data
+            // blob typing, compressed data is already in place
             /// \todo Do byteswapping here if big endian? 
             // (Most platforms use little endian)
-            memcpy( (char*)tbh2->getData(), numericSequence.m_result, numericSequence.m_result_size );
+            tbh2->init( value.Item() );
+            tbh2->setCompressor( numericSequence.getCompressorName() );
             
             // optionally check if compressed data equals to original?
             if( g_compression_check && !numericSequence.isLossy() )
@@ -956,7 +1267,7 @@ int blob_pack( const mxArray* pcItem, bool bStreamable,
             goto finalize;
         }
 
-        tbh1 = (TypedBLOBHeaderV1*)sqlite3_malloc( (int)*pBlob_size );
+        tbh1 = (TypedBLOBHeaderV1*)blob_alloc( *pBlob_size );
         if( NULL == tbh1 )
         {
             err.set( MSG_ERRMEMORY );
@@ -999,10 +1310,13 @@ finalize:
  * \param[in] ppItem MATLAB array to compress
  * \param[out] pdProcess_time Processing time in seconds
  * \param[out] pdRatio Realized compression ratio
+ * \param[out] ppJob If given, decompression of compressed numeric arrays is deferred
+ *   to the returned job (or NULL), \p ppItem receives an array with uninitialized data then
  */
 int blob_unpack( const void* pBlob, size_t blob_size, bool bStreamable, 
                  mxArray** ppItem, 
-                 double* pdProcess_time, double* pdRatio )
+                 double* pdProcess_time, double* pdRatio,
+                 BlobUnpackJob** ppJob )
 {
     Err err;
     bool bIsByteStream = false;
@@ -1019,6 +1333,11 @@ int blob_unpack( const void* pBlob, size_t blob_size, bool bStreamable,
     *pdProcess_time = 0.0;
     *pdRatio        = 1.0;
     
+    if( ppJob )
+    {
+        *ppJob = NULL;
+    }
+    
     tbhv1_t* tbh1 = (tbhv1_t*)pBlob;
     tbhv2_t* tbh2 = (tbhv2_t*)pBlob;
     
@@ -1071,8 +1390,23 @@ int blob_unpack( const void* pBlob, size_t blob_size, bool bStreamable,
           // create an empty MATLAB array
           pItem = tbh2->createNumericArray( /* doCopyData */ false );
           
+          // decompression of byte streams can't be deferred, since they must be deserialized
+          if( pItem && ppJob && !bIsByteStream )
+          {
+              BlobUnpackJob* job = new BlobUnpackJob;
+              
+              job->m_compressor.setCompressor( tbh2->m_compression );
+              job->m_cdata        = tbh2->getData();
+              job->m_cdata_size   = blob_size - tbh2->dataOffset();
+              job->m_rdata        = ValueMex(pItem).Data();
+              job->m_rdata_size   = ValueMex(pItem).ByData();
+              job->m_element_size = ValueMex(pItem).ByElement();
+              job->m_ok           = false;
+              
+              *ppJob = job;
+          }
           // space allocated?
-          if( pItem )
+          else if( pItem )
           {
               numericSequence.setCompressor( tbh2->m_compression );
 
@@ -26,6 +26,14 @@
 //#include "value.hpp"
 //#include "locale.hpp"
 #include <map>
+#include <list>
+#include <unordered_set>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <atomic>
 
 // Handling Ctrl+C functions, see also http://undocumentedmatlab.com/blog/mex-ctrl-c-interrupt
 extern "C" bool utIsInterruptPending();
@@ -41,10 +49,12 @@ extern "C" int  sqlite3_uuid_init( sqlite3 *db );
 typedef vector<ValueSQLCol> ValueSQLCols;
 
 extern ValueMex createItemFromValueSQL( const ValueSQL& value, int& err_id );  /* mksqlite.cpp */
-extern ValueSQL createValueSQLFromItem( const ValueMex& item, bool bStreamable, int& iTypeComplexity, int& err_id );  /* mksqlite.cpp */
+extern ValueSQL createValueSQLFromItem( const ValueMex& item, bool bStreamable, int& iTypeComplexity, int& err_id, BlobPackJob* pJob = NULL );  /* mksqlite.cpp */
 
 class SQLstack;
 class SQLiface;
+class SQLticket;
+class SQLbackup;
 class MexFunctors;
 
 
@@ -355,1199 +365,3404 @@ public:
 };
 
 
-/// Class holding an exception array, the function map and the handle for one database
-class SQLstackitem
+/**
+ * \brief Field names of the result columns of a prepared statement
+ *
+ * Built once by SQLiface::getColNames() and kept with the statement, so 
+ * repeated executions skip it. The names get invalid, when SQLite prepares
+ * the statement again with other columns (schema changes) or 
+ * g_check4uniquefields is switched. The column names are compared for
+ * this, since the statement counters are reset by profiling.
+ */
+struct SQLcolNames
 {
-    typedef map<string, MexFunctors*> MexFunctorsMap;   ///< Dictionary: function name => function handles
+    ValueSQLCol::StringPairList m_names;        ///< pairs of column name and field name
+    int                         m_unique;       ///< g_check4uniquefields, when built
+    bool                        m_valid;        ///< true, if \a m_names are built
+
+    /// Ctor
+    SQLcolNames() : m_unique( 0 ), m_valid( false )
+    {}
+
+
+    /// Returns true, if the names were built for the columns of \p stmt
+    bool isValid( sqlite3_stmt* stmt )
+    {
+        if( !m_valid || m_unique != g_check4uniquefields || (int)m_names.size() != sqlite3_column_count( stmt ) )
+        {
+            return false;
+        }
+
+        for( int i = 0; i < (int)m_names.size(); i++ )
+        {
+            const char* name = sqlite3_column_name( stmt, i );
+
+            if( !name || m_names[i].first != name )
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+
+    /// Mark the names as built
+    void validate()
+    {
+        m_unique = g_check4uniquefields;
+        m_valid  = true;
+    }
 
-    sqlite3*        m_db;           ///< SQLite db object
-    MexFunctorsMap  m_fcnmap;       ///< MEX function map with MATLAB functions for application-defined SQL functions
-    ValueMex        m_exception;    ///< MATALAB exception array, may be thrown when mksqlite function leaves
+
+    /// Discard the names
+    void clear()
+    {
+        m_names.clear();
+        m_valid = false;
+    }
+
+
+    /// Exchange contents with \p other
+    void swap( SQLcolNames& other )
+    {
+        m_names.swap( other.m_names );
+        std::swap( m_unique, other.m_unique );
+        std::swap( m_valid, other.m_valid );
+    }
+};
+
+
+/**
+ * \brief LRU cache of prepared statements, keyed by their SQL text
+ *
+ * Statements are taken out of the cache while in use and given back
+ * (reset, without bindings) when finished. So a statement is never
+ * shared by two concurrent users (recursive calls of mksqlite from
+ * application-defined functions, f.e.).
+ */
+class SQLstmtCache
+{
+    /// SQL text, its prepared statement and the field names of its columns
+    struct Entry
+    {
+        string          m_query;        ///< SQL text
+        sqlite3_stmt*   m_stmt;         ///< prepared statement
+        SQLcolNames     m_colNames;     ///< field names of the result columns
+
+        /// Ctor
+        Entry( const char* query, sqlite3_stmt* stmt ) : m_query( query ), m_stmt( stmt )
+        {}
+    };
+
+    typedef list<Entry>                         EntryList;  ///< Entries, most recently used first
+    typedef map<string, EntryList::iterator>    EntryMap;   ///< Dictionary: SQL text => entry
+
+    EntryList   m_lru;          ///< cached statements, most recently used first
+    EntryMap    m_index;        ///< lookup table into m_lru
+    double      m_hits;         ///< count of statements taken from cache
+    double      m_misses;       ///< count of statements which had to be prepared
 
 public:
 
     /// Ctor
-    SQLstackitem() : m_db( NULL )
+    SQLstmtCache() : m_hits( 0.0 ), m_misses( 0.0 )
     {}
 
 
     /// Dtor
-    ~SQLstackitem()
+    ~SQLstmtCache()
     {
-        SQLerror err;
-        closeDb( err );
+        flush();
     }
 
 
-    /// Return 
-    sqlite3* dbid()
+    /**
+     * \brief Take a statement out of the cache
+     *
+     * \param[in] query SQL text the statement was prepared from
+     * \param[out] colNames Field names of the result columns, kept with the statement
+     * \returns the prepared statement or NULL, if not cached
+     */
+    sqlite3_stmt* take( const char* query, SQLcolNames& colNames )
     {
-        return m_db;
+        EntryMap::iterator it = m_index.find( query );
+
+        if( it == m_index.end() )
+        {
+            m_misses++;
+            return NULL;
+        }
+
+        sqlite3_stmt* stmt = it->second->m_stmt;
+        colNames.swap( it->second->m_colNames );
+        m_lru.erase( it->second );
+        m_index.erase( it );
+        m_hits++;
+
+        return stmt;
     }
 
-    /// Returns the exception array for this database
-    ValueMex& getException()
+
+    /**
+     * \brief Give a statement (back) into custody of the cache
+     *
+     * The least recently used statements will be finalized, if
+     * the cache exceeds \p capacity.
+     *
+     * \param[in] query SQL text the statement was prepared from
+     * \param[in] stmt Statement, already reset and bindings cleared
+     * \param[in] capacity Max. number of cached statements
+     * \param[in,out] colNames Field names of the result columns, taken into custody
+     */
+    void give( const char* query, sqlite3_stmt* stmt, int capacity, SQLcolNames& colNames )
     {
-        return m_exception;
+        EntryMap::iterator it = m_index.find( query );
+
+        if( it != m_index.end() || capacity < 1 )
+        {
+            // Same statement is already cached (recursive use)
+            sqlite3_finalize( stmt );
+            return;
+        }
+
+        m_lru.push_front( Entry( query, stmt ) );
+        m_lru.front().m_colNames.swap( colNames );
+        m_index[query] = m_lru.begin();
+
+        trim( capacity );
     }
 
 
-    /// (Re-)Throws an exception, if any occurred
-    void throwOnException()
+    /// Finalize least recently used statements until \p capacity is reached
+    void trim( int capacity )
     {
-        m_exception.Throw();
+        while( !m_lru.empty() && (int)m_lru.size() > capacity )
+        {
+            sqlite3_finalize( m_lru.back().m_stmt );
+            m_index.erase( m_lru.back().m_query );
+            m_lru.pop_back();
+        }
     }
 
-  
-    /// Returns the function map for this database
-    MexFunctorsMap& fcnmap()
+
+    /// Finalize all cached statements
+    void flush()
     {
-        return m_fcnmap;
+        trim( 0 );
     }
 
 
-    /// Progress handler (watchdog)
-    static
-    int progressHandler( void* data )
+    /// Returns the number of cached statements
+    int size()
     {
-        // Ctrl+C pressed?
-        if( utIsInterruptPending() )
-        {
-            utSetInterruptHandled( true );
-            PRINTF( "%s\n", ::getLocaleMsg( MSG_ABORTED ) );
-            return 1;
-        }
-        return 0;
+        return (int)m_lru.size();
     }
 
 
-    /// Installing progress handler to enable aborting by Ctrl+C
-    void setProgressHandler( bool enable = true )
+    /// Returns the count of cache hits
+    double hits()
     {
-        const int N_INSTRUCTIONS = 1000;
-        sqlite3_progress_handler( m_db, enable ? N_INSTRUCTIONS : 0, &SQLstackitem::progressHandler, NULL );
+        return m_hits;
+    }
+
+
+    /// Returns the count of cache misses
+    double misses()
+    {
+        return m_misses;
+    }
+
+
+    /// Reset hit and miss counters
+    void resetCounters()
+    {
+        m_hits = m_misses = 0.0;
     }
 
 
     /**
-     * \brief Opens (or create) database
+     * \brief Check if \p query may change the database schema
      *
-     * \param[in] filename Name of database file
-     * \param[in] openFlags Flags for access rights (see SQLite documentation for sqlite3_open_v2())
-     * \param[out] err Error information
-     * \returns true if succeeded
+     * Such statements invalidate the cache and are not cached themselves.
      */
-    bool openDb( const char* filename, int openFlags, SQLerror& err )
+    static
+    bool isSchemaChange( const char* query )
     {
-        if( !closeDb( err ) )
+        static const char* keywords[] = { "CREATE", "DROP", "ALTER", "ATTACH", "DETACH", "VACUUM", "REINDEX", "ANALYZE" };
+
+        while( query && isspace( (unsigned char)*query ) )
         {
-            return false;
+            query++;
         }
-        
-        /*
-         * Open the database
-         * m_db is assigned by sqlite3_open_v2(), even if an error
-         * occures
-         */
-        unsigned char* filename_utf8 = NULL;
-        int filename_utf8_bytes = utils_latin2utf( (const unsigned char*)filename, NULL );
 
-        if( filename_utf8_bytes )
+        for( int i = 0; query && i < (int)(sizeof(keywords) / sizeof(keywords[0])); i++ )
         {
-            filename_utf8 = (unsigned char*)MEM_ALLOC( filename_utf8_bytes, sizeof(char) );
-            utils_latin2utf( (const unsigned char*)filename, filename_utf8 );
+            size_t len = strlen( keywords[i] );
 
-            if( !filename_utf8 )
+            if( 0 == _strnicmp( query, keywords[i], len ) && !isalnum( (unsigned char)query[len] ) )
             {
-                err.set( MSG_ERRMEMORY );
+                return true;
             }
         }
 
-        if( filename_utf8 && !err.isPending() )
-        {
-            int rc = sqlite3_open_v2( (char*)filename_utf8, &m_db, openFlags, NULL );
+        return false;
+    }
+};
 
-            if( SQLITE_OK != rc )
-            {
-                err.setSqlError( m_db, -1 );
-            }
 
-            sqlite3_extended_result_codes( m_db, true );
-            attachBuiltinFunctions();
-            utSetInterruptEnabled( true );
-            setProgressHandler( true );
-        }
+/// Prepared statement or cursor held by a handle, persistent between calls of mksqlite
+struct SQLhandle
+{
+    string      m_query;        ///< SQL text (UTF-8), referenced by \a m_iface
+    SQLiface*   m_iface;        ///< interface owning the prepared statement
+    bool        m_isCursor;     ///< true, if statement is stepped across calls (cursor)
+    bool        m_done;         ///< true, if cursor has no more rows (or has failed)
 
-        MEM_FREE( filename_utf8 );
+    /// Ctor
+    SQLhandle() : m_iface( NULL ), m_isCursor( false ), m_done( false )
+    {}
+};
 
-        return !err.isPending();
-    }
 
+/// Performance counters of one database, collected while g_stats is set (see 'stats')
+struct SQLstats
+{
+    double  m_calls;            ///< count of SQL statement calls
+    double  m_rows;             ///< count of fetched rows
+    double  m_text_bytes;       ///< bytes of fetched texts
+    double  m_blob_bytes;       ///< bytes of fetched BLOBs
+    double  m_packed;           ///< count of packed typed BLOBs
+    double  m_unpacked;         ///< count of unpacked typed BLOBs
+    double  m_prepare_time;     ///< seconds spent preparing statements
+    double  m_step_time;        ///< seconds spent stepping statements
+    double  m_column_time;      ///< seconds spent extracting column values (without text conversion)
+    double  m_convert_time;     ///< seconds spent converting texts (UTF-8)
+    double  m_pack_time;        ///< seconds spent packing typed BLOBs
+    double  m_unpack_time;      ///< seconds spent unpacking typed BLOBs
+    double  m_result_time;      ///< seconds spent creating MATLAB result arrays (without unpacking)
+    double  m_total_time;       ///< seconds spent in SQL statement calls overall
 
-    /// Close database
-    bool closeDb( SQLerror& err )
+    /// Ctor
+    SQLstats()
     {
-        // Deallocate functors
-        for( MexFunctorsMap::iterator it = m_fcnmap.begin(); it != m_fcnmap.end(); it++ )
-        {
-            delete it->second;
-        }
-        m_fcnmap.clear();
+        reset();
+    }
 
-        // m_db may be NULL, since sqlite3_close with a NULL argument is a harmless no-op
-        int rc = sqlite3_close( m_db );
-        if( SQLITE_OK == rc )
-        {
-            m_db = NULL;
-        }
-        else
-        {
-            PRINTF( "%s\n", ::getLocaleMsg( MSG_ERRCANTCLOSE ) );
-            err.setSqlError( m_db, -1 ); /* not SQL_ERR_CLOSE */
-        }
-        
-        return !isOpen();
+    /// Clear all counters
+    void reset()
+    {
+        m_calls = m_rows = m_text_bytes = m_blob_bytes = m_packed = m_unpacked = 0.0;
+        m_prepare_time = m_step_time = m_column_time = m_convert_time = 0.0;
+        m_pack_time = m_unpack_time = m_result_time = m_total_time = 0.0;
     }
 
+    /// Returns the counters collected since \p start was copied
+    SQLstats since( const SQLstats& start ) const
+    {
+        SQLstats delta;
+
+        delta.m_calls        = m_calls        - start.m_calls;
+        delta.m_rows         = m_rows         - start.m_rows;
+        delta.m_text_bytes   = m_text_bytes   - start.m_text_bytes;
+        delta.m_blob_bytes   = m_blob_bytes   - start.m_blob_bytes;
+        delta.m_packed       = m_packed       - start.m_packed;
+        delta.m_unpacked     = m_unpacked     - start.m_unpacked;
+        delta.m_prepare_time = m_prepare_time - start.m_prepare_time;
+        delta.m_step_time    = m_step_time    - start.m_step_time;
+        delta.m_column_time  = m_column_time  - start.m_column_time;
+        delta.m_convert_time = m_convert_time - start.m_convert_time;
+        delta.m_pack_time    = m_pack_time    - start.m_pack_time;
+        delta.m_unpack_time  = m_unpack_time  - start.m_unpack_time;
+        delta.m_result_time  = m_result_time  - start.m_result_time;
+        delta.m_total_time   = m_total_time   - start.m_total_time;
+
+        return delta;
+    }
 
-    /// Returns true, if database is opened
-    bool isOpen()
+    /// Returns a monotonic time in seconds
+    static
+    double now()
     {
-        return NULL != m_db;
+        return std::chrono::duration<double>( std::chrono::steady_clock::now().time_since_epoch() ).count();
     }
-    
 
     /**
-     * \brief Attach builtin functions to database object
+     * \brief Scoped timer, adds the elapsed time to a counter
      *
-     * Following builtin functions are involved:
-     * - pow
-     * - regex
-     * - bcdratio
-     * - bdcpacktime
-     * - bdcunpacktime
-     * - md5
+     * Does nothing, if the counter is NULL (statistics disabled). Time added 
+     * meanwhile to \p exclude is subtracted, so nested timers don't count twice.
      */
-    void attachBuiltinFunctions()
+    class Timer
     {
-        if( !isOpen() )
+        double*         m_counter;  ///< counter to add the elapsed time to, or NULL
+        const double*   m_exclude;  ///< nested counter, or NULL
+        double          m_excluded; ///< value of \a m_exclude at start
+        double          m_start;    ///< start time
+
+    public:
+        /// Ctor, starts the timer
+        Timer( double* counter, const double* exclude = NULL ) 
+        : m_counter( counter ), m_exclude( counter ? exclude : NULL ), m_excluded( 0.0 ), m_start( 0.0 )
         {
-            assert( false );
+            if( m_counter )
+            {
+                m_excluded = m_exclude ? *m_exclude : 0.0;
+                m_start    = now();
+            }
         }
-        else
+
+        /// Dtor, stops the timer
+        ~Timer()
         {
-            // attach new SQL commands to opened database
-            sqlite3_create_function( m_db, "lg", 1, SQLITE_UTF8, NULL, lg_func, NULL, NULL );                         // power function (math)
-            sqlite3_create_function( m_db, "regex", 2, SQLITE_UTF8, NULL, regex_func, NULL, NULL );                   // regular expressions (MATCH mode)
-            sqlite3_create_function( m_db, "regex", 3, SQLITE_UTF8, NULL, regex_func, NULL, NULL );                   // regular expressions (REPLACE mode)
-            sqlite3_create_function( m_db, "bdcratio", 1, SQLITE_UTF8, NULL, BDC_ratio_func, NULL, NULL );            // compression ratio (blob data compression)
-            sqlite3_create_function( m_db, "bdcpacktime", 1, SQLITE_UTF8, NULL, BDC_pack_time_func, NULL, NULL );     // compression time (blob data compression)
-            sqlite3_create_function( m_db, "bdcunpacktime", 1, SQLITE_UTF8, NULL, BDC_unpack_time_func, NULL, NULL ); // decompression time (blob data compression)
-            sqlite3_create_function( m_db, "md5", 1, SQLITE_UTF8, NULL, MD5_func, NULL, NULL );                       // Message-Digest (RSA)
-#ifndef SQLITE_ENABLE_MATH_FUNCTIONS
-            sqlite3_create_function( m_db, "ceil", 1, SQLITE_UTF8, NULL, ceil_func, NULL, NULL );                     // ceil function (math)
-            sqlite3_create_function( m_db, "floor", 1, SQLITE_UTF8, NULL, floor_func, NULL, NULL );                   // floor function (math)
-            sqlite3_create_function( m_db, "pow", 2, SQLITE_UTF8, NULL, pow_func, NULL, NULL );                       // power function (math)
-            sqlite3_create_function( m_db, "exp", 1, SQLITE_UTF8, NULL, exp_func, NULL, NULL );                       // power function (math)
-            sqlite3_create_function( m_db, "ln", 1, SQLITE_UTF8, NULL, ln_func, NULL, NULL );                         // power function (math)
-#endif
-            
-#if MKSQLITE_CONFIG_USE_UUID
-            // uuid.c (sqlite.org)
-            sqlite3_uuid_init( m_db );
-#endif
+            stop();
+        }
+
+        /// Stop the timer and add the elapsed time to the counter
+        void stop()
+        {
+            if( m_counter )
+            {
+                *m_counter += now() - m_start - ( m_exclude ? *m_exclude - m_excluded : 0.0 );
+                m_counter   = NULL;
+            }
         }
+    };
+};
+
+
+/// Counters of the statement fetched last (see 'last_query_profile')
+struct SQLprofile
+{
+    /// Counters and estimates of one loop of the query plan (SQLITE_ENABLE_STMT_SCANSTATUS only)
+    struct Loop
+    {
+        string  m_name;             ///< name of the table or index
+        string  m_explain;          ///< description of the loop (as EXPLAIN QUERY PLAN)
+        double  m_loops;            ///< count of times the loop was run
+        double  m_visits;           ///< count of rows visited
+        double  m_estimate;         ///< estimated rows per run by the query planner
+    };
+
+    string          m_query;            ///< SQL text (UTF-8)
+    double          m_fullscan_steps;   ///< steps of full table scans (SQLITE_STMTSTATUS_FULLSCAN_STEP)
+    double          m_sorts;            ///< sort operations (SQLITE_STMTSTATUS_SORT)
+    double          m_autoindexes;      ///< rows inserted into automatic indices (SQLITE_STMTSTATUS_AUTOINDEX)
+    double          m_vm_steps;         ///< virtual machine operations (SQLITE_STMTSTATUS_VM_STEP)
+    double          m_reprepares;       ///< automatic reprepares due to schema changes (SQLITE_STMTSTATUS_REPREPARE)
+    double          m_runs;             ///< completed runs (SQLITE_STMTSTATUS_RUN)
+    double          m_filter_misses;    ///< bloom filter misses (SQLITE_STMTSTATUS_FILTER_MISS)
+    double          m_filter_hits;      ///< bloom filter hits (SQLITE_STMTSTATUS_FILTER_HIT)
+    double          m_memused;          ///< bytes of memory used by the statement (SQLITE_STMTSTATUS_MEMUSED)
+    vector<Loop>    m_loops;            ///< loops of the query plan
+
+    /// Ctor
+    SQLprofile()
+    {
+        reset();
+    }
+
+    /// Clear all counters
+    void reset()
+    {
+        m_query.clear();
+        m_fullscan_steps = m_sorts = m_autoindexes = m_vm_steps = m_reprepares = 0.0;
+        m_runs = m_filter_misses = m_filter_hits = m_memused = 0.0;
+        m_loops.clear();
     }
 };
 
 
+/// Rows of a statement stepped by a worker thread, held without the MATLAB API
+struct SQLrowBuffer
+{
+    /// One value of a row
+    struct Value
+    {
+        int             m_type;     ///< SQLite type (SQLITE_NULL, SQLITE_INTEGER, ...)
+        sqlite3_int64   m_int;      ///< integer value
+        double          m_float;    ///< floating point value
+        size_t          m_offset;   ///< offset of text or BLOB in \a m_data
+        size_t          m_bytes;    ///< size of text or BLOB in bytes
+    };
+
+    int                 m_cols;     ///< column count
+    vector<Value>       m_values;   ///< values, row by row
+    string              m_data;     ///< texts (zero terminated) and BLOBs
+    bool                m_capped;   ///< true, if fetching was stopped by g_result_memory_cap
 
+    /// Ctor
+    SQLrowBuffer() : m_cols( 0 ), m_capped( false )
+    {}
 
+    /// Returns the number of rows
+    size_t rows() const
+    {
+        return m_cols ? m_values.size() / m_cols : 0;
+    }
+};
 
 
 /**
- * \brief SQLite interface
+ * \brief Settings applied by PRAGMAs when a database is opened (see 'open')
  *
- * Encapsulates one sqlite object with pending command and statement.
+ * A named profile presets several settings, single options override them.
+ * The settings are applied in a fixed order (page_size must precede 
+ * journal_mode=WAL on a new database file), the values reported by SQLite 
+ * afterwards are kept in \a m_applied and shown by 'status'.
  */
-class SQLiface
+struct SQLopenOptions
 {
-    SQLstackitem*   m_pstackitem;   ///< pointer to current database
-    sqlite3*        m_db;           ///< SQLite db handle
-    const char*     m_command;      ///< SQL query (no ownership, read-only!)
-    sqlite3_stmt*   m_stmt;         ///< SQL statement (sqlite bridge)
-    SQLerror        m_lasterr;      ///< recent error message
-          
-public:
-  friend class SQLerror;
+    typedef pair<string,string> Option;     ///< PRAGMA name and value
 
-  /// Standard ctor
-  SQLiface( SQLstackitem& stackitem ) :
-    m_pstackitem( &stackitem ),
-    m_db( stackitem.dbid() ),
-    m_command( NULL ),
-    m_stmt( NULL )
-  {
-      // Multiple calls of sqlite3_initialize() are harmless no-ops
-      sqlite3_initialize();
-  }
-    
-  
-  /// Dtor
-  ~SQLiface()
-  {
-      closeStmt();
-  }
+    /// Number of settings, and the first settings applied to read-only and reader pool connections
+    enum { COUNT = 7, FIRST_READONLY = 2, FIRST_READER = 4 };
 
+    string          m_profile;              ///< profile name, or empty
+    string          m_values[COUNT];        ///< requested values, empty if not set
+    vector<Option>  m_applied;              ///< values reported by SQLite after applying
 
-  /// Returns true, if database is open
-  bool isOpen()
-  {
-      return NULL != m_db;
-  }
+    /// Names of the settings (PRAGMAs) in order of application
+    static
+    const char* name( int index )
+    {
+        // settings of the database file, of the connection, and of its caches
+        static const char* names[COUNT] = { "page_size", "journal_mode", "locking_mode", "synchronous",
+                                             "cache_size", "mmap_size", "temp_store" };
 
+        return names[index];
+    }
 
-  /// Clear recent error message
-  void clearErr()
-  {
-      m_lasterr.clear();
-  }
-  
+    /// Returns the index of setting \p key, or -1 if unknown
+    static
+    int find( const char* key )
+    {
+        for( int i = 0; key && i < COUNT; i++ )
+        {
+            if( 0 == _strcmpi( key, name( i ) ) )
+            {
+                return i;
+            }
+        }
 
-  /// Get recent error message
-  const char* getErr( const char** errid = NULL )
-  {   
-      return m_lasterr.get( errid );
-  }
+        return -1;
+    }
 
+    /// Returns true, if \p profile is a known profile name
+    static
+    bool isProfile( const char* profile )
+    {
+        SQLopenOptions options;
 
-  /// Sets an error by its ID (see \ref MSG_IDS)
-  void setErr( int err_id )
-  {
-      m_lasterr.set( err_id );
-  }
+        return options.setProfile( profile );
+    }
 
+    /**
+     * \brief Preset settings by profile
+     *
+     * \param[in] profile Profile name ("default", "bulkload", "analytics" or "safe")
+     * \returns false, if the profile is unknown
+     */
+    bool setProfile( const char* profile )
+    {
+        // page_size, journal_mode, locking_mode, synchronous, cache_size, mmap_size, temp_store
+        static const struct { const char* name; const char* values[COUNT]; } profiles[] =
+        {
+            { "default",   { "", "",       "",          "",       "",        "",           ""       } },
+            { "bulkload",  { "", "MEMORY", "EXCLUSIVE", "OFF",    "-262144", "",           "MEMORY" } },
+            { "analytics", { "", "WAL",    "",          "NORMAL", "-131072", "1073741824", "MEMORY" } },
+            { "safe",      { "", "DELETE", "NORMAL",    "FULL",   "",        "0",          ""       } },
+        };
 
-  /// Sets an error by its SQL return code
-  void setSqlError( int rc )
-  {
-      m_lasterr.setSqlError( m_db, rc );
-  }
+        for( int i = 0; i < (int)( sizeof( profiles ) / sizeof( profiles[0] ) ); i++ )
+        {
+            if( profile && 0 == _strcmpi( profile, profiles[i].name ) )
+            {
+                m_profile = profiles[i].name;
 
+                for( int j = 0; j < COUNT; j++ )
+                {
+                    m_values[j] = profiles[i].values[j];
+                }
+                return true;
+            }
+        }
 
-  /// Returns true, if an unhandled error is pending
-  bool errPending()
-  {
-      return m_lasterr.isPending();
-  }
+        return false;
+    }
 
+    /**
+     * \brief Set a single setting
+     *
+     * \param[in] key Setting name (see name())
+     * \param[in] value New value, a number or keyword
+     * \returns false, if the setting is unknown or \p value isn't a plain number or keyword
+     */
+    bool set( const char* key, const string& value )
+    {
+        int index = find( key );
 
-  /// Get the filename of current database
-  const char* getDbFilename( const char* database )
-  {
-      if( !isOpen() )
-      {
-          assert( false );
-          return NULL;
-      }
+        if( index < 0 || value.empty() )
+        {
+            return false;
+        }
 
-      return sqlite3_db_filename( m_db, database ? database : "MAIN" );
-  }
+        // values are inserted into the PRAGMA statement, so only plain words are accepted
+        for( size_t i = 0; i < value.size(); i++ )
+        {
+            if( !isalnum( (unsigned char)value[i] ) && value[i] != '_' && !( i == 0 && value[i] == '-' ) )
+            {
+                return false;
+            }
+        }
 
+        m_values[index] = value;
 
-  /// Sets the busy timemout in milliseconds
-  bool setBusyTimeout( int iTimeoutValue )
-  {
-      if( !isOpen() )
-      {
-          assert( false );
-          return false;
-      }
-      
-      int rc = sqlite3_busy_timeout( m_db, iTimeoutValue );
-      if( SQLITE_OK != rc )
-      {
-          setSqlError( rc );
-          return false;
-      }
-      return true;
-  }
-  
-  
-  /// Returns the busy timeout in milliseconds
-  bool getBusyTimeout( int& iTimeoutValue )
-  {
-      if( !isOpen() )
-      {
-          assert( false );
-          return false;
-      }
-      
-      int rc = sqlite3_busy_timeout( m_db, iTimeoutValue );
-      if( SQLITE_OK != rc )
-      {
-          setSqlError( rc );
-          return false;
-      }
-      return true;
-  }
-  
+        return true;
+    }
 
-  /// Enable or disable load extensions
-  bool setEnableLoadExtension( int flagOnOff )
-  {
-      if( !isOpen() )
-      {
-          assert( false );
-          return false;
-      }
-      
-      int rc = sqlite3_enable_load_extension( m_db, flagOnOff != 0 );
-      if( SQLITE_OK != rc )
-      {
-          setSqlError( rc );
-          return false;
-      }
-      return true;
-  }
-  
-  
-  /// Closing current statement
-  void closeStmt()
-  {
-      if( m_stmt )
-      {
-          // sqlite3_reset() does not reset the bindings on a prepared statement!
-          sqlite3_clear_bindings( m_stmt );
-          sqlite3_reset( m_stmt );
-          sqlite3_finalize( m_stmt );
-          m_stmt = NULL;
-          m_command = NULL;
-      }
-  }
-  
-  
-  /// Wrapper for SQL function
-  static 
-  void mexFcnWrapper_FCN( sqlite3_context *ctx, int argc, sqlite3_value **argv )
-  {
-      mexFcnWrapper( ctx, argc, argv, MexFunctors::FCN );
-  }
-  
-  /// Wrapper for SQL step function (aggregation)
-  static 
-  void mexFcnWrapper_STEP( sqlite3_context *ctx, int argc, sqlite3_value **argv )
-  {
-      mexFcnWrapper( ctx, argc, argv, MexFunctors::STEP );
-  }
-  
-  /// Wrapper for SQL final function (aggregation)
-  static 
-  void mexFcnWrapper_FINAL( sqlite3_context *ctx )
-  {
-      mexFcnWrapper( ctx, 0, NULL, MexFunctors::FINAL );
-  }
-  
-  /// Common wrapper for all user defined SQL functions
-  static
-  void mexFcnWrapper( sqlite3_context *ctx, int argc, sqlite3_value **argv, int func_nr )
-  {
-      MexFunctors* fcn = (MexFunctors*)sqlite3_user_data( ctx );
-      int nArgs = argc + 1 + (func_nr > MexFunctors::FCN);  // Number of arguments for "feval"
-      ValueMex arg( ValueMex::CreateCellMatrix( 1, nArgs ) );
-      bool failed = false;
+    /**
+     * \brief Apply the settings to a database connection
+     *
+     * \param[in] db Database connection
+     * \param[in] first Index of the first setting to apply: FIRST_READONLY omits the
+     *            settings of the database file (page size, journal mode), FIRST_READER 
+     *            the locking mode and synchronous as well
+     * \returns SQLITE_OK, or the SQLite error code of the failed PRAGMA
+     */
+    int apply( sqlite3* db, int first = 0 )
+    {
+        m_applied.clear();
 
-      assert( fcn && arg.Item() );
-      
-      if( !fcn->checkFunc(func_nr) )
-      {
-          arg.Destroy();
-          sqlite3_result_error( ctx, ::getLocaleMsg( MSG_INVALIDFUNCTION ), -1 );
-          failed = true;
-      }
+        for( int i = first; i < COUNT; i++ )
+        {
+            if( m_values[i].empty() )
+            {
+                continue;
+            }
 
-      if( fcn->m_busy )
-      {
-          arg.Destroy();
-          sqlite3_result_error( ctx, ::getLocaleMsg( MSG_RECURSIVECALL ), -1 );
-          failed = true;
-      }
+            string          sql  = string( "PRAGMA " ) + name( i ) + "=" + m_values[i];
+            sqlite3_stmt*   stmt = NULL;
+            int             rc   = sqlite3_exec( db, sql.c_str(), NULL, NULL, NULL );
 
-      // Transform SQL value arguments into a MATLAB cell array
-      for( int j = 0; j < nArgs && !failed; j++ )
-      {
-          int err_id = MSG_NOERROR;
-          int i = j;
-          ValueSQL value;
-          ValueMex item;
-          
-          if( j == 0 )
-          {
-              arg.SetCell( j, fcn->dupFunc(func_nr).Detach() );
-              continue;
-          }
-          i--;
+            if( SQLITE_OK != rc )
+            {
+                return rc;
+            }
 
-          if( func_nr > MexFunctors::FCN )
-          {
-              if( j == 1 )
-              {
-                  assert( fcn->getData().Item() );
-                  arg.SetCell( j, fcn->getData().Duplicate().Detach() );
-                  continue;
-              }
-              i--;
-          }
+            // read back, SQLite may refuse a setting silently (i.e. WAL for in-memory databases)
+            sql = string( "PRAGMA " ) + name( i );
+            rc  = sqlite3_prepare_v2( db, sql.c_str(), -1, &stmt, NULL );
 
-          switch( sqlite3_value_type( argv[i] ) )
-          {
-              case SQLITE_NULL:
-                  break;
+            if( SQLITE_OK == rc && SQLITE_ROW == sqlite3_step( stmt ) )
+            {
+                const char* value = (const char*)sqlite3_column_text( stmt, 0 );
+                m_applied.push_back( Option( name( i ), value ? value : "" ) );
+            }
 
-              case SQLITE_INTEGER:   
-                  value = ValueSQL( sqlite3_value_int64( argv[i] ) );
-                  break;
+            sqlite3_finalize( stmt );
 
-              case SQLITE_FLOAT:
-                  value = ValueSQL( sqlite3_value_double( argv[i] ) );
-                  break;
+            if( SQLITE_OK != rc )
+            {
+                return rc;
+            }
+        }
 
-              case SQLITE_TEXT:
-              {
-                  char* str = (char*)utils_strnewdup( (const char*)sqlite3_value_text( argv[i] ), g_convertUTF8 );
+        return SQLITE_OK;
+    }
+};
 
-                  if( str )
-                  {
-                      value = ValueSQL( str );
-                      break;
-                  }
-              }
 
-              case SQLITE_BLOB:      
-              {
-                  size_t bytes = sqlite3_value_bytes( argv[i] );
+/// Class holding an exception array, the function map and the handle for one database
+class SQLstackitem
+{
+    typedef map<string, MexFunctors*> MexFunctorsMap;   ///< Dictionary: function name => function handles
+public:
+    typedef map<int, SQLhandle> SQLhandleMap;           ///< Dictionary: handle => prepared statement
+    typedef map<int, sqlite3_blob*> SQLblobMap;         ///< Dictionary: handle => BLOB opened for incremental I/O
+    typedef map<int, SQLticket*> SQLticketMap;          ///< Dictionary: ticket => query running in background
+    typedef vector<SQLstackitem*> SQLreaderList;        ///< Read-only connections to the database file
+private:
 
-                  item = ValueMex( (int)bytes, bytes ? 1 : 0, ValueMex::UINT8_CLASS );
+    sqlite3*        m_db;           ///< SQLite db object
+    MexFunctorsMap  m_fcnmap;       ///< MEX function map with MATLAB functions for application-defined SQL functions
+    ValueMex        m_exception;    ///< MATALAB exception array, may be thrown when mksqlite function leaves
+    SQLstmtCache    m_stmtcache;    ///< Prepared statements for reuse
+    SQLhandleMap    m_handles;      ///< Prepared statements held by handles
+    SQLblobMap      m_blobs;        ///< BLOBs opened for incremental I/O
+    SQLticketMap    m_tickets;      ///< queries running in background
+    SQLbackup*      m_backup;       ///< copy running in background (see 'load_into_memory' and 'backup'), or NULL
+    SQLreaderList   m_readers;      ///< idle read-only connections (reader pool)
+    int             m_readersBusy;  ///< count of read-only connections in use
+    SQLstats        m_stats;        ///< performance counters
+    bool            m_sampling;     ///< collect counters for the slow query log, even if g_stats is off
+    SQLopenOptions  m_openOptions;  ///< settings applied on opening (see 'open')
+    SQLprofile      m_profile;      ///< counters of the statement fetched last
+    double          m_txBatches;    ///< count of committed automatic transactions
+    double          m_txRows;       ///< count of rows committed by automatic transactions
+    double          m_resultBytes;  ///< estimated size of the result buffers of the query fetched last
+    double          m_resultPeak;   ///< largest \a m_resultBytes since opening or reset (see 'memstats')
 
-                  if( item.Data() )
-                  {
-                      if( bytes )
-                      {
-                          memcpy( item.Data(), sqlite3_value_blob( argv[i] ), bytes );
-                      }
+public:
 
-                      value = ValueSQL( item.Detach() );
-                  }
-                  else
-                  {
-                      sqlite3_result_error( ctx, getLocaleMsg( MSG_ERRMEMORY ), -1 );
-                      failed = true;
-                  }
+    /// Ctor
+    SQLstackitem() : m_db( NULL ), m_backup( NULL ), m_readersBusy( 0 ), m_sampling( false ), m_txBatches( 0.0 ), m_txRows( 0.0 ),
+                     m_resultBytes( 0.0 ), m_resultPeak( 0.0 )
+    {}
 
-                  break;
-              }
 
-              default:
-                  sqlite3_result_error( ctx, getLocaleMsg( MSG_UNKNWNDBTYPE ), -1 );
-                  failed = true;
-          }
-          
-          if( failed )
-          {
-              value.Destroy();
-          }
-          else
-          {
-              // Cumulate arguments into a cell array
-              arg.SetCell( j, createItemFromValueSQL( value, err_id ).Detach() );
-              
-              if( MSG_NOERROR != err_id )
-              {
-                  sqlite3_result_error( ctx, ::getLocaleMsg( err_id ), -1 );
-                  failed = true;
-              }
-          }
-      }
-      
-      if( !failed )
-      {
-          ValueMex exception, item;
-          fcn->m_busy = true;
-          arg.Call( &item, &exception );
-          fcn->m_busy = false;
+    /// Dtor
+    ~SQLstackitem()
+    {
+        SQLerror err;
+        closeDb( err );
+    }
 
-          if( !exception.IsEmpty() )
-          {
-              // Exception handling
-              fcn->swapException( exception );
-              sqlite3_result_error( ctx, "MATLAB Exception!", -1 );
-              failed = true;
-          }
-          else
-          {
-              if( func_nr == MexFunctors::STEP )
-              {
-                  if( !item.IsEmpty() )
-                  {
-                      item.MakePersistent();
-                      std::swap( fcn->getData(), item );
-                      item.Destroy();
-                  }
-                  sqlite3_result_null( ctx );
-              }
-              else
-              {
-                  if( !item.IsEmpty() )
-                  {
-                      int iTypeComplexity;
-                      int err_id = MSG_NOERROR;
 
-                      ValueSQL value = createValueSQLFromItem( item, can_serialize(), iTypeComplexity, err_id );
+    /// Return 
+    sqlite3* dbid()
+    {
+        return m_db;
+    }
 
-                      if( MSG_NOERROR != err_id )
-                      {
-                          Err err;
-                          err.set( err_id );
-                          sqlite3_result_error( ctx, err.get(), -1 );
-                      }
-                      else
-                      {
-                          switch( value.m_typeID )
-                          {
-                              case SQLITE_NULL:
-                                  sqlite3_result_null( ctx );
-                                  break;
+    /// Returns the exception array for this database
+    ValueMex& getException()
+    {
+        return m_exception;
+    }
 
-                              case SQLITE_FLOAT:
-                                  // scalar floating point value
-                                  sqlite3_result_double( ctx, item.GetScalar() );
-                                  break;
 
-                              case SQLITE_INTEGER:
-                                  if( (int)item.ClassID() == (int)ValueMex::INT64_CLASS )
-                                  {
-                                      // scalar integer value
-                                      sqlite3_result_int64( ctx, item.GetInt64() );
-                                  }
-                                  else
-                                  {
-                                      // scalar integer value
-                                      sqlite3_result_int( ctx, item.GetInt() );
-                                  }
-                                  break;
+    /// (Re-)Throws an exception, if any occurred
+    void throwOnException()
+    {
+        m_exception.Throw();
+    }
 
-                              case SQLITE_TEXT:
-                                  // string argument
-                                  // SQLite makes a local copy of the text (thru SQLITE_TRANSIENT)
-                                  sqlite3_result_text( ctx, value.m_text, -1, SQLITE_TRANSIENT );
-                                  break;
+  
+    /// Returns the function map for this database
+    MexFunctorsMap& fcnmap()
+    {
+        return m_fcnmap;
+    }
 
-                              case SQLITE_BLOB:
-                                  // SQLite makes a local copy of the blob (thru SQLITE_TRANSIENT)
-                                  sqlite3_result_blob( ctx, item.Data(), 
-                                                       (int)item.ByData(),
-                                                       SQLITE_TRANSIENT );
-                                  break;
 
-                              case SQLITE_BLOBX:
-                                  // sqlite takes custody of the blob, even if sqlite3_bind_blob() fails
-                                  // the sqlite allocator provided blob memory
-                                  sqlite3_result_blob( ctx, value.Detach(), 
-                                                       (int)value.m_blobsize, 
-                                                       sqlite3_free );
-                                  break;
+    /// Returns the prepared statement cache for this database
+    SQLstmtCache& stmtCache()
+    {
+        return m_stmtcache;
+    }
 
-                              default:
-                              {
-                                  // all other (unsuppored types)
-                                  Err err;
-                                  err.set( MSG_INVALIDARG );
-                                  sqlite3_result_error( ctx, err.get(), - 1 );
-                                  break;
-                              }
-                          }
-                      }
-                  }
-                  else
-                  {
-                      sqlite3_result_null( ctx );
-                  }
-              }
-          }
 
-          item.Destroy();
-          exception.Destroy();
-      }
+    /// Returns the prepared statements held by handles for this database
+    SQLhandleMap& handles()
+    {
+        return m_handles;
+    }
 
-      arg.Destroy();
 
-      if( func_nr == MexFunctors::FINAL )
-      {
-          fcn->initGroupData();
-      }
-  }
-  
-  
-  /**
-   * \brief Attach application-defined function to database object
-   */
-  bool attachMexFunction( const char* name, const ValueMex& func, const ValueMex& step, const ValueMex& final, ValueMex& exception )
-  {
-      if( !isOpen() )
-      {
-          assert( false );
-      }
-      else
-      {
-          MexFunctors* fcn = new MexFunctors( exception, func, step, final );
-          int rc = SQLITE_OK;
-          int action = -1;
-          bool failed = false;
-          
-          if( fcn->IsEmpty() )
-          {
-              // Remove function
-              rc = sqlite3_create_function( m_db, name, -1, SQLITE_UTF8, NULL, NULL, NULL, NULL );
-              action = 0;
-          }
-          else
-          {
-              if( !fcn->IsValid() )
-              {
-                  setErr( MSG_FCNHARGEXPCT );
-                  failed = true;
-              }
-              else
-              {
-                  // Add function
-                  void (*xFunc)(sqlite3_context*,int,sqlite3_value**) = mexFcnWrapper_FCN;
-                  void (*xStep)(sqlite3_context*,int,sqlite3_value**) = mexFcnWrapper_STEP;
-                  void (*xFinal)(sqlite3_context*)                    = mexFcnWrapper_FINAL;
+    /// Returns the BLOBs opened for incremental I/O for this database
+    SQLblobMap& blobs()
+    {
+        return m_blobs;
+    }
 
-                  if( fcn->getFunc(MexFunctors::FCN).IsEmpty() )   xFunc  = NULL;
-                  if( fcn->getFunc(MexFunctors::STEP).IsEmpty() )  xStep  = NULL;
-                  if( fcn->getFunc(MexFunctors::FINAL).IsEmpty() ) xFinal = NULL;
 
-                  rc = sqlite3_create_function( m_db, name, -1, SQLITE_UTF8, (void*)fcn, xFunc, xStep, xFinal );
-                  action = 1;
-              }
-          }
-                  
-          if( SQLITE_OK != rc )
-          {
-              setSqlError( rc );
-              failed = true;
-          }
+    /// Returns the settings applied on opening the database
+    SQLopenOptions& openOptions()
+    {
+        return m_openOptions;
+    }
 
-          if( !failed )
-          {
-              if( action >= 0 )
-              {
-                  if( m_pstackitem->fcnmap().count(name) )
-                  {
-#ifndef NDEBUG
-                      PRINTF( "Deleting functors for %s\n", name );
-#endif
-                      delete m_pstackitem->fcnmap()[name];
-                      m_pstackitem->fcnmap().erase(name);
-                  }
-              }
 
-              if( action > 0 )
-              {
-                  m_pstackitem->fcnmap()[name] = fcn;
-                  fcn = NULL;
-              }
-          }
+    /// Returns the performance counters for this database
+    SQLstats& stats()
+    {
+        return m_stats;
+    }
 
-          delete fcn;
 
-          return !errPending();
-      }
-      
-      return true;
-  }
-  
-  
-  /**
-   * \brief Dispatch a SQL query
-   *
-   * \param[in] query String containing SQL statement
-   */
-  bool setQuery( const char* query )
-  {
-      if( !isOpen() )
-      {
-          assert( false );
-          return false;
-      }
+    /// Returns the counters of the statement fetched last for this database
+    SQLprofile& profile()
+    {
+        return m_profile;
+    }
 
-      /*
-       * complete the query
-       */
-      // sqlite3_complete() returns 1 if the string is complete and valid...
-      if( !sqlite3_complete( query ) )
-      {
-          setErr( MSG_INVQUERY );
-          return false;
-      }
 
-      // Close previous statement, if any
-      closeStmt();
-      
-      /*
-       * and prepare it
-       * if anything is wrong with the query, than complain about it.
-       */
-      int rc = sqlite3_prepare_v2( m_db, query, -1, &m_stmt, 0 );
-      if( SQLITE_OK != rc )
-      {
-          setSqlError( rc );
-          return false;
-      }
-      
-      m_command = query;
-      return true;
-  }
-  
-  
-  /// Returns the count of parameters the current statement expects
-  int getParameterCount()
-  {
-      return m_stmt ? sqlite3_bind_parameter_count( m_stmt ) : 0;
-  }
-  
-  /// Returns the name for nth parameter
-  const char* getParameterName( int n )
-  {
-      return m_stmt ? sqlite3_bind_parameter_name( m_stmt, n ) : NULL;
-  }
-  
-  /// kv69: Returns the number of last row id; usefull for inserts in tables with autoincrement primary keys
-  long getLastRowID()
-  {
-      return m_stmt ? (long)sqlite3_last_insert_rowid(m_db) : 0;
-  }
-  
-  
-  /// Clears all parameter bindings from current statement
-  void clearBindings()
-  {
-      if( m_stmt )
-      {
-          sqlite3_clear_bindings( m_stmt );
-      }
-  }
-  
-  
-  /**
-   * \brief Binds one parameter from current statement to a MATLAB array
-   *
-   * \param[in] index Parameter number (0 based)
-   * \param[in] item MATLAB array
-   * \param[in] bStreamable true, if streaming is possible and desired
-   */
-  bool bindParameter( int index, const ValueMex& item, bool bStreamable )
-  {
-      int err_id = MSG_NOERROR;
-      int iTypeComplexity;
-      int rc;
+    /// Returns the performance counters, or NULL if statistics are disabled
+    SQLstats* activeStats()
+    {
+        return ( g_stats || m_sampling ) ? &m_stats : NULL;
+    }
 
-      assert( isOpen() );
 
-      ValueSQL value = createValueSQLFromItem( item, bStreamable, iTypeComplexity, err_id );
+    /// Collect counters even if statistics are disabled (slow query log)
+    void setSampling( bool enable )
+    {
+        m_sampling = enable;
+    }
 
-      if( MSG_NOERROR != err_id )
-      {
-          setErr( err_id );
-          return false;
-      }
 
-      switch( value.m_typeID )
-      {
-          case SQLITE_NULL:
-              rc = sqlite3_bind_null( m_stmt, index );
-              if( SQLITE_OK != rc )
-              {
-                  setSqlError( rc );
-              }
-              break;
+    /// Returns the queries running in background for this database
+    SQLticketMap& tickets()
+    {
+        return m_tickets;
+    }
 
-          case SQLITE_FLOAT:
-              // scalar floating point value
-              rc = sqlite3_bind_double( m_stmt, index, item.GetScalar() );
-              if( SQLITE_OK != rc )
-              {
-                  setSqlError( rc );
-              }
-              break;
 
-          case SQLITE_INTEGER:
-              if( (int)item.ClassID() == (int)ValueMex::INT64_CLASS )
-              {
-                  // scalar integer value
-                  rc = sqlite3_bind_int64( m_stmt, index, item.GetInt64() );
-                  if( SQLITE_OK != rc )
-                  {
-                      setSqlError( rc );
-                  }
-              }
-              else
-              {
-                  // scalar integer value
-                  rc = sqlite3_bind_int( m_stmt, index, item.GetInt() );
-                  if( SQLITE_OK != rc )
-                  {
-                      setSqlError( rc );
-                  }
-              }
-              break;
+    /// Cancel all queries running in background (implemented below class SQLticket)
+    void releaseTickets();
 
-          case SQLITE_TEXT:
-              // string argument
-              // SQLite makes a local copy of the text (thru SQLITE_TRANSIENT)
-              rc = sqlite3_bind_text( m_stmt, index, value.m_text, -1, SQLITE_TRANSIENT );
-              if( SQLITE_OK != rc )
-              {
-                  setSqlError( rc );
-              }
-              break;
 
-          case SQLITE_BLOB:
-              // SQLite makes a local copy of the blob (thru SQLITE_TRANSIENT)
-              rc = sqlite3_bind_blob( m_stmt, index, item.Data(), 
-                                      (int)item.ByData(),
-                                      SQLITE_TRANSIENT );
-              if( SQLITE_OK != rc )
-              {
-                  setSqlError( rc );
-              }
-              break;
+    /// Returns the copy running in background, or NULL
+    SQLbackup* backup()
+    {
+        return m_backup;
+    }
 
-          case SQLITE_BLOBX:
-              // sqlite takes custody of the blob, even if sqlite3_bind_blob() fails
-              // the sqlite allocator provided blob memory
-              rc = sqlite3_bind_blob( m_stmt, index, value.Detach(), 
-                                      (int)value.m_blobsize, 
-                                      sqlite3_free );
-              if( SQLITE_OK != rc )
-              {
-                  setSqlError( rc );
-              }  
-              break;
 
-          default:
-              // all other (unsuppored types)
-              setErr( MSG_INVALIDARG );
-              break;
-      }
-      
-      return !errPending();
-  }
-  
-  
-  /// Evaluates current SQL statement
-  int step()
-  {
-      return m_stmt ? sqlite3_step( m_stmt ) : SQLITE_ERROR;
-  }
-  
-  
-  /// Returns the column count for current statement
-  int colCount()
-  {
-      return m_stmt ? sqlite3_column_count( m_stmt ) : 0;
-  }
-  
-  
-  /**
-   * \brief Returns the (prefered) type of one column for current statement
-   *
-   * \param[in] index Index number of desired column (0 based)
-   * \returns -1 on error
-   */
-  int colType( int index )
-  {
-      return m_stmt ? sqlite3_column_type( m_stmt, index ) : -1;
-  }
-  
-  
-  /// Returns an integer value for least fetch and column number
-  sqlite3_int64 colInt64( int index )
-  {
-      return m_stmt ? sqlite3_column_int64( m_stmt, index ) : 0;
-  }
-  
-  
-  /// Returns a floating point value for least fetch and column number
-  double colFloat( int index )
-  {
-      return m_stmt ? sqlite3_column_double( m_stmt, index ) : 0.0;
-  }
-  
-  
-  /// Returns a text value for least fetch and column number
-  const unsigned char* colText( int index )
-  {
-      return m_stmt ? sqlite3_column_text( m_stmt, index ) : (const unsigned char*)"";
-  }
-  
-  
-  /// Returns a BLOB for least fetch and column number
-  const void* colBlob( int index )
-  {
-      unsigned char* test = (unsigned char*)sqlite3_column_blob( m_stmt, index );
-      return m_stmt ? sqlite3_column_blob( m_stmt, index ) : NULL;
-  }
-  
-  
-  /// Returns the size of one value of least fetch and column number in bytes
-  size_t colBytes( int index )
-  {
-      return m_stmt ? sqlite3_column_bytes( m_stmt, index ) : 0;
-  }
-  
-  
-  /// Returns the column name least fetch and column number 
-  const char* colName( int index )
-  {
-      return m_stmt ? sqlite3_column_name( m_stmt, index ) : "";
-  }
+    /// Cancel the copy running in background (implemented below class SQLbackup)
+    void releaseBackup();
+
+
+    /// Start copying the database into a file in background (implemented below class SQLbackup)
+    bool backupToFile( const char* filename, int pagesPerStep, SQLerror& err );
+
+
+    /// Returns the count of open read-only connections of the reader pool (idle or in use)
+    int readerCount()
+    {
+        return (int)m_readers.size() + m_readersBusy;
+    }
+
+
+    /**
+     * \brief Take a read-only connection from the reader pool
+     *
+     * \param[out] err Error information
+     * \returns Connection, or NULL if the pool is exhausted (\p err isn't set then) or on error
+     *
+     * If there is no idle connection, a new one to the database file is opened,
+     * as long as the pool holds less than g_reader_pool_size connections. 
+     * Connections are opened with SQLITE_OPEN_READONLY|SQLITE_OPEN_NOMUTEX,
+     * so each may be used by one thread at a time only.
+     */
+    SQLstackitem* acquireReader( SQLerror& err )
+    {
+        SQLstackitem* reader = NULL;
+
+        if( !m_readers.empty() )
+        {
+            reader = m_readers.back();
+            m_readers.pop_back();
+        }
+        else if( readerCount() < g_reader_pool_size )
+        {
+            // in-memory and temporary databases can't be shared by a second connection
+            const char* filename = isOpen() ? sqlite3_db_filename( m_db, "main" ) : NULL;
+
+            if( !filename || !*filename )
+            {
+                err.set( MSG_NODBFILE );
+                return NULL;
+            }
+
+            reader = new SQLstackitem;
+
+            if( !reader->openDbUtf8( filename, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, err, /*bMatlabThread*/ false ) )
+            {
+                delete reader;
+                return NULL;
+            }
+
+            sqlite3_busy_timeout( reader->dbid(), MKSQLITE_CONFIG_BUSYTIMEOUT );
+
+            // cache and mmap settings of the database apply to its readers as well
+            reader->m_openOptions = m_openOptions;
+
+            if( SQLITE_OK != reader->m_openOptions.apply( reader->dbid(), SQLopenOptions::FIRST_READER ) )
+            {
+                err.setSqlError( reader->dbid(), -1 );
+                delete reader;
+                return NULL;
+            }
+        }
+
+        if( reader )
+        {
+            m_readersBusy++;
+        }
+
+        return reader;
+    }
+
+
+    /// Return a connection taken by acquireReader() to the reader pool
+    void releaseReader( SQLstackitem* reader )
+    {
+        assert( m_readersBusy > 0 );
+        m_readersBusy--;
+
+        // a ticket may have installed its progress handler
+        sqlite3_progress_handler( reader->dbid(), 0, NULL, NULL );
+
+        if( readerCount() < g_reader_pool_size )
+        {
+            m_readers.push_back( reader );
+        }
+        else
+        {
+            delete reader;
+        }
+    }
+
+
+    /// Close idle read-only connections, until the reader pool holds no more than \p capacity connections
+    void trimReaders( int capacity )
+    {
+        while( !m_readers.empty() && readerCount() > capacity )
+        {
+            delete m_readers.back();
+            m_readers.pop_back();
+        }
+    }
+
+
+    /// Close all BLOBs opened for incremental I/O
+    void releaseBlobs()
+    {
+        for( SQLblobMap::iterator it = m_blobs.begin(); it != m_blobs.end(); it++ )
+        {
+            sqlite3_blob_close( it->second );
+        }
+        m_blobs.clear();
+    }
+
+
+    /// Count a committed automatic transaction of \p rows rows
+    void countAutoTransaction( int rows )
+    {
+        m_txBatches++;
+        m_txRows += rows;
+    }
+
+
+    /// Returns the count of committed automatic transactions
+    double autoTransactionBatches()
+    {
+        return m_txBatches;
+    }
+
+
+    /// Returns the count of rows committed by automatic transactions
+    double autoTransactionRows()
+    {
+        return m_txRows;
+    }
+
+
+    /// Start accounting the result buffers of a new query
+    void beginResult()
+    {
+        m_resultBytes = 0.0;
+    }
+
+
+    /**
+     * \brief Account memory to the result buffers of current query
+     *
+     * \param[in] bytes Estimated size of fetched values
+     * \returns false, if the result buffers exceed g_result_memory_cap
+     */
+    bool addResultBytes( double bytes )
+    {
+        m_resultBytes += bytes;
+
+        if( m_resultBytes > m_resultPeak )
+        {
+            m_resultPeak = m_resultBytes;
+        }
+
+        return !( g_result_memory_cap > 0.0 && m_resultBytes > g_result_memory_cap );
+    }
+
+
+    /// Returns the estimated size of the result buffers of the query fetched last
+    double resultBytes()
+    {
+        return m_resultBytes;
+    }
+
+
+    /// Returns the largest size of result buffers since opening or the last reset
+    double resultPeak()
+    {
+        return m_resultPeak;
+    }
+
+
+    /// Clear the high-water mark of the result buffers
+    void resetResultPeak()
+    {
+        m_resultPeak = m_resultBytes;
+    }
+
+
+    /// Returns a new handle number, unique over all databases
+    static
+    int newHandle()
+    {
+        static int last_handle = 0;
+        return ++last_handle;
+    }
+
+
+    /// Release all prepared statements held by handles (implemented below class SQLiface)
+    void releaseHandles();
+
+
+    /// Progress handler (watchdog)
+    static
+    int progressHandler( void* data )
+    {
+        // Ctrl+C pressed?
+        if( utIsInterruptPending() )
+        {
+            utSetInterruptHandled( true );
+            PRINTF( "%s\n", ::getLocaleMsg( MSG_ABORTED ) );
+            return 1;
+        }
+        return 0;
+    }
+
+
+    /// Installing progress handler to enable aborting by Ctrl+C
+    void setProgressHandler( bool enable = true )
+    {
+        const int N_INSTRUCTIONS = 1000;
+        sqlite3_progress_handler( m_db, enable ? N_INSTRUCTIONS : 0, &SQLstackitem::progressHandler, NULL );
+    }
+
+
+    /**
+     * \brief Opens (or create) database
+     *
+     * \param[in] filename Name of database file
+     * \param[in] openFlags Flags for access rights (see SQLite documentation for sqlite3_open_v2())
+     * \param[out] err Error information
+     * \param[in] bMatlabThread If false, the database will be used by a worker thread (see openDbUtf8())
+     * \returns true if succeeded
+     */
+    bool openDb( const char* filename, int openFlags, SQLerror& err, bool bMatlabThread = true )
+    {
+        if( !closeDb( err ) )
+        {
+            return false;
+        }
+        
+        /*
+         * Open the database
+         * m_db is assigned by sqlite3_open_v2(), even if an error
+         * occures
+         */
+        unsigned char* filename_utf8 = NULL;
+
+        if( filename )
+        {
+            // each character takes 2 bytes at most, so one pass converts the name
+            size_t len = strlen( filename );
+
+            filename_utf8 = (unsigned char*)MEM_ALLOC( 2 * len + 1, sizeof(char) );
+
+            if( !filename_utf8 )
+            {
+                err.set( MSG_ERRMEMORY );
+            }
+            else
+            {
+                utils_latin2utf_n( (const unsigned char*)filename, len, filename_utf8 );
+            }
+        }
+
+        if( filename_utf8 && !err.isPending() )
+        {
+            (void)openDbUtf8( (char*)filename_utf8, openFlags, err, bMatlabThread );
+        }
+
+        MEM_FREE( filename_utf8 );
+
+        return !err.isPending();
+    }
+
+
+    /**
+     * \brief Opens an in-memory database and loads a database file into it
+     *
+     * \param[in] filename Name of database file
+     * \param[in] pagesPerStep Count of pages copied at once, or negative to copy all at once
+     * \param[out] err Error information
+     * \returns true if succeeded
+     *
+     * Returns at once, the pages are copied by a worker thread (implemented
+     * below class SQLbackup).
+     */
+    bool loadIntoMemory( const char* filename, int pagesPerStep, SQLerror& err );
+
+
+    /**
+     * \brief Opens (or create) database by its UTF-8 encoded name
+     *
+     * \param[in] filename_utf8 Name of database file (UTF-8)
+     * \param[in] openFlags Flags for access rights (see SQLite documentation for sqlite3_open_v2())
+     * \param[out] err Error information
+     * \param[in] bMatlabThread If false, the database will be used by a worker thread. 
+     *            Builtin functions and the Ctrl+C handler are omitted then, since 
+     *            they need the MATLAB API.
+     * \returns true if succeeded
+     */
+    bool openDbUtf8( const char* filename_utf8, int openFlags, SQLerror& err, bool bMatlabThread = true )
+    {
+        if( !closeDb( err ) )
+        {
+            return false;
+        }
+        
+        m_stats.reset();
+        m_profile.reset();
+        m_resultBytes = m_resultPeak = 0.0;
+        m_openOptions = SQLopenOptions();
+
+        int rc = sqlite3_open_v2( filename_utf8, &m_db, openFlags, NULL );
+
+        if( SQLITE_OK != rc )
+        {
+            err.setSqlError( m_db, -1 );
+        }
+
+        sqlite3_extended_result_codes( m_db, true );
+
+        if( bMatlabThread )
+        {
+            attachBuiltinFunctions();
+            utSetInterruptEnabled( true );
+            setProgressHandler( true );
+        }
+
+        return !err.isPending();
+    }
+
+
+    /// Close database
+    bool closeDb( SQLerror& err )
+    {
+        // Deallocate functors
+        for( MexFunctorsMap::iterator it = m_fcnmap.begin(); it != m_fcnmap.end(); it++ )
+        {
+            delete it->second;
+        }
+        m_fcnmap.clear();
+
+        // Statements held by handles or cached and open BLOBs would prevent the database from being closed
+        releaseBackup();
+        releaseTickets();
+        trimReaders( 0 );
+        releaseBlobs();
+        releaseHandles();
+        m_stmtcache.flush();
+        m_stmtcache.resetCounters();
+
+        // m_db may be NULL, since sqlite3_close with a NULL argument is a harmless no-op
+        int rc = sqlite3_close( m_db );
+        if( SQLITE_OK == rc )
+        {
+            m_db = NULL;
+        }
+        else
+        {
+            PRINTF( "%s\n", ::getLocaleMsg( MSG_ERRCANTCLOSE ) );
+            err.setSqlError( m_db, -1 ); /* not SQL_ERR_CLOSE */
+        }
+        
+        return !isOpen();
+    }
+
+
+    /// Returns true, if database is opened
+    bool isOpen()
+    {
+        return NULL != m_db;
+    }
+    
+
+    /**
+     * \brief Attach builtin functions to database object
+     *
+     * Following builtin functions are involved:
+     * - pow
+     * - regex
+     * - bcdratio
+     * - bdcpacktime
+     * - bdcunpacktime
+     * - md5
+     */
+    void attachBuiltinFunctions()
+    {
+        if( !isOpen() )
+        {
+            assert( false );
+        }
+        else
+        {
+            // attach new SQL commands to opened database
+            sqlite3_create_function( m_db, "lg", 1, SQLITE_UTF8, NULL, lg_func, NULL, NULL );                         // power function (math)
+            sqlite3_create_function( m_db, "regex", 2, SQLITE_UTF8, NULL, regex_func, NULL, NULL );                   // regular expressions (MATCH mode)
+            sqlite3_create_function( m_db, "regex", 3, SQLITE_UTF8, NULL, regex_func, NULL, NULL );                   // regular expressions (REPLACE mode)
+            sqlite3_create_function( m_db, "bdcratio", 1, SQLITE_UTF8, NULL, BDC_ratio_func, NULL, NULL );            // compression ratio (blob data compression)
+            sqlite3_create_function( m_db, "bdcpacktime", 1, SQLITE_UTF8, NULL, BDC_pack_time_func, NULL, NULL );     // compression time (blob data compression)
+            sqlite3_create_function( m_db, "bdcunpacktime", 1, SQLITE_UTF8, NULL, BDC_unpack_time_func, NULL, NULL ); // decompression time (blob data compression)
+            sqlite3_create_function( m_db, "md5", 1, SQLITE_UTF8, NULL, MD5_func, NULL, NULL );                       // Message-Digest (RSA)
+#ifndef SQLITE_ENABLE_MATH_FUNCTIONS
+            sqlite3_create_function( m_db, "ceil", 1, SQLITE_UTF8, NULL, ceil_func, NULL, NULL );                     // ceil function (math)
+            sqlite3_create_function( m_db, "floor", 1, SQLITE_UTF8, NULL, floor_func, NULL, NULL );                   // floor function (math)
+            sqlite3_create_function( m_db, "pow", 2, SQLITE_UTF8, NULL, pow_func, NULL, NULL );                       // power function (math)
+            sqlite3_create_function( m_db, "exp", 1, SQLITE_UTF8, NULL, exp_func, NULL, NULL );                       // power function (math)
+            sqlite3_create_function( m_db, "ln", 1, SQLITE_UTF8, NULL, ln_func, NULL, NULL );                         // power function (math)
+#endif
+            
+#if MKSQLITE_CONFIG_USE_UUID
+            // uuid.c (sqlite.org)
+            sqlite3_uuid_init( m_db );
+#endif
+        }
+    }
+};
+
+
+
+
+
+
+/**
+ * \brief SQLite interface
+ *
+ * Encapsulates one sqlite object with pending command and statement.
+ */
+class SQLiface
+{
+    SQLstackitem*   m_pstackitem;   ///< pointer to current database
+    sqlite3*        m_db;           ///< SQLite db handle
+    const char*     m_command;      ///< SQL query (no ownership, read-only!)
+    sqlite3_stmt*   m_stmt;         ///< SQL statement (sqlite bridge)
+    SQLcolNames     m_colNames;     ///< field names of the result columns of \a m_stmt
+    SQLerror        m_lasterr;      ///< recent error message
+          
+public:
+  friend class SQLerror;
+
+  /// Standard ctor
+  SQLiface( SQLstackitem& stackitem ) :
+    m_pstackitem( &stackitem ),
+    m_db( stackitem.dbid() ),
+    m_command( NULL ),
+    m_stmt( NULL )
+  {
+      // Multiple calls of sqlite3_initialize() are harmless no-ops
+      sqlite3_initialize();
+  }
+    
+  
+  /// Dtor
+  ~SQLiface()
+  {
+      closeStmt();
+  }
+
+
+  /// Returns true, if database is open
+  bool isOpen()
+  {
+      return NULL != m_db;
+  }
+
+
+  /// Clear recent error message
+  void clearErr()
+  {
+      m_lasterr.clear();
+  }
+  
+
+  /// Get recent error message
+  const char* getErr( const char** errid = NULL )
+  {   
+      return m_lasterr.get( errid );
+  }
+
+
+  /// Sets an error by its ID (see \ref MSG_IDS)
+  void setErr( int err_id )
+  {
+      m_lasterr.set( err_id );
+  }
+
+
+  /// Sets an error by its SQL return code
+  void setSqlError( int rc )
+  {
+      m_lasterr.setSqlError( m_db, rc );
+  }
+
+
+  /// Returns true, if an unhandled error is pending
+  bool errPending()
+  {
+      return m_lasterr.isPending();
+  }
+
+
+  /// Get the filename of current database
+  const char* getDbFilename( const char* database )
+  {
+      if( !isOpen() )
+      {
+          assert( false );
+          return NULL;
+      }
+
+      return sqlite3_db_filename( m_db, database ? database : "MAIN" );
+  }
+
+
+  /// Sets the busy timemout in milliseconds
+  bool setBusyTimeout( int iTimeoutValue )
+  {
+      if( !isOpen() )
+      {
+          assert( false );
+          return false;
+      }
+      
+      int rc = sqlite3_busy_timeout( m_db, iTimeoutValue );
+      if( SQLITE_OK != rc )
+      {
+          setSqlError( rc );
+          return false;
+      }
+      return true;
+  }
+  
+  
+  /// Returns the busy timeout in milliseconds
+  bool getBusyTimeout( int& iTimeoutValue )
+  {
+      if( !isOpen() )
+      {
+          assert( false );
+          return false;
+      }
+      
+      int rc = sqlite3_busy_timeout( m_db, iTimeoutValue );
+      if( SQLITE_OK != rc )
+      {
+          setSqlError( rc );
+          return false;
+      }
+      return true;
+  }
+  
+
+  /// Enable or disable load extensions
+  bool setEnableLoadExtension( int flagOnOff )
+  {
+      if( !isOpen() )
+      {
+          assert( false );
+          return false;
+      }
+      
+      int rc = sqlite3_enable_load_extension( m_db, flagOnOff != 0 );
+      if( SQLITE_OK != rc )
+      {
+          setSqlError( rc );
+          return false;
+      }
+      return true;
+  }
+  
+  
+  /// Closing current statement
+  void closeStmt()
+  {
+      if( m_stmt )
+      {
+          finalize();
+          m_command = NULL;
+      }
+  }
+  
+  
+  /// Wrapper for SQL function
+  static 
+  void mexFcnWrapper_FCN( sqlite3_context *ctx, int argc, sqlite3_value **argv )
+  {
+      mexFcnWrapper( ctx, argc, argv, MexFunctors::FCN );
+  }
+  
+  /// Wrapper for SQL step function (aggregation)
+  static 
+  void mexFcnWrapper_STEP( sqlite3_context *ctx, int argc, sqlite3_value **argv )
+  {
+      mexFcnWrapper( ctx, argc, argv, MexFunctors::STEP );
+  }
+  
+  /// Wrapper for SQL final function (aggregation)
+  static 
+  void mexFcnWrapper_FINAL( sqlite3_context *ctx )
+  {
+      mexFcnWrapper( ctx, 0, NULL, MexFunctors::FINAL );
+  }
+  
+  /// Common wrapper for all user defined SQL functions
+  static
+  void mexFcnWrapper( sqlite3_context *ctx, int argc, sqlite3_value **argv, int func_nr )
+  {
+      MexFunctors* fcn = (MexFunctors*)sqlite3_user_data( ctx );
+      int nArgs = argc + 1 + (func_nr > MexFunctors::FCN);  // Number of arguments for "feval"
+      ValueMex arg( ValueMex::CreateCellMatrix( 1, nArgs ) );
+      bool failed = false;
+
+      assert( fcn && arg.Item() );
+      
+      if( !fcn->checkFunc(func_nr) )
+      {
+          arg.Destroy();
+          sqlite3_result_error( ctx, ::getLocaleMsg( MSG_INVALIDFUNCTION ), -1 );
+          failed = true;
+      }
+
+      if( fcn->m_busy )
+      {
+          arg.Destroy();
+          sqlite3_result_error( ctx, ::getLocaleMsg( MSG_RECURSIVECALL ), -1 );
+          failed = true;
+      }
+
+      // Transform SQL value arguments into a MATLAB cell array
+      for( int j = 0; j < nArgs && !failed; j++ )
+      {
+          int err_id = MSG_NOERROR;
+          int i = j;
+          ValueSQL value;
+          ValueMex item;
+          
+          if( j == 0 )
+          {
+              arg.SetCell( j, fcn->dupFunc(func_nr).Detach() );
+              continue;
+          }
+          i--;
+
+          if( func_nr > MexFunctors::FCN )
+          {
+              if( j == 1 )
+              {
+                  assert( fcn->getData().Item() );
+                  arg.SetCell( j, fcn->getData().Duplicate().Detach() );
+                  continue;
+              }
+              i--;
+          }
+
+          switch( sqlite3_value_type( argv[i] ) )
+          {
+              case SQLITE_NULL:
+                  break;
+
+              case SQLITE_INTEGER:   
+                  value = ValueSQL( sqlite3_value_int64( argv[i] ) );
+                  break;
+
+              case SQLITE_FLOAT:
+                  value = ValueSQL( sqlite3_value_double( argv[i] ) );
+                  break;
+
+              case SQLITE_TEXT:
+              {
+                  char* str = (char*)utils_strnewdup( (const char*)sqlite3_value_text( argv[i] ), g_convertUTF8 );
+
+                  if( str )
+                  {
+                      value = ValueSQL( str );
+                      break;
+                  }
+              }
+
+              case SQLITE_BLOB:      
+              {
+                  size_t bytes = sqlite3_value_bytes( argv[i] );
+
+                  item = ValueMex( (int)bytes, bytes ? 1 : 0, ValueMex::UINT8_CLASS );
+
+                  if( item.Data() )
+                  {
+                      if( bytes )
+                      {
+                          memcpy( item.Data(), sqlite3_value_blob( argv[i] ), bytes );
+                      }
+
+                      value = ValueSQL( item.Detach() );
+                  }
+                  else
+                  {
+                      sqlite3_result_error( ctx, getLocaleMsg( MSG_ERRMEMORY ), -1 );
+                      failed = true;
+                  }
+
+                  break;
+              }
+
+              default:
+                  sqlite3_result_error( ctx, getLocaleMsg( MSG_UNKNWNDBTYPE ), -1 );
+                  failed = true;
+          }
+          
+          if( failed )
+          {
+              value.Destroy();
+          }
+          else
+          {
+              // Cumulate arguments into a cell array
+              arg.SetCell( j, createItemFromValueSQL( value, err_id ).Detach() );
+              
+              if( MSG_NOERROR != err_id )
+              {
+                  sqlite3_result_error( ctx, ::getLocaleMsg( err_id ), -1 );
+                  failed = true;
+              }
+          }
+      }
+      
+      if( !failed )
+      {
+          ValueMex exception, item;
+          fcn->m_busy = true;
+          arg.Call( &item, &exception );
+          fcn->m_busy = false;
+
+          if( !exception.IsEmpty() )
+          {
+              // Exception handling
+              fcn->swapException( exception );
+              sqlite3_result_error( ctx, "MATLAB Exception!", -1 );
+              failed = true;
+          }
+          else
+          {
+              if( func_nr == MexFunctors::STEP )
+              {
+                  if( !item.IsEmpty() )
+                  {
+                      item.MakePersistent();
+                      std::swap( fcn->getData(), item );
+                      item.Destroy();
+                  }
+                  sqlite3_result_null( ctx );
+              }
+              else
+              {
+                  if( !item.IsEmpty() )
+                  {
+                      int iTypeComplexity;
+                      int err_id = MSG_NOERROR;
+
+                      ValueSQL value = createValueSQLFromItem( item, can_serialize(), iTypeComplexity, err_id );
+
+                      if( MSG_NOERROR != err_id )
+                      {
+                          Err err;
+                          err.set( err_id );
+                          sqlite3_result_error( ctx, err.get(), -1 );
+                      }
+                      else
+                      {
+                          switch( value.m_typeID )
+                          {
+                              case SQLITE_NULL:
+                                  sqlite3_result_null( ctx );
+                                  break;
+
+                              case SQLITE_FLOAT:
+                                  // scalar floating point value
+                                  sqlite3_result_double( ctx, item.GetScalar() );
+                                  break;
+
+                              case SQLITE_INTEGER:
+                                  if( (int)item.ClassID() == (int)ValueMex::INT64_CLASS )
+                                  {
+                                      // scalar integer value
+                                      sqlite3_result_int64( ctx, item.GetInt64() );
+                                  }
+                                  else
+                                  {
+                                      // scalar integer value
+                                      sqlite3_result_int( ctx, item.GetInt() );
+                                  }
+                                  break;
+
+                              case SQLITE_TEXT:
+                                  // string argument
+                                  // SQLite makes a local copy of the text (thru SQLITE_TRANSIENT)
+                                  sqlite3_result_text( ctx, value.m_text, -1, SQLITE_TRANSIENT );
+                                  break;
+
+                              case SQLITE_BLOB:
+                                  // SQLite makes a local copy of the blob (thru SQLITE_TRANSIENT)
+                                  sqlite3_result_blob( ctx, item.Data(), 
+                                                       (int)item.ByData(),
+                                                       SQLITE_TRANSIENT );
+                                  break;
+
+                              case SQLITE_BLOBX:
+                                  // sqlite takes custody of the blob, even if sqlite3_bind_blob() fails
+                                  // the sqlite allocator provided blob memory
+                                  sqlite3_result_blob( ctx, value.Detach(), 
+                                                       (int)value.m_blobsize, 
+                                                       sqlite3_free );
+                                  break;
+
+                              default:
+                              {
+                                  // all other (unsuppored types)
+                                  Err err;
+                                  err.set( MSG_INVALIDARG );
+                                  sqlite3_result_error( ctx, err.get(), - 1 );
+                                  break;
+                              }
+                          }
+                      }
+                  }
+                  else
+                  {
+                      sqlite3_result_null( ctx );
+                  }
+              }
+          }
+
+          item.Destroy();
+          exception.Destroy();
+      }
+
+      arg.Destroy();
+
+      if( func_nr == MexFunctors::FINAL )
+      {
+          fcn->initGroupData();
+      }
+  }
+  
+  
+  /**
+   * \brief Attach application-defined function to database object
+   */
+  bool attachMexFunction( const char* name, const ValueMex& func, const ValueMex& step, const ValueMex& final, ValueMex& exception )
+  {
+      if( !isOpen() )
+      {
+          assert( false );
+      }
+      else
+      {
+          MexFunctors* fcn = new MexFunctors( exception, func, step, final );
+          int rc = SQLITE_OK;
+          int action = -1;
+          bool failed = false;
+          
+          if( fcn->IsEmpty() )
+          {
+              // Remove function
+              rc = sqlite3_create_function( m_db, name, -1, SQLITE_UTF8, NULL, NULL, NULL, NULL );
+              action = 0;
+          }
+          else
+          {
+              if( !fcn->IsValid() )
+              {
+                  setErr( MSG_FCNHARGEXPCT );
+                  failed = true;
+              }
+              else
+              {
+                  // Add function
+                  void (*xFunc)(sqlite3_context*,int,sqlite3_value**) = mexFcnWrapper_FCN;
+                  void (*xStep)(sqlite3_context*,int,sqlite3_value**) = mexFcnWrapper_STEP;
+                  void (*xFinal)(sqlite3_context*)                    = mexFcnWrapper_FINAL;
+
+                  if( fcn->getFunc(MexFunctors::FCN).IsEmpty() )   xFunc  = NULL;
+                  if( fcn->getFunc(MexFunctors::STEP).IsEmpty() )  xStep  = NULL;
+                  if( fcn->getFunc(MexFunctors::FINAL).IsEmpty() ) xFinal = NULL;
+
+                  rc = sqlite3_create_function( m_db, name, -1, SQLITE_UTF8, (void*)fcn, xFunc, xStep, xFinal );
+                  action = 1;
+              }
+          }
+                  
+          if( SQLITE_OK != rc )
+          {
+              setSqlError( rc );
+              failed = true;
+          }
+
+          if( !failed )
+          {
+              if( action >= 0 )
+              {
+                  if( m_pstackitem->fcnmap().count(name) )
+                  {
+#ifndef NDEBUG
+                      PRINTF( "Deleting functors for %s\n", name );
+#endif
+                      delete m_pstackitem->fcnmap()[name];
+                      m_pstackitem->fcnmap().erase(name);
+                  }
+              }
+
+              if( action > 0 )
+              {
+                  m_pstackitem->fcnmap()[name] = fcn;
+                  fcn = NULL;
+              }
+          }
+
+          delete fcn;
+
+          return !errPending();
+      }
+      
+      return true;
+  }
+  
+  
+  /**
+   * \brief Dispatch a SQL query
+   *
+   * \param[in] query String containing SQL statement
+   */
+  bool setQuery( const char* query )
+  {
+      if( !isOpen() )
+      {
+          assert( false );
+          return false;
+      }
+
+      // Close previous statement, if any
+      closeStmt();
+
+      // Reuse a statement prepared earlier from the same SQL text
+      if( g_stmt_cache_size > 0 )
+      {
+          m_stmt = m_pstackitem->stmtCache().take( query, m_colNames );
+
+          if( m_stmt )
+          {
+              m_command = query;
+              return true;
+          }
+      }
+
+      /*
+       * complete the query
+       */
+      // sqlite3_complete() returns 1 if the string is complete and valid...
+      if( !sqlite3_complete( query ) )
+      {
+          setErr( MSG_INVQUERY );
+          return false;
+      }
+
+      /*
+       * and prepare it
+       * if anything is wrong with the query, than complain about it.
+       */
+      SQLstats* stats = m_pstackitem->activeStats();
+      SQLstats::Timer timer( stats ? &stats->m_prepare_time : NULL );
+
+      m_colNames.clear();
+
+      int rc = sqlite3_prepare_v2( m_db, query, -1, &m_stmt, 0 );
+      timer.stop();
+      if( SQLITE_OK != rc )
+      {
+          setSqlError( rc );
+          return false;
+      }
+
+      m_command = query;
+      return true;
+  }
+  
+  
+  /// Returns the count of parameters the current statement expects
+  int getParameterCount()
+  {
+      return m_stmt ? sqlite3_bind_parameter_count( m_stmt ) : 0;
+  }
+  
+  /// Returns the name for nth parameter
+  const char* getParameterName( int n )
+  {
+      return m_stmt ? sqlite3_bind_parameter_name( m_stmt, n ) : NULL;
+  }
+  
+  /// kv69: Returns the number of last row id; usefull for inserts in tables with autoincrement primary keys
+  long getLastRowID()
+  {
+      return m_stmt ? (long)sqlite3_last_insert_rowid(m_db) : 0;
+  }
+  
+  
+  /// Clears all parameter bindings from current statement
+  void clearBindings()
+  {
+      if( m_stmt )
+      {
+          sqlite3_clear_bindings( m_stmt );
+      }
+  }
+  
+  
+  /// Returns true, if no transaction is open (autocommit mode)
+  bool isAutoCommit()
+  {
+      return m_db && sqlite3_get_autocommit( m_db );
+  }
+  
+  
+  /**
+   * \brief Executes SQL statements without results (transaction control f.e.)
+   *
+   * \param[in] query SQL statements (UTF-8)
+   * \returns true on success
+   *
+   * The current statement is not affected.
+   */
+  bool execute( const char* query )
+  {
+      assert( isOpen() );
+
+      int rc = sqlite3_exec( m_db, query, NULL, NULL, NULL );
+
+      if( SQLITE_OK != rc )
+      {
+          setSqlError( rc );
+      }
+
+      // an error of the statement stepped before may still be pending
+      return SQLITE_OK == rc;
+  }
+  
+  
+  /// Destructor for texts handed over to SQLite by bindParameter()
+  static void freeBoundText( void* ptr )
+  {
+      MEM_FREE( ptr );
+  }
+  
+  
+  /**
+   * \brief Binds one parameter from current statement to a MATLAB array
+   *
+   * \param[in] index Parameter number (0 based)
+   * \param[in] item MATLAB array
+   * \param[in] bStreamable true, if streaming is possible and desired
+   * \param[in] bStatic true, if \p item outlives the binding
+   * \param[in] pJob compression job of \p item, already run (optional)
+   *
+   * With \p bStatic set, BLOBs are bound by reference to the MATLAB array
+   * (SQLITE_STATIC) and SQLite takes custody of converted texts, so no
+   * copies are made. The binding must be cleared before the MEX call returns.
+   */
+  bool bindParameter( int index, const ValueMex& item, bool bStreamable, bool bStatic = false, BlobPackJob* pJob = NULL )
+  {
+      int err_id = MSG_NOERROR;
+      int iTypeComplexity;
+      int rc;
+
+      assert( isOpen() );
+
+      SQLstats* stats = m_pstackitem->activeStats();
+      double    start = stats ? SQLstats::now() : 0.0;
+
+      ValueSQL value = createValueSQLFromItem( item, bStreamable, iTypeComplexity, err_id, pJob );
+
+      // typed BLOBs are packed by createValueSQLFromItem()
+      if( stats && SQLITE_BLOBX == value.m_typeID )
+      {
+          stats->m_pack_time += SQLstats::now() - start;
+          stats->m_packed++;
+      }
+
+      if( MSG_NOERROR != err_id )
+      {
+          setErr( err_id );
+          return false;
+      }
+
+      switch( value.m_typeID )
+      {
+          case SQLITE_NULL:
+              rc = sqlite3_bind_null( m_stmt, index );
+              if( SQLITE_OK != rc )
+              {
+                  setSqlError( rc );
+              }
+              break;
+
+          case SQLITE_FLOAT:
+              // scalar floating point value
+              rc = sqlite3_bind_double( m_stmt, index, item.GetScalar() );
+              if( SQLITE_OK != rc )
+              {
+                  setSqlError( rc );
+              }
+              break;
+
+          case SQLITE_INTEGER:
+              if( (int)item.ClassID() == (int)ValueMex::INT64_CLASS )
+              {
+                  // scalar integer value
+                  rc = sqlite3_bind_int64( m_stmt, index, item.GetInt64() );
+                  if( SQLITE_OK != rc )
+                  {
+                      setSqlError( rc );
+                  }
+              }
+              else
+              {
+                  // scalar integer value
+                  rc = sqlite3_bind_int( m_stmt, index, item.GetInt() );
+                  if( SQLITE_OK != rc )
+                  {
+                      setSqlError( rc );
+                  }
+              }
+              break;
+
+          case SQLITE_TEXT:
+              // string argument
+              if( bStatic )
+              {
+                  // sqlite takes custody of the text, even if sqlite3_bind_text() fails
+                  // (text length must not be negative then)
+                  rc = sqlite3_bind_text( m_stmt, index, value.m_text, (int)strlen( value.m_text ), 
+                                          freeBoundText );
+                  value.Detach();
+              }
+              else
+              {
+                  // SQLite makes a local copy of the text (thru SQLITE_TRANSIENT)
+                  rc = sqlite3_bind_text( m_stmt, index, value.m_text, -1, SQLITE_TRANSIENT );
+              }
+              if( SQLITE_OK != rc )
+              {
+                  setSqlError( rc );
+              }
+              break;
+
+          case SQLITE_BLOB:
+              // SQLite refers to the MATLAB array (thru SQLITE_STATIC) or
+              // makes a local copy of the blob (thru SQLITE_TRANSIENT)
+              rc = sqlite3_bind_blob( m_stmt, index, item.Data(), 
+                                      (int)item.ByData(),
+                                      bStatic ? SQLITE_STATIC : SQLITE_TRANSIENT );
+              if( SQLITE_OK != rc )
+              {
+                  setSqlError( rc );
+              }
+              break;
+
+          case SQLITE_BLOBX:
+              // sqlite takes custody of the blob, even if sqlite3_bind_blob() fails
+              // the sqlite allocator provided blob memory
+              rc = sqlite3_bind_blob( m_stmt, index, value.Detach(), 
+                                      (int)value.m_blobsize, 
+                                      sqlite3_free );
+              if( SQLITE_OK != rc )
+              {
+                  setSqlError( rc );
+              }  
+              break;
+
+          default:
+              // all other (unsuppored types)
+              setErr( MSG_INVALIDARG );
+              break;
+      }
+      
+      return !errPending();
+  }
+  
+  
+  /**
+   * \brief Binds one element of a numeric array to a parameter
+   *
+   * \param[in] index Index number of parameter (1 based)
+   * \param[in] data Data of a numeric or logical array
+   * \param[in] classID MATLAB class of \p data
+   * \param[in] element Index number of element (0 based)
+   * \returns true on success
+   *
+   * The value is read straight from array memory, no MATLAB array is created.
+   */
+  bool bindElement( int index, const void* data, mxClassID classID, size_t element )
+  {
+      int rc;
+
+      assert( isOpen() );
+
+      switch( classID )
+      {
+          case mxDOUBLE_CLASS:
+              rc = sqlite3_bind_double( m_stmt, index, ((const double*)data)[element] );
+              break;
+
+          case mxSINGLE_CLASS:
+              rc = sqlite3_bind_double( m_stmt, index, (double)((const float*)data)[element] );
+              break;
+
+          case mxLOGICAL_CLASS:
+              rc = sqlite3_bind_int( m_stmt, index, (int)((const mxLogical*)data)[element] );
+              break;
+
+          case mxINT8_CLASS:
+              rc = sqlite3_bind_int( m_stmt, index, (int)((const int8_t*)data)[element] );
+              break;
+
+          case mxUINT8_CLASS:
+              rc = sqlite3_bind_int( m_stmt, index, (int)((const uint8_t*)data)[element] );
+              break;
+
+          case mxINT16_CLASS:
+              rc = sqlite3_bind_int( m_stmt, index, (int)((const int16_t*)data)[element] );
+              break;
+
+          case mxUINT16_CLASS:
+              rc = sqlite3_bind_int( m_stmt, index, (int)((const uint16_t*)data)[element] );
+              break;
+
+          case mxINT32_CLASS:
+              rc = sqlite3_bind_int( m_stmt, index, (int)((const int32_t*)data)[element] );
+              break;
+
+          case mxUINT32_CLASS:
+              rc = sqlite3_bind_int64( m_stmt, index, (sqlite3_int64)((const uint32_t*)data)[element] );
+              break;
+
+          case mxINT64_CLASS:
+          case mxUINT64_CLASS:
+              rc = sqlite3_bind_int64( m_stmt, index, ((const sqlite3_int64*)data)[element] );
+              break;
+
+          default:
+              // all other (unsuppored types)
+              setErr( MSG_INVALIDARG );
+              return false;
+      }
+
+      if( SQLITE_OK != rc )
+      {
+          setSqlError( rc );
+      }
+
+      return !errPending();
+  }
+  
+  
+  /// Evaluates current SQL statement
+  int step()
+  {
+      return m_stmt ? sqlite3_step( m_stmt ) : SQLITE_ERROR;
+  }
+  
+  
+  /// Returns the column count for current statement
+  int colCount()
+  {
+      return m_stmt ? sqlite3_column_count( m_stmt ) : 0;
+  }
+  
+  
+  /**
+   * \brief Returns the (prefered) type of one column for current statement
+   *
+   * \param[in] index Index number of desired column (0 based)
+   * \returns -1 on error
+   */
+  int colType( int index )
+  {
+      return m_stmt ? sqlite3_column_type( m_stmt, index ) : -1;
+  }
+  
+  
+  /// Returns an integer value for least fetch and column number
+  sqlite3_int64 colInt64( int index )
+  {
+      return m_stmt ? sqlite3_column_int64( m_stmt, index ) : 0;
+  }
+  
+  
+  /// Returns a floating point value for least fetch and column number
+  double colFloat( int index )
+  {
+      return m_stmt ? sqlite3_column_double( m_stmt, index ) : 0.0;
+  }
+  
+  
+  /// Returns a text value for least fetch and column number
+  const unsigned char* colText( int index )
+  {
+      return m_stmt ? sqlite3_column_text( m_stmt, index ) : (const unsigned char*)"";
+  }
+  
+  
+  /// Returns a BLOB for least fetch and column number
+  const void* colBlob( int index )
+  {
+      unsigned char* test = (unsigned char*)sqlite3_column_blob( m_stmt, index );
+      return m_stmt ? sqlite3_column_blob( m_stmt, index ) : NULL;
+  }
+  
+  
+  /// Returns the size of one value of least fetch and column number in bytes
+  size_t colBytes( int index )
+  {
+      return m_stmt ? sqlite3_column_bytes( m_stmt, index ) : 0;
+  }
+  
+  
+  /// Returns the column name least fetch and column number 
+  const char* colName( int index )
+  {
+      return m_stmt ? sqlite3_column_name( m_stmt, index ) : "";
+  }
+  
+  
+  /// Returns the declared type of a column (table column only), or NULL
+  const char* colDeclType( int index )
+  {
+      return m_stmt ? sqlite3_column_decltype( m_stmt, index ) : NULL;
+  }
+  
+  
+  /**
+   * \brief Map a declared column type to a MATLAB class
+   *
+   * \param[in] declType Declared column type (i.e. "INT16")
+   * \returns MATLAB class, or mxUNKNOWN_CLASS if there is no mapping
+   */
+  static
+  mxClassID classFromDeclType( const char* declType )
+  {
+      static const struct { const char* name; mxClassID classID; } map[] = 
+      {
+          { "INT8",     mxINT8_CLASS   }, { "TINYINT",  mxINT8_CLASS   },
+          { "INT16",    mxINT16_CLASS  }, { "SMALLINT", mxINT16_CLASS  },
+          { "INT32",    mxINT32_CLASS  },
+          { "INT64",    mxINT64_CLASS  }, { "BIGINT",   mxINT64_CLASS  },
+          { "UINT8",    mxUINT8_CLASS  }, { "UINT16",   mxUINT16_CLASS },
+          { "UINT32",   mxUINT32_CLASS }, { "UINT64",   mxUINT64_CLASS },
+          { "REAL4",    mxSINGLE_CLASS }, { "FLOAT4",   mxSINGLE_CLASS }, 
+          { "SINGLE",   mxSINGLE_CLASS },
+          { "BOOL",     mxLOGICAL_CLASS }, { "BOOLEAN", mxLOGICAL_CLASS },
+      };
+
+      if( declType )
+      {
+          // compare type name only, i.e. "INT16(4)" or "INT16 UNSIGNED"
+          size_t len = strcspn( declType, " (" );
+
+          for( int i = 0; i < (int)(sizeof(map) / sizeof(map[0])); i++ )
+          {
+              if( len == strlen( map[i].name ) && 0 == _strnicmp( declType, map[i].name, len ) )
+              {
+                  return map[i].classID;
+              }
+          }
+      }
+
+      return mxUNKNOWN_CLASS;
+  }
+  
+  
+  /// Converts one char to a printable (non-white-space) character
+  struct to_alphanum
+  {
+      /// Functor
+      char operator()( char a )
+      {
+          if( a >= 'a' && a <= 'z' ) return a;
+          if( a >= 'A' && a <= 'Z' ) return a;
+          if( a >= '0' && a <= '9' ) return a;
+
+          return '_';
+      }
+  };
+  
+  
+  /**
+   * \brief Make a field name unambiguous
+   *
+   * \param[in,out] name Field name, gets a consecutive number appended if already used
+   * \param[in,out] used Field names so far, \p name is added
+   * \param[in,out] suffixes Next suffix number to try for a field name
+   * \returns false, if there are too many equal names
+   */
+  static
+  bool makeUniqueName( string& name, unordered_set<string>& used, unordered_map<string,int>& suffixes )
+  {
+      string new_name( name );
+
+      if( used.count( new_name ) )
+      {
+          // if name exists already, then append consecutive numbers to differ.
+          // Numbers tried before for the same name are still in use.
+          int& number = suffixes[name];
+
+          if( !number )
+          {
+              number = 1;
+          }
+
+          // break if more than 100 equal column names  \literal
+          for( ; number < 99; number++ )
+          {
+              char str_number[16];
+              int  str_number_len = _snprintf( str_number, sizeof( str_number ), "_%d", number );
+
+              // truncate name if necessary and append suffix
+              new_name = name.substr( 0, g_namelengthmax - str_number_len ) + str_number;
+
+              if( !used.count( new_name ) )
+              {
+                  break;
+              }
+          }
+
+          // number may not exceed limit
+          if( number >= 99 )
+          {
+              return false;
+          }
+      }
+
+      used.insert( new_name );
+      name = new_name;
+
+      return true;
+  }
+
+
+  /**
+   * \brief Returns the column names of least fetch
+   *
+   * The column names are used as field names in MATLAB arrays.
+   * MATLAB doesn't permit all characters in field names, moreover
+   * fieldnames must be unambiguous. So there is a second name which
+   * is used to be that fieldname. Column name and field name are 
+   * represented by string pairs.
+   *
+   * \param[out] names String pair list for column names
+   * \returns Column count
+   */
+  int getColNames( ValueSQLCol::StringPairList& names )
+  {
+      unordered_set<string>     used;       // field names so far
+      unordered_map<string,int> suffixes;   // next suffix number to try for a field name
+
+      names.clear();
+      names.reserve( colCount() );
+      
+      // iterate columns
+      for( int i = 0; i < colCount(); i++ )
+      {
+          pair<string,string> item( colName(i), colName(i) );
+          
+          // truncate column name if necessary
+          item.second = item.second.substr( 0, g_namelengthmax );
+          
+          // only alphanumeric characters allowed, transform alias
+          std::transform( item.second.begin(), item.second.end(), item.second.begin(), to_alphanum() );
+          
+          // fieldname must start with a valid letter
+          if( !item.second.size() || !isalpha(item.second[0]) )
+          {
+              item.second = string("X") + item.second;  /// \todo Any other (better) ideas?
+          }
+          
+          // Optionally ensure fieldnames are unambiguous
+          if( g_check4uniquefields && !makeUniqueName( item.second, used, suffixes ) )
+          {
+              names.clear();
+              setErr( MSG_ERRVARNAME );
+              break;
+          }
+          
+          names.push_back( item );
+      }
+      
+      return (int)names.size();
+  }
   
   
-  /// Converts one char to a printable (non-white-space) character
-  struct to_alphanum
+  /// Reset current SQL statement
+  void reset()
+  {
+      if( m_stmt )
+      {
+          sqlite3_reset( m_stmt );
+      }
+  }
+  
+  
+  /**
+   * \brief Clear parameter bindings and finalize current statement
+   *
+   * If the statement cache is enabled, the statement is reset and given
+   * into custody of the cache instead. Statements which may change the
+   * database schema flush the cache.
+   */
+  void finalize()
+  {
+      if( m_stmt )
+      {
+          // sqlite3_reset() does not reset the bindings on a prepared statement!
+          sqlite3_clear_bindings( m_stmt );
+          sqlite3_reset( m_stmt );
+
+          if( g_stmt_cache_size > 0 && m_command && !SQLstmtCache::isSchemaChange( m_command ) )
+          {
+              m_pstackitem->stmtCache().give( m_command, m_stmt, g_stmt_cache_size, m_colNames );
+          }
+          else
+          {
+              if( m_command && SQLstmtCache::isSchemaChange( m_command ) )
+              {
+                  m_pstackitem->stmtCache().flush();
+              }
+
+              sqlite3_finalize( m_stmt );
+          }
+          m_stmt = NULL;
+          m_colNames.clear();
+      }
+  }
+
+    
+  /**
+   * \brief Build the column vectors for the results of current statement
+   *
+   * \param[out] cols Column vectors to collect results
+   */
+  void initColumns( ValueSQLCols& cols )
+  {
+      // field names are built once per prepared statement
+      if( !m_colNames.isValid( m_stmt ) )
+      {
+          m_colNames.clear();
+
+          if( getColNames( m_colNames.m_names ) == colCount() )
+          {
+              m_colNames.validate();
+          }
+      }
+
+      const ValueSQLCol::StringPairList& names = m_colNames.m_names;
+
+      cols.clear();
+
+      // build column vectors
+      for( int i = 0; i < (int)names.size(); i++ )
+      {
+          cols.push_back( ValueSQLCol(names[i]) );
+      }
+
+      // MATLAB classes by declared column types (struct of arrays only)
+      if( g_decltype_classes && ( g_result_type == RESULT_TYPE_STRUCTOFARRAYS || g_result_type == RESULT_TYPE_TYPEDCOLUMNS ) )
+      {
+          for( int i = 0; i < (int)cols.size(); i++ )
+          {
+              cols[i].setNativeClass( classFromDeclType( colDeclType( i ) ) );
+          }
+      }
+
+      // TEXT columns as dictionary codes (struct of arrays only)
+      if( g_text_dictionary && ( g_result_type == RESULT_TYPE_STRUCTOFARRAYS || g_result_type == RESULT_TYPE_TYPEDCOLUMNS ) )
+      {
+          for( int i = 0; i < (int)cols.size(); i++ )
+          {
+              cols[i].setDictionary();
+          }
+      }
+  }
+
+
+  /**
+   * \brief Append a text value to a column vector
+   *
+   * \param[in,out] col Column vector
+   * \param[in] text Text value (UTF-8)
+   * \returns false on memory error
+   */
+  static
+  bool appendText( ValueSQLCol& col, const char* text )
+  {
+      if( col.m_isDict )
+      {
+          // distinct values are converted and stored once only
+          return col.appendDictText( text );
+      }
+
+      // non-const value, so the column takes custody of the text
+      ValueSQL value( (char*)utils_strnewdup( text, g_convertUTF8 ) );
+      col.append( value );
+
+      return true;
+  }
+
+
+  /**
+   * \brief Append a BLOB to a column vector (as uint8 array)
+   *
+   * \param[in,out] col Column vector
+   * \param[in] blob BLOB data
+   * \param[in] bytes Size of \p blob in bytes
+   * \returns false on memory error
+   */
+  static
+  bool appendBlob( ValueSQLCol& col, const void* blob, size_t bytes )
+  {
+      ValueMex item = ValueMex( (int)bytes, bytes ? 1 : 0, ValueMex::UINT8_CLASS );
+
+      if( !item.Item() )
+      {
+          return false;
+      }
+
+      if( bytes )
+      {
+          memcpy( item.Data(), blob, bytes );
+      }
+
+      // non-const value, so the column takes custody of the array
+      ValueSQL value( item.Detach() );
+      col.append( value );
+
+      return true;
+  }
+
+    
+  /** 
+   * \brief Proceed a table fetch
+   *
+   * \param[out] cols Column vectors to collect results
+   * \param[in] initialize Initializing \a cols if set (only on first call of fetch() 
+   *                       when parameter wrapping is on)
+   * \param[in] maxRows Maximum number of rows to fetch, or -1 for all rows
+   * \param[out] done Set to true, if the statement has no more rows
+   *
+   * Stepping through the results and stores the results in column vectors.
+   * When \p maxRows is reached, the statement is left as it is, so the next 
+   * call continues with the following row (cursors).
+   */
+  bool fetch( ValueSQLCols& cols, bool initialize = false, int maxRows = -1, bool* done = NULL ) // kv69: enable for skipping initialization to accumulate query results
+  {
+      assert( isOpen() );
+      
+      if( initialize )
+      {
+          initColumns( cols );
+          beginProfile();
+          m_pstackitem->beginResult();
+      }
+
+      if( done )
+      {
+          *done = false;
+      }
+
+      SQLstats* stats = m_pstackitem->activeStats();
+
+      // step through
+      for( int row = 0; !errPending() && row != maxRows; row++ )
+      {
+          /*
+           * Advance to the next row
+           */
+          SQLstats::Timer step_timer( stats ? &stats->m_step_time : NULL );
+          int step_res = step();
+          step_timer.stop();
+
+          if (step_res == SQLITE_DONE) // kv69 sqlite has finished executing
+          {
+              if( done )
+              {
+                  *done = true;
+              }
+              break;
+          }
+
+
+          if (step_res != SQLITE_ROW) // kv69 no other row ? this must be an error
+          {
+              setSqlError( step_res );
+              break;
+          }
+
+          SQLstats::Timer column_timer( stats ? &stats->m_column_time : NULL, stats ? &stats->m_convert_time : NULL );
+          size_t          row_bytes = 0;
+
+          if( stats )
+          {
+              stats->m_rows++;
+          }
+
+          /*
+           * get new memory for the result
+           */
+          for( int jCol = 0; jCol < (int)cols.size() && !errPending(); jCol++ )
+          {
+              switch( colType( jCol ) )
+              {
+                  case SQLITE_NULL:      
+                      cols[jCol].append( ValueSQL() );
+                      row_bytes += sizeof( double );
+                      break;
+
+                  case SQLITE_INTEGER:   
+                      // numeric values are written straight into the column buffer
+                      cols[jCol].append( colInt64( jCol ) );
+                      row_bytes += sizeof( sqlite3_int64 );
+                      break;
+
+                  case SQLITE_FLOAT:
+                      cols[jCol].append( colFloat( jCol ) );
+                      row_bytes += sizeof( double );
+                      break;
+
+                  case SQLITE_TEXT:
+                  {
+                      const char* text = (const char*)colText( jCol );
+
+                      row_bytes += colBytes( jCol ) + 1;
+
+                      if( stats )
+                      {
+                          stats->m_text_bytes += colBytes( jCol );
+                      }
+
+                      SQLstats::Timer convert_timer( stats ? &stats->m_convert_time : NULL );
+
+                      if( !appendText( cols[jCol], text ) )
+                      {
+                          setErr( MSG_ERRMEMORY );
+                      }
+                      break;
+                  }
+
+                  case SQLITE_BLOB:      
+                      row_bytes += colBytes( jCol );
+
+                      if( stats )
+                      {
+                          stats->m_blob_bytes += colBytes( jCol );
+                      }
+
+                      if( !appendBlob( cols[jCol], colBlob( jCol ), colBytes( jCol ) ) )
+                      {
+                          setErr( MSG_ERRMEMORY );
+                      }
+                      break;
+
+                  default:
+                      setErr( MSG_UNKNWNDBTYPE );
+                      break;
+              }
+          }
+
+          // abort oversized queries (soft cap, see 'result_memory_cap')
+          if( !errPending() && !m_pstackitem->addResultBytes( (double)row_bytes ) )
+          {
+              setErr( MSG_RESULTCAP );
+          }
+      }
+
+      collectProfile();
+      
+      if( errPending() )
+      {
+          cols.clear();
+          return false;
+      }
+
+      return true;
+  }
+
+
+  /// Clear the profile of the database for current statement (see fetch())
+  void beginProfile()
+  {
+      static const int ops[] = { SQLITE_STMTSTATUS_FULLSCAN_STEP, SQLITE_STMTSTATUS_SORT, SQLITE_STMTSTATUS_AUTOINDEX,
+                                 SQLITE_STMTSTATUS_VM_STEP, SQLITE_STMTSTATUS_REPREPARE, SQLITE_STMTSTATUS_RUN,
+                                 SQLITE_STMTSTATUS_FILTER_MISS, SQLITE_STMTSTATUS_FILTER_HIT };
+
+      SQLprofile& profile = m_pstackitem->profile();
+
+      profile.reset();
+      profile.m_query = m_command ? m_command : "";
+
+      if( !m_stmt )
+      {
+          return;
+      }
+
+      // a statement taken from the cache holds the counters of its previous runs
+      for( int i = 0; i < (int)( sizeof( ops ) / sizeof( ops[0] ) ); i++ )
+      {
+          (void)sqlite3_stmt_status( m_stmt, ops[i], /*reset*/ 1 );
+      }
+
+#ifdef SQLITE_ENABLE_STMT_SCANSTATUS
+      sqlite3_stmt_scanstatus_reset( m_stmt );
+#endif
+  }
+
+
+  /// Add the counters of current statement to the profile of the database (see fetch())
+  void collectProfile()
+  {
+      SQLprofile& profile = m_pstackitem->profile();
+
+      if( !m_stmt )
+      {
+          return;
+      }
+
+      profile.m_fullscan_steps += sqlite3_stmt_status( m_stmt, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1 );
+      profile.m_sorts          += sqlite3_stmt_status( m_stmt, SQLITE_STMTSTATUS_SORT, 1 );
+      profile.m_autoindexes    += sqlite3_stmt_status( m_stmt, SQLITE_STMTSTATUS_AUTOINDEX, 1 );
+      profile.m_vm_steps       += sqlite3_stmt_status( m_stmt, SQLITE_STMTSTATUS_VM_STEP, 1 );
+      profile.m_reprepares     += sqlite3_stmt_status( m_stmt, SQLITE_STMTSTATUS_REPREPARE, 1 );
+      profile.m_runs           += sqlite3_stmt_status( m_stmt, SQLITE_STMTSTATUS_RUN, 1 );
+      profile.m_filter_misses  += sqlite3_stmt_status( m_stmt, SQLITE_STMTSTATUS_FILTER_MISS, 1 );
+      profile.m_filter_hits    += sqlite3_stmt_status( m_stmt, SQLITE_STMTSTATUS_FILTER_HIT, 1 );
+      profile.m_memused         = sqlite3_stmt_status( m_stmt, SQLITE_STMTSTATUS_MEMUSED, 0 );
+
+#ifdef SQLITE_ENABLE_STMT_SCANSTATUS
+      // loop counters are cumulated by SQLite since beginProfile()
+      profile.m_loops.clear();
+
+      for( int idx = 0; ; idx++ )
+      {
+          sqlite3_int64   loops    = 0;
+          sqlite3_int64   visits   = 0;
+          double          estimate = 0.0;
+          const char*     name     = NULL;
+          const char*     explain  = NULL;
+
+          if( sqlite3_stmt_scanstatus( m_stmt, idx, SQLITE_SCANSTAT_NLOOP, &loops ) )
+          {
+              break;
+          }
+
+          sqlite3_stmt_scanstatus( m_stmt, idx, SQLITE_SCANSTAT_NVISIT, &visits );
+          sqlite3_stmt_scanstatus( m_stmt, idx, SQLITE_SCANSTAT_EST, &estimate );
+          sqlite3_stmt_scanstatus( m_stmt, idx, SQLITE_SCANSTAT_NAME, &name );
+          sqlite3_stmt_scanstatus( m_stmt, idx, SQLITE_SCANSTAT_EXPLAIN, &explain );
+
+          SQLprofile::Loop loop;
+          loop.m_name     = name ? name : "";
+          loop.m_explain  = explain ? explain : "";
+          loop.m_loops    = (double)loops;
+          loop.m_visits   = (double)visits;
+          loop.m_estimate = estimate;
+          profile.m_loops.push_back( loop );
+      }
+#endif
+  }
+
+
+  /**
+   * \brief Query plan of a statement
+   *
+   * \param[in] query SQL statement (UTF-8), only the first statement is regarded
+   * \returns One line per step of the plan, indented by its depth. Empty on failure.
+   *
+   * A side statement "EXPLAIN QUERY PLAN ..." is run on the same connection,
+   * the statement itself is not executed. Parameters are unbound (NULL).
+   */
+  string explainQueryPlan( const char* query )
+  {
+      string          plan;
+      sqlite3_stmt*   stmt = NULL;
+      vector<int>     parents;
+
+      if( !m_db || !query )
+      {
+          return plan;
+      }
+
+      string sql = string( "EXPLAIN QUERY PLAN " ) + query;
+
+      if( SQLITE_OK == sqlite3_prepare_v2( m_db, sql.c_str(), -1, &stmt, NULL ) && stmt )
+      {
+          // Columns: id, parent, notused, detail
+          while( SQLITE_ROW == sqlite3_step( stmt ) )
+          {
+              int         id     = sqlite3_column_int( stmt, 0 );
+              int         parent = sqlite3_column_int( stmt, 1 );
+              const char* detail = (const char*)sqlite3_column_text( stmt, 3 );
+
+              while( !parents.empty() && parents.back() != parent )
+              {
+                  parents.pop_back();
+              }
+
+              plan += string( 2 * parents.size(), ' ' ) + ( detail ? detail : "" ) + "\n";
+              parents.push_back( id );
+          }
+      }
+
+      sqlite3_finalize( stmt );
+
+      return plan;
+  }
+
+
+  /**
+   * \brief Step through current statement and copy all rows into a buffer
+   *
+   * \param[out] rows Buffer to collect the rows
+   * \param[in,out] total Bytes buffered by all parts of a query (optional, see 'parallel_query')
+   * \returns SQLITE_DONE on success, otherwise the SQLite error code
+   *
+   * No MATLAB API functions are called, so a worker thread may run this
+   * function. Results are converted by fetch( cols, rows ) afterwards.
+   * Stepping stops, as soon as the buffered rows (or \p total) exceed 
+   * g_result_memory_cap. SQLrowBuffer::m_capped is set then.
+   */
+  int fetchBuffer( SQLrowBuffer& rows, std::atomic<size_t>* total = NULL )
   {
-      /// Functor
-      char operator()( char a )
+      int    step_res;
+      size_t bytes = 0;
+
+      rows.m_cols   = colCount();
+      rows.m_capped = false;
+      rows.m_values.clear();
+      rows.m_data.clear();
+
+      while( SQLITE_ROW == ( step_res = step() ) )
       {
-          if( a >= 'a' && a <= 'z' ) return a;
-          if( a >= 'A' && a <= 'Z' ) return a;
-          if( a >= '0' && a <= '9' ) return a;
+          size_t data_size = rows.m_data.size();
+
+          for( int jCol = 0; jCol < rows.m_cols; jCol++ )
+          {
+              SQLrowBuffer::Value value = { colType( jCol ), 0, 0.0, 0, 0 };
+
+              switch( value.m_type )
+              {
+                  case SQLITE_INTEGER:
+                      value.m_int = colInt64( jCol );
+                      break;
+
+                  case SQLITE_FLOAT:
+                      value.m_float = colFloat( jCol );
+                      break;
+
+                  case SQLITE_TEXT:
+                  case SQLITE_BLOB:
+                  {
+                      // sqlite3_column_bytes() must follow the conversion by sqlite3_column_text()
+                      const char* data = ( SQLITE_TEXT == value.m_type ) ? (const char*)colText( jCol ) : (const char*)colBlob( jCol );
+
+                      value.m_offset = rows.m_data.size();
+                      value.m_bytes  = colBytes( jCol );
+                      rows.m_data.append( data ? data : "", value.m_bytes );
+                      rows.m_data.push_back( '\0' );
+                      break;
+                  }
+              }
+
+              rows.m_values.push_back( value );
+          }
+
+          // same estimate as fetch( cols, rows ): text and BLOB data, one double for each other value
+          size_t row_bytes = ( rows.m_data.size() - data_size ) + rows.m_cols * sizeof( double );
+
+          bytes = total ? ( *total += row_bytes ) : ( bytes + row_bytes );
+
+          // abort oversized queries (soft cap, see 'result_memory_cap')
+          if( g_result_memory_cap > 0.0 && (double)bytes > g_result_memory_cap )
+          {
+              rows.m_capped = true;
+              break;
+          }
+      }
+
+      return step_res;
+  }
+
+
+  /**
+   * \brief Convert rows of a buffer into column vectors
+   *
+   * \param[out] cols Column vectors to collect results
+   * \param[in] rows Buffer filled by fetchBuffer()
+   * \param[in] initialize If true, the column vectors are initialized by current statement,
+   *            otherwise the rows are appended (buffers of the same statement)
+   * \param[in] owner Database the result buffers are accounted to (default: connection of the statement)
+   */
+  bool fetch( ValueSQLCols& cols, const SQLrowBuffer& rows, bool initialize = true, SQLstackitem* owner = NULL )
+  {
+      if( !owner )
+      {
+          owner = m_pstackitem;
+      }
+
+      if( initialize )
+      {
+          initColumns( cols );
+          owner->beginResult();
+      }
+
+      if( rows.m_capped )
+      {
+          setErr( MSG_RESULTCAP );
+      }
+
+      for( size_t i = 0; !errPending() && i < rows.m_values.size(); i++ )
+      {
+          const SQLrowBuffer::Value& value = rows.m_values[i];
+          ValueSQLCol&               col   = cols[i % rows.m_cols];
+          size_t                     bytes = sizeof( double );
+
+          switch( value.m_type )
+          {
+              case SQLITE_NULL:
+                  col.append( ValueSQL() );
+                  break;
+
+              case SQLITE_INTEGER:
+                  col.append( value.m_int );
+                  break;
+
+              case SQLITE_FLOAT:
+                  col.append( value.m_float );
+                  break;
+
+              case SQLITE_TEXT:
+                  bytes = value.m_bytes + 1;
+
+                  if( !appendText( col, rows.m_data.c_str() + value.m_offset ) )
+                  {
+                      setErr( MSG_ERRMEMORY );
+                  }
+                  break;
+
+              case SQLITE_BLOB:
+                  bytes = value.m_bytes;
+
+                  if( !appendBlob( col, rows.m_data.data() + value.m_offset, value.m_bytes ) )
+                  {
+                      setErr( MSG_ERRMEMORY );
+                  }
+                  break;
+
+              default:
+                  setErr( MSG_UNKNWNDBTYPE );
+                  break;
+          }
+
+          // abort oversized queries (soft cap, see 'result_memory_cap')
+          if( !errPending() && !owner->addResultBytes( (double)bytes ) )
+          {
+              setErr( MSG_RESULTCAP );
+          }
+      }
+
+      if( errPending() )
+      {
+          cols.clear();
+          return false;
+      }
+
+      return true;
+  }
+  
+};
+
+
+/**
+ * \brief Query running in background on its own database connection
+ *
+ * The statement is prepared and bound by the MATLAB thread, then a worker
+ * thread steps through it and copies all rows into a buffer (see
+ * SQLiface::fetchBuffer()). The results are converted into MATLAB arrays
+ * by the MATLAB thread again, when the ticket is redeemed.
+ * The connection is taken from the reader pool of the database, or opened
+ * exclusively, if the pool is exhausted or disabled.
+ */
+class SQLticket
+{
+    SQLstackitem*           m_conn;         ///< database connection running the query
+    SQLstackitem*           m_pool;         ///< database owning the reader pool \a m_conn was taken from, or NULL
+    SQLiface*               m_iface;        ///< interface owning the prepared statement
+    string                  m_query;        ///< SQL text (UTF-8), referenced by \a m_iface
+    SQLrowBuffer            m_rows;         ///< rows copied by the worker thread
+    int                     m_rc;           ///< result code of the worker thread (SQLITE_DONE on success)
+    bool                    m_done;         ///< true, if the worker thread has finished
+    std::atomic<bool>       m_cancel;       ///< set to abort the query
+    std::thread             m_worker;       ///< worker thread
+    std::mutex              m_mutex;        ///< guards \a m_done
+    std::condition_variable m_finished;     ///< signaled, when the worker thread has finished
+
+    // Non-copyable
+    SQLticket( const SQLticket& );
+    SQLticket& operator=( const SQLticket& );
+
+    /// Progress handler, aborts the query when cancelled (no MATLAB API, see SQLstackitem::progressHandler())
+    static
+    int progressHandler( void* data )
+    {
+        return ((SQLticket*)data)->m_cancel ? 1 : 0;
+    }
+
+    /// Worker thread function
+    void run()
+    {
+        int rc = m_iface->fetchBuffer( m_rows );
+
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_rc   = rc;
+        m_done = true;
+        m_finished.notify_all();
+    }
+
+public:
+
+    /// Ctor
+    SQLticket() : m_conn( NULL ), m_pool( NULL ), m_iface( NULL ), m_rc( SQLITE_OK ), m_done( false ), m_cancel( false )
+    {}
+
+
+    /// Dtor, cancels the query if still running
+    ~SQLticket()
+    {
+        cancel();
+        delete m_iface;
+
+        if( m_pool )
+        {
+            m_pool->releaseReader( m_conn );
+        }
+        else
+        {
+            delete m_conn;
+        }
+    }
+
+
+    /**
+     * \brief Check if a query doesn't write the database
+     *
+     * \param[in] db Database the query is submitted to
+     * \param[in] query SQL statement (UTF-8)
+     * \returns true if the (first) statement of \p query is read-only
+     *
+     * The statement is prepared and discarded on the connection of \p db.
+     * If preparing fails, false is returned, so the error is reported later on.
+     */
+    static
+    bool isReadonlyQuery( SQLstackitem& db, const char* query )
+    {
+        sqlite3_stmt* stmt = NULL;
+        bool readonly = false;
+
+        if( SQLITE_OK == sqlite3_prepare_v2( db.dbid(), query, -1, &stmt, NULL ) && stmt )
+        {
+            readonly = 0 != sqlite3_stmt_readonly( stmt );
+        }
+
+        sqlite3_finalize( stmt );
+
+        return readonly;
+    }
+
+
+    /**
+     * \brief Get a second connection to a database file and prepare the query
+     *
+     * \param[in] db Database the query is submitted to
+     * \param[in] query SQL statement (UTF-8)
+     * \param[out] err Error information
+     * \returns true if succeeded
+     */
+    bool open( SQLstackitem& db, const char* query, SQLerror& err )
+    {
+        // in-memory and temporary databases can't be shared by a second connection
+        const char* filename = db.isOpen() ? sqlite3_db_filename( db.dbid(), "main" ) : NULL;
+
+        if( !filename || !*filename )
+        {
+            err.set( MSG_NODBFILE );
+            return false;
+        }
+
+        // pool connections are read-only, so only queries not writing the database may use them
+        if( isReadonlyQuery( db, query ) )
+        {
+            m_conn = db.acquireReader( err );
+        }
+
+        if( m_conn )
+        {
+            m_pool = &db;
+        }
+        else if( !err.isPending() )
+        {
+            int flags = ( sqlite3_db_readonly( db.dbid(), "main" ) == 1 ) ? SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE;
+
+            m_conn = new SQLstackitem;
+
+            if( m_conn->openDbUtf8( filename, flags, err, /*bMatlabThread*/ false ) )
+            {
+                sqlite3_busy_timeout( m_conn->dbid(), MKSQLITE_CONFIG_BUSYTIMEOUT );
+            }
+        }
+
+        if( err.isPending() )
+        {
+            return false;
+        }
+
+        sqlite3_progress_handler( m_conn->dbid(), 1000, &SQLticket::progressHandler, this );
+
+        m_query = query;
+        m_iface = new SQLiface( *m_conn );
+
+        if( !m_iface->setQuery( m_query.c_str() ) )
+        {
+            const char* errid = NULL;
+            // message text is copied (non-const), since the interface will be deleted
+            err.set( (char*)m_iface->getErr(&errid), errid );
+            return false;
+        }
+
+        return true;
+    }
+
+
+    /// Returns the interface owning the prepared statement
+    SQLiface* iface()
+    {
+        return m_iface;
+    }
+
+
+    /// Start the worker thread, the query runs in place if no thread is available
+    void start()
+    {
+        try
+        {
+            m_worker = std::thread( &SQLticket::run, this );
+        }
+        catch( ... )
+        {
+            run();
+        }
+    }
+
+
+    /**
+     * \brief Wait for the worker thread
+     *
+     * \param[in] timeout Timeout in seconds, or negative to wait infinitely
+     * \returns true, if the worker thread has finished
+     */
+    bool wait( double timeout = -1.0 )
+    {
+        {
+            std::unique_lock<std::mutex> lock( m_mutex );
+
+            if( timeout < 0 )
+            {
+                m_finished.wait( lock, [this]{ return m_done; } );
+            }
+            else if( !m_finished.wait_for( lock, std::chrono::duration<double>( timeout ), [this]{ return m_done; } ) )
+            {
+                return false;
+            }
+        }
+
+        if( m_worker.joinable() )
+        {
+            m_worker.join();
+        }
+
+        return true;
+    }
+
+
+    /// Returns true, if the worker thread has finished
+    bool isDone()
+    {
+        return wait( 0.0 );
+    }
+
+
+    /// Abort the query and wait for the worker thread
+    void cancel()
+    {
+        if( m_worker.joinable() )
+        {
+            m_cancel = true;
+            m_worker.join();
+        }
+    }
+
+
+    /**
+     * \brief Convert the rows of the finished query into column vectors
+     *
+     * \param[out] cols Column vectors to collect results
+     * \param[in] db Database the query was submitted to (result buffers are accounted there)
+     * \returns true on success, otherwise the error is set in iface()
+     */
+    bool fetch( ValueSQLCols& cols, SQLstackitem& db )
+    {
+        assert( m_done );
+
+        // fetch() reports stopping by the memory cap
+        if( SQLITE_DONE != m_rc && !m_rows.m_capped )
+        {
+            m_iface->setSqlError( m_rc );
+            return false;
+        }
+
+        return m_iface->fetch( cols, m_rows, /*initialize*/ true, &db );
+    }
+};
+
+
+/// Cancel all queries running in background
+inline
+void SQLstackitem::releaseTickets()
+{
+    for( SQLticketMap::iterator it = m_tickets.begin(); it != m_tickets.end(); it++ )
+    {
+        delete it->second;
+    }
+    m_tickets.clear();
+}
+
+
+/**
+ * \brief Copy of a database running in background (online backup API)
+ *
+ * A worker thread copies the pages by sqlite3_backup_step() from a database
+ * file into the database or vice versa. The file is accessed by an own 
+ * connection. The connection of the database itself is used by the worker 
+ * thread, until the copy is finished or cancelled, so mksqlite waits for
+ * the worker thread before any other command on this database.
+ */
+class SQLbackup
+{
+    SQLstackitem*           m_file;         ///< connection to the database file
+    sqlite3_backup*         m_backup;       ///< backup object
+    int                     m_pagesPerStep; ///< count of pages copied at once
+    std::atomic<int>        m_remaining;    ///< count of pages still to be copied
+    std::atomic<int>        m_pagecount;    ///< total count of pages
+    int                     m_rc;           ///< result code of the worker thread (SQLITE_DONE on success)
+    bool                    m_done;         ///< true, if the worker thread has finished
+    std::atomic<bool>       m_cancel;       ///< set to abort the copy
+    std::thread             m_worker;       ///< worker thread
+    std::mutex              m_mutex;        ///< guards \a m_done
+    std::condition_variable m_finished;     ///< signaled, when the worker thread has finished
+
+    // Non-copyable
+    SQLbackup( const SQLbackup& );
+    SQLbackup& operator=( const SQLbackup& );
+
+    /// Worker thread function (no MATLAB API)
+    void run()
+    {
+        int rc;
+        int busy_ms = 0;
+
+        do
+        {
+            rc = sqlite3_backup_step( m_backup, m_pagesPerStep );
+
+            m_remaining = sqlite3_backup_remaining( m_backup );
+            m_pagecount = sqlite3_backup_pagecount( m_backup );
+
+            // the source is locked by another connection, retry until the busy timeout elapses
+            if( SQLITE_BUSY == rc || SQLITE_LOCKED == rc )
+            {
+                if( busy_ms >= MKSQLITE_CONFIG_BUSYTIMEOUT )
+                {
+                    break;
+                }
+
+                sqlite3_sleep( 10 );
+                busy_ms += 10;
+            }
+            else
+            {
+                busy_ms = 0;
+            }
+        } while( !m_cancel && ( SQLITE_OK == rc || SQLITE_BUSY == rc || SQLITE_LOCKED == rc ) );
+
+        int rc_finish = sqlite3_backup_finish( m_backup );
+        m_backup = NULL;
+
+        if( SQLITE_DONE == rc && SQLITE_OK != rc_finish )
+        {
+            rc = rc_finish;
+        }
+
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_rc   = rc;
+        m_done = true;
+        m_finished.notify_all();
+    }
+
+public:
 
-          return '_';
-      }
-  };
-  
-  
-  /**
-   * \brief Returns the column names of least fetch
-   *
-   * The column names are used as field names in MATLAB arrays.
-   * MATLAB doesn't permit all characters in field names, moreover
-   * fieldnames must be unambiguous. So there is a second name which
-   * is used to be that fieldname. Column name and field name are 
-   * represented by string pairs.
-   *
-   * \param[out] names String pair list for column names
-   * \returns Column count
-   */
-  int getColNames( ValueSQLCol::StringPairList& names )
-  {
-      names.clear();
-      
-      // iterate columns
-      for( int i = 0; i < colCount(); i++ )
-      {
-          pair<string,string> item( colName(i), colName(i) );
-          
-          // truncate column name if necessary
-          item.second = item.second.substr( 0, g_namelengthmax );
-          
-          // only alphanumeric characters allowed, transform alias
-          std::transform( item.second.begin(), item.second.end(), item.second.begin(), to_alphanum() );
-          
-          // fieldname must start with a valid letter
-          if( !item.second.size() || !isalpha(item.second[0]) )
-          {
-              item.second = string("X") + item.second;  /// \todo Any other (better) ideas?
-          }
-          
-          // Optionally ensure fieldnames are unambiguous
-          if( g_check4uniquefields )
-          {
-              int loop = 0;
-              int number = 1;
-              string new_name(item.second);
-              
-              // break if more than 100 equal column names  \literal
-              while( loop < i && number < 100 )
-              {
-                  // if name exists already, then append consecutive numbers to differ
-                  if( new_name == names[loop].second )
-                  {
-                      char* str_number      = new char[g_namelengthmax+1];
-                      char* buffer          = new char[g_namelengthmax+1];
-                      int   str_number_len;
-
-                      // measure suffix length 
-                      str_number_len = _snprintf( str_number, g_namelengthmax+1, "_%d", number );
-                      // truncate name if necessary and append suffix
-                      _snprintf( buffer, g_namelengthmax+1, "%.*s%s", g_namelengthmax - str_number_len, item.second.c_str(), str_number );
-                      new_name = buffer;
-
-                      delete[] str_number;
-                      delete[] buffer;
-                      
-                      loop = 0; // name is new, check again precedent
-                      number++;
-
-                  } else loop++;
-              }
-              
-              // number may not exceed limit
-              if( loop < i )
-              {
-                  names.clear();
-                  setErr( MSG_ERRVARNAME );
-                  break;
-              }
-              
-              item.second = new_name;
-          }
-          
-          names.push_back( item );
-      }
-      
-      return (int)names.size();
-  }
-  
-  
-  /// Reset current SQL statement
-  void reset()
-  {
-      if( m_stmt )
-      {
-          sqlite3_reset( m_stmt );
-      }
-  }
-  
-  
-  /// Clear parameter bindings and finalize current statement
-  void finalize()
-  {
-      if( m_stmt )
-      {
-          sqlite3_clear_bindings( m_stmt );
-          sqlite3_finalize( m_stmt );
-          m_stmt = NULL;
-      }
-  }
+    /// Ctor
+    SQLbackup() : m_file( NULL ), m_backup( NULL ), m_pagesPerStep( -1 ), 
+                  m_remaining( 0 ), m_pagecount( 0 ), m_rc( SQLITE_OK ), m_done( false ), m_cancel( false )
+    {}
 
-    
-  /** 
-   * \brief Proceed a table fetch
-   *
-   * \param[out] cols Column vectors to collect results
-   * \param[in] initialize Initializing \a cols if set (only on first call of fetch() 
-   *                       when parameter wrapping is on)
-   *
-   * Stepping through the results and stores the results in column vectors.
-   */
-  bool fetch( ValueSQLCols& cols, bool initialize = false ) // kv69: enable for skipping initialization to accumulate query results
-  {
-      assert( isOpen() );
-      
-      if( initialize )
-      {
-          ValueSQLCol::StringPairList  names;
 
-          getColNames( names );
-          cols.clear();
+    /// Dtor, cancels the copy if still running
+    ~SQLbackup()
+    {
+        cancel();
 
-          // build column vectors
-          for( int i = 0; i < (int)names.size(); i++ )
-          {
-              cols.push_back( ValueSQLCol(names[i]) );
-          }
+        if( m_backup )
+        {
+            sqlite3_backup_finish( m_backup );
+        }
 
-          names.clear();
-      }
+        delete m_file;
+    }
 
-      // step through
-      for( ; !errPending() ; )
-      {
-          /*
-           * Advance to the next row
-           */
-          int step_res = step();
 
-          if (step_res == SQLITE_DONE) // kv69 sqlite has finished executing
-          {
-              break;
-          }
+    /**
+     * \brief Open the database file and initialize the copy
+     *
+     * \param[in] db Database (open)
+     * \param[in] filename Name of database file
+     * \param[in] toFile true to copy \p db into the file, false to copy the file into \p db
+     * \param[in] pagesPerStep Count of pages copied at once, or negative to copy all at once
+     * \param[out] err Error information
+     * \returns true if succeeded
+     */
+    bool open( SQLstackitem& db, const char* filename, bool toFile, int pagesPerStep, SQLerror& err )
+    {
+        int flags = toFile ? SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE : SQLITE_OPEN_READONLY;
 
+        m_file = new SQLstackitem;
 
-          if (step_res != SQLITE_ROW) // kv69 no other row ? this must be an error
-          {
-              setSqlError( step_res );
-              break;
-          }
+        if( !m_file->openDb( filename, flags | SQLITE_OPEN_NOMUTEX, err, /*bMatlabThread*/ false ) )
+        {
+            return false;
+        }
 
-          /*
-           * get new memory for the result
-           */
-          for( int jCol = 0; jCol < (int)cols.size() && !errPending(); jCol++ )
-          {
-              // Init value as SQLITE_NULL;
-              ValueSQL value;
+        sqlite3_busy_timeout( m_file->dbid(), MKSQLITE_CONFIG_BUSYTIMEOUT );
 
-              switch( colType( jCol ) )
-              {
-                  case SQLITE_NULL:      
-                      break;
+        sqlite3* dest  = toFile ? m_file->dbid() : db.dbid();
+        sqlite3* src   = toFile ? db.dbid() : m_file->dbid();
 
-                  case SQLITE_INTEGER:   
-                      value = ValueSQL( colInt64( jCol ) );
-                      break;
+        m_pagesPerStep = pagesPerStep;
+        m_backup       = sqlite3_backup_init( dest, "main", src, "main" );
 
-                  case SQLITE_FLOAT:
-                      value = ValueSQL( colFloat( jCol ) );
-                      break;
+        if( !m_backup )
+        {
+            err.setSqlError( dest, -1 );
+            return false;
+        }
 
-                  case SQLITE_TEXT:
-                      value = ValueSQL( (char*)utils_strnewdup( (const char*)colText( jCol ), g_convertUTF8 ) );
-                      break;
+        return true;
+    }
 
-                  case SQLITE_BLOB:      
-                  {
-                      size_t bytes = colBytes( jCol );
 
-                      ValueMex item = ValueMex( (int)bytes, bytes ? 1 : 0, ValueMex::UINT8_CLASS );
+    /// Start the worker thread, the copy runs in place if no thread is available
+    void start()
+    {
+        try
+        {
+            m_worker = std::thread( &SQLbackup::run, this );
+        }
+        catch( ... )
+        {
+            run();
+        }
+    }
 
-                      if( item.Item() )
-                      {
-                          if( bytes )
-                          {
-                              memcpy( item.Data(), colBlob( jCol ), bytes );
-                          }
-                      }
-                      else
-                      {
-                          setErr( MSG_ERRMEMORY );
-                          continue;
-                      }
 
-                      value = ValueSQL( item.Detach() );
-                      break;
-                  }
+    /**
+     * \brief Wait for the worker thread
+     *
+     * \param[in] timeout Timeout in seconds, or negative to wait infinitely
+     * \returns true, if the worker thread has finished
+     */
+    bool wait( double timeout = -1.0 )
+    {
+        {
+            std::unique_lock<std::mutex> lock( m_mutex );
 
-                  default:
-                      setErr( MSG_UNKNWNDBTYPE );
-                      continue;
-              }
-              
-              cols[jCol].append( value );
-          }
-      }
-      
-      if( errPending() )
-      {
-          cols.clear();
-          return false;
-      }
+            if( timeout < 0 )
+            {
+                m_finished.wait( lock, [this]{ return m_done; } );
+            }
+            else if( !m_finished.wait_for( lock, std::chrono::duration<double>( timeout ), [this]{ return m_done; } ) )
+            {
+                return false;
+            }
+        }
 
-      return true;
-  }
-  
+        if( m_worker.joinable() )
+        {
+            m_worker.join();
+        }
+
+        return true;
+    }
+
+
+    /// Returns true, if the worker thread has finished
+    bool isDone()
+    {
+        return wait( 0.0 );
+    }
+
+
+    /// Abort the copy and wait for the worker thread
+    void cancel()
+    {
+        if( m_worker.joinable() )
+        {
+            m_cancel = true;
+            m_worker.join();
+        }
+    }
+
+
+    /// Returns the count of pages still to be copied
+    int remaining()
+    {
+        return m_remaining;
+    }
+
+
+    /// Returns the total count of pages (known after the first step)
+    int pagecount()
+    {
+        return m_pagecount;
+    }
+
+
+    /**
+     * \brief Get the result of the finished copy
+     *
+     * \param[out] err Error information, if the copy failed
+     * \returns true, if all pages were copied
+     */
+    bool getResult( SQLerror& err )
+    {
+        assert( m_done );
+
+        if( SQLITE_DONE == m_rc )
+        {
+            return true;
+        }
+
+        // sqlite3_backup_finish() doesn't keep the message of SQLITE_BUSY and SQLITE_LOCKED
+        err.set( sqlite3_errstr( m_rc ), err.trans_err_to_ident( m_rc ) );
+
+        return false;
+    }
 };
+
+
+/// Cancel the copy running in background
+inline
+void SQLstackitem::releaseBackup()
+{
+    delete m_backup;
+    m_backup = NULL;
+}
+
+
+/// Start copying the database into a file in background
+inline
+bool SQLstackitem::backupToFile( const char* filename, int pagesPerStep, SQLerror& err )
+{
+    SQLbackup* backup = new SQLbackup;
+
+    releaseBackup();
+
+    if( !backup->open( *this, filename, /*toFile*/ true, pagesPerStep, err ) )
+    {
+        delete backup;
+        return false;
+    }
+
+    m_backup = backup;
+    m_backup->start();
+
+    return true;
+}
+
+
+/// Opens an in-memory database and loads a database file into it in background
+inline
+bool SQLstackitem::loadIntoMemory( const char* filename, int pagesPerStep, SQLerror& err )
+{
+    if( !openDbUtf8( ":memory:", SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, err ) )
+    {
+        return false;
+    }
+
+    SQLbackup* backup = new SQLbackup;
+
+    if( !backup->open( *this, filename, /*toFile*/ false, pagesPerStep, err ) )
+    {
+        SQLerror close_err;
+
+        delete backup;
+        (void)closeDb( close_err );
+        return false;
+    }
+
+    // the connection can't be used by the MATLAB thread, while the copy is running
+    sqlite3_busy_timeout( m_db, MKSQLITE_CONFIG_BUSYTIMEOUT );
+
+    m_backup = backup;
+    m_backup->start();
+
+    return true;
+}
+
+
+/// Release all prepared statements held by handles
+inline
+void SQLstackitem::releaseHandles()
+{
+    for( SQLhandleMap::iterator it = m_handles.begin(); it != m_handles.end(); it++ )
+    {
+        delete it->second.m_iface;
+    }
+    m_handles.clear();
+}
@@ -0,0 +1,61 @@
+function sqlite_test_autotransaction
+
+    clear all
+    close all
+    clc
+    dummy = mksqlite('version mex');
+    fprintf( '\n\n' );
+
+    NumOfSamples = 10000;  % amount of records to create
+    dbfile = fullfile( tempdir, 'sqlite_test_autotransaction.db' );
+
+    if exist( dbfile, 'file' )
+        delete( dbfile );
+    end
+
+    mksqlite( 'open', dbfile );
+    mksqlite( 'CREATE TABLE data (k INTEGER, v REAL)' );
+    old_wrapping = mksqlite( 'param_wrapping', 1 );
+    data = [ (1:NumOfSamples)', rand( NumOfSamples, 1 ) ];
+
+    % Commit every 1000 rows
+    old_rows = mksqlite( 'autotransaction', 1000 );
+    tic;
+    mksqlite( 'INSERT INTO data VALUES (?,?)', data );
+    fprintf( '%d inserts with automatic transactions: %.2fs\n', NumOfSamples, toc );
+
+    [~, info] = mksqlite( 'status' );
+    fprintf( '%d batches, %d rows committed\n', info.autotransaction_batches, info.autotransaction_rows );
+    assert( info.autotransaction_batches == NumOfSamples / 1000 );
+    assert( info.autotransaction_rows == NumOfSamples );
+
+    % Within an open transaction savepoints are used, so rollback still works
+    mksqlite( 'BEGIN' );
+    mksqlite( 'INSERT INTO data VALUES (?,?)', data );
+    mksqlite( 'ROLLBACK' );
+    result = mksqlite( 'SELECT count(*) AS n FROM data' );
+    assert( result.n == NumOfSamples );
+
+    % A failed commit rolls back, no transaction is left open
+    db2 = mksqlite( 0, 'open', dbfile );
+    mksqlite( db2, 'BEGIN' );
+    mksqlite( db2, 'SELECT count(*) FROM data' );  % holds a shared lock
+    mksqlite( 'setbusytimeout', 100 );
+    try
+        mksqlite( 'INSERT INTO data VALUES (?,?)', data );
+        error( 'commit should fail while the database is locked' );
+    catch err
+        fprintf( 'Commit failed as expected: %s\n', err.message );
+    end
+    mksqlite( 'BEGIN' );   % would fail within a transaction left open
+    mksqlite( 'COMMIT' );
+    mksqlite( db2, 'COMMIT' );
+    mksqlite( db2, 'close' );
+    mksqlite( 'setbusytimeout', 1000 );  % default
+    result = mksqlite( 'SELECT count(*) AS n FROM data' );
+    assert( result.n == NumOfSamples );
+
+    mksqlite( 'autotransaction', old_rows );
+    mksqlite( 'param_wrapping', old_wrapping );
+    mksqlite( 'close' );
+    delete( dbfile );
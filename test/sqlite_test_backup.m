@@ -0,0 +1,54 @@
+function sqlite_test_backup
+
+    clear all
+    close all
+    clc
+    dummy = mksqlite('version mex');
+    fprintf( '\n\n' );
+
+    NumOfSamples = 50000;  % amount of records to create
+    filename     = 'sqlite_test_backup.db';
+    copyname     = 'sqlite_test_backup_copy.db';
+
+    % Build a database file
+    if exist( filename, 'file' ), delete( filename ); end
+    if exist( copyname, 'file' ), delete( copyname ); end
+
+    db = mksqlite( 0, 'open', filename );
+    mksqlite( db, 'CREATE TABLE ref (id INTEGER PRIMARY KEY, name TEXT, value REAL)' );
+    mksqlite( db, ['WITH RECURSIVE c(x) AS (SELECT 1 UNION ALL SELECT x+1 FROM c WHERE x<?) ' ...
+                   'INSERT INTO ref (name, value) SELECT ''item '' || x, random() FROM c'], NumOfSamples );
+    mksqlite( db, 'close' );
+
+    % Load it into memory, 10 pages at a time, while MATLAB keeps running
+    db = mksqlite( 0, 'load_into_memory', filename, 10 );
+    status = mksqlite( db, 'backup_status' );
+    while ~status.done
+        fprintf( 'Loading: %d of %d pages remaining\n', status.remaining, status.pagecount );
+        pause( 0.01 );
+        status = mksqlite( db, 'backup_status' );
+    end
+    assert( mksqlite( db, 'backup_wait' ) == 1 );
+
+    result = mksqlite( db, 'SELECT count(*) AS n FROM ref' );
+    assert( result.n == NumOfSamples );
+
+    % Change the in-memory database and write it back to another file
+    mksqlite( db, 'INSERT INTO ref (name, value) VALUES (?, ?)', 'new', 1 );
+    mksqlite( db, 'backup', copyname );
+    assert( mksqlite( db, 'backup_wait', 60 ) == 1 );
+
+    db2 = mksqlite( 0, 'open', copyname, 'ro' );
+    result = mksqlite( db2, 'SELECT count(*) AS n FROM ref' );
+    assert( result.n == NumOfSamples + 1 );
+    mksqlite( db2, 'close' );
+
+    % A cancelled load leaves the in-memory database empty
+    mksqlite( db, 'load_into_memory', filename, 1 );
+    mksqlite( db, 'backup_cancel' );
+    result = mksqlite( db, 'SELECT count(*) AS n FROM sqlite_master' );
+    assert( result.n == 0 );
+
+    mksqlite( 0, 'close' );
+    delete( filename );
+    delete( copyname );
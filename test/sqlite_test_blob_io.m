@@ -0,0 +1,53 @@
+function sqlite_test_blob_io
+
+    clear all
+    close all
+    clc
+    dummy = mksqlite('version mex');
+    fprintf( '\n\n' );
+
+    NumOfSamples = 1e7;   % samples of the waveform (80 MB)
+    WindowSize   = 65536; % samples read at once
+
+    mksqlite( 'open', ':memory:' );
+    mksqlite( 'typedBLOBs', 0 );  % store raw bytes only
+    mksqlite( 'CREATE TABLE wave (id INTEGER PRIMARY KEY, data BLOB)' );
+
+    wave = sin( (1:NumOfSamples)' / 1000 );
+    mksqlite( 'INSERT INTO wave (id, data) VALUES (?,?)', 1, wave );
+
+    % Stream the waveform window by window
+    [h, bytes] = mksqlite( 'blob_open', 'wave', 'data', 1 );
+    assert( bytes == 8 * NumOfSamples );
+
+    peak = 0;
+    tic;
+    for offset = 0 : 8*WindowSize : bytes-1
+        n = min( 8*WindowSize, bytes - offset );
+        window = mksqlite( 'blob_read', h, offset, n, 'double' );
+        peak = max( peak, max( abs( window ) ) );
+    end
+    fprintf( '%d samples read in windows of %d: %.2fs\n', NumOfSamples, WindowSize, toc );
+    assert( peak == max( abs( wave ) ) );
+
+    window = mksqlite( 'blob_read', h, 8*100, 8*10, 'double' );
+    assert( isequal( window, wave(101:110) ) );
+    mksqlite( 'blob_close', h );
+
+    % Overwrite a part of the waveform in place
+    h = mksqlite( 'blob_open', 'wave', 'data', 1, 1 );
+    mksqlite( 'blob_write', h, 0, zeros( 10, 1 ) );
+    assert( isequal( mksqlite( 'blob_read', h, 0, 8*11, 'double' ), [zeros( 10, 1 ); wave(11)] ) );
+
+    % BLOBs can't grow
+    failed = false;
+    try
+        mksqlite( 'blob_write', h, bytes - 8, [1; 2] );
+    catch ex
+        fprintf( 'Writing beyond BLOB size failed: %s\n', ex.message );
+        failed = true;
+    end
+    assert( failed );
+    mksqlite( 'blob_close', h );
+
+    mksqlite( 'close' );
@@ -0,0 +1,38 @@
+function sqlite_test_bulk_insert
+
+    clear all
+    close all
+    clc
+    dummy = mksqlite('version mex');
+    fprintf( '\n\n' );
+
+    NumOfSamples = 1000000;  % amount of records to create
+
+    mksqlite( 'open', ':memory:' );
+    mksqlite( 'CREATE TABLE data (k INTEGER, x REAL, y REAL)' );
+    old_wrapping = mksqlite( 'param_wrapping', 1 );
+
+    % Numeric matrix, one column per placeholder
+    M = [ (1:NumOfSamples)', rand( NumOfSamples, 2 ) ];
+    tic;
+    mksqlite( 'BEGIN' );
+    mksqlite( 'INSERT INTO data VALUES (?,?,?)', M );
+    mksqlite( 'COMMIT' );
+    fprintf( '%d rows from matrix: %.2fs\n', NumOfSamples, toc );
+
+    result = mksqlite( 'SELECT count(*) AS n, sum(x) AS x FROM data' );
+    assert( result.n == NumOfSamples && abs( result.x - sum( M(:,2) ) ) < 1e-6 );
+
+    % Scalar struct of column vectors, bound by placeholder names
+    mksqlite( 'DELETE FROM data' );
+    s.k = int64( 1:3 )';
+    s.x = [ 1.5; NaN; 3.5 ];
+    s.y = { 1; []; 'three' };
+    mksqlite( 'INSERT INTO data VALUES (:k,:x,:y)', s );
+
+    result = mksqlite( 'SELECT * FROM data ORDER BY k' );
+    assert( numel( result ) == 3 && isempty( result(2).x ) && isempty( result(2).y ) );
+    assert( strcmp( result(3).y, 'three' ) );
+
+    mksqlite( 'param_wrapping', old_wrapping );
+    mksqlite( 'close' );
@@ -0,0 +1,64 @@
+function sqlite_test_cursor
+
+    clear all
+    close all
+    clc
+    dummy = mksqlite('version mex');
+    fprintf( '\n\n' );
+
+    NumOfSamples = 100000;  % amount of records to create
+    ChunkSize    = 8192;    % rows fetched at once
+
+    mksqlite( 'open', ':memory:' );
+    mksqlite( 'CREATE TABLE data (k INTEGER PRIMARY KEY, v REAL)' );
+
+    h = mksqlite( 'prepare', 'INSERT INTO data (k, v) VALUES (?,?)' );
+    mksqlite( 'BEGIN' );
+    for k = 1:NumOfSamples
+        mksqlite( 'exec', h, k, k/2 );
+    end
+    mksqlite( 'COMMIT' );
+    mksqlite( 'finalize', h );
+
+    % Sum up all values chunk by chunk
+    old_type = mksqlite( 'result_type', 1 );  % struct of arrays
+    c = mksqlite( 'cursor_open', 'SELECT k, v FROM data WHERE k > ? ORDER BY k', 0 );
+    total  = 0;
+    rows   = 0;
+    chunks = 0;
+    tic;
+    while true
+        [result, count] = mksqlite( 'cursor_fetch', c, ChunkSize );
+        if ~count, break, end
+        assert( count <= ChunkSize );
+        assert( result.k(1) == rows + 1 );
+        total  = total + sum( result.v );
+        rows   = rows + count;
+        chunks = chunks + 1;
+    end
+    fprintf( '%d rows fetched in %d chunks: %.2fs\n', rows, chunks, toc );
+    assert( rows == NumOfSamples );
+    assert( total == sum( (1:NumOfSamples)/2 ) );
+
+    % Exhausted cursor stays exhausted
+    [result, count] = mksqlite( 'cursor_fetch', c, ChunkSize );
+    assert( count == 0 );
+    mksqlite( 'cursor_close', c );
+
+    % A cursor failing mid-stream reports the error once and is exhausted then
+    % (abs() of the smallest integer raises an overflow at row 6)
+    c = mksqlite( 'cursor_open', 'SELECT abs(CASE WHEN k <= 5 THEN k ELSE -9223372036854775808 END) AS a FROM data' );
+    [result, count] = mksqlite( 'cursor_fetch', c, 5 );
+    assert( count == 5 );
+    try
+        mksqlite( 'cursor_fetch', c, 5 );
+        error( 'cursor_fetch should fail' );
+    catch err
+        fprintf( 'Failed as expected: %s\n', err.message );
+    end
+    [result, count] = mksqlite( 'cursor_fetch', c, 5 );
+    assert( count == 0 );
+    mksqlite( 'cursor_close', c );
+
+    mksqlite( 'result_type', old_type );
+    mksqlite( 'close' );
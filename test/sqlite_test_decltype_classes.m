@@ -0,0 +1,37 @@
+function sqlite_test_decltype_classes
+
+    clear all
+    close all
+    clc
+    dummy = mksqlite('version mex');
+    fprintf( '\n\n' );
+
+    mksqlite( 'open', ':memory:' );
+    mksqlite( 'CREATE TABLE data (a INT16, b REAL4, c BOOL, d UINT8, e INT8)' );
+    mksqlite( 'INSERT INTO data VALUES (-300, 1.5, 1, 200, 5)' );
+    mksqlite( 'INSERT INTO data VALUES (NULL, NULL, 0, 255, 300)' );
+    mksqlite( 'INSERT INTO data VALUES (3, 2.25, 1, 0, 7)' );
+
+    old_flag = mksqlite( 'decltype_classes', 1 );
+    old_type = mksqlite( 'result_type', 3 );  % struct of typed arrays
+    result = mksqlite( 'SELECT * FROM data' );
+
+    % Columns are returned in their declared classes
+    assert( isa( result.a, 'int16' ) && isequal( result.a, int16([-300;0;3]) ) );
+    assert( isequal( result.a_isnull, [false;true;false] ) );
+    assert( isa( result.b, 'single' ) && isnan( result.b(2) ) );
+    assert( islogical( result.c ) && isequal( result.c, [true;false;true] ) );
+    assert( isa( result.d, 'uint8' ) && isequal( result.d, uint8([200;255;0]) ) );
+
+    % Overflow (300 doesn't fit into int8) falls back to common conversion
+    assert( ~isa( result.e, 'int8' ) );
+    disp( result );
+
+    % Struct of arrays: NULLs can't be stored in the declared class
+    mksqlite( 'result_type', 1 );
+    result = mksqlite( 'SELECT a, c FROM data' );
+    assert( iscell( result.a ) && islogical( result.c ) );
+
+    mksqlite( 'result_type', old_type );
+    mksqlite( 'decltype_classes', old_flag );
+    mksqlite( 'close' );
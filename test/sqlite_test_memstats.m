@@ -0,0 +1,66 @@
+function sqlite_test_memstats
+
+    clear all
+    close all
+    clc
+    dummy = mksqlite('version mex');
+    fprintf( '\n\n' );
+
+    NumOfSamples = 100000;  % amount of records to create
+
+    mksqlite( 'open', ':memory:' );
+    mksqlite( 'CREATE TABLE data (id INTEGER, name TEXT, value REAL)' );
+    mksqlite( ['WITH RECURSIVE c(x) AS (SELECT 1 UNION ALL SELECT x+1 FROM c WHERE x<?) ' ...
+               'INSERT INTO data SELECT x, ''name '' || x, random() FROM c'], NumOfSamples );
+
+    result = mksqlite( 'SELECT * FROM data' );
+    mem    = mksqlite( 'memstats' );
+    fprintf( 'SQLite uses %d bytes (peak %d), page cache %d bytes\n', ...
+             mem.memory_used, mem.memory_highwater, mem.cache_used );
+    fprintf( 'Result buffers of last query: %d bytes\n', mem.result_bytes );
+    assert( mem.memory_used > 0 );
+    assert( mem.result_bytes > 0 && mem.result_highwater >= mem.result_bytes );
+
+    % Limit result buffers to half of the size, the same query is aborted now
+    old = mksqlite( 'result_memory_cap', mem.result_bytes / 2 );
+    assert( old == 0 );
+
+    try
+        result = mksqlite( 'SELECT * FROM data' );
+        error( 'memory cap was ignored' );
+    catch err
+        fprintf( 'Aborted as expected: %s\n', err.message );
+        assert( ~isempty( strfind( err.message, 'result_memory_cap' ) ) );
+    end
+
+    % Smaller queries pass
+    result = mksqlite( 'SELECT * FROM data WHERE id <= 10' );
+    assert( numel( result ) == 10 );
+
+    mksqlite( 'result_memory_cap', 0 );
+    mksqlite( 'close' );
+
+    % Queries in background are limited as well, and accounted to the database
+    dbfile = [tempname '.db'];  % tickets need a database file
+    mksqlite( 'open', dbfile );
+    mksqlite( 'CREATE TABLE data (id INTEGER, name TEXT, value REAL)' );
+    mksqlite( ['WITH RECURSIVE c(x) AS (SELECT 1 UNION ALL SELECT x+1 FROM c WHERE x<?) ' ...
+               'INSERT INTO data SELECT x, ''name '' || x, random() FROM c'], NumOfSamples );
+
+    result = mksqlite( 'wait', mksqlite( 'submit', 'SELECT * FROM data' ) );
+    mem    = mksqlite( 'memstats' );
+    assert( mem.result_bytes > 0 );
+
+    mksqlite( 'result_memory_cap', mem.result_bytes / 2 );
+
+    try
+        result = mksqlite( 'wait', mksqlite( 'submit', 'SELECT * FROM data' ) );
+        error( 'memory cap was ignored' );
+    catch err
+        fprintf( 'Aborted as expected: %s\n', err.message );
+        assert( ~isempty( strfind( err.message, 'result_memory_cap' ) ) );
+    end
+
+    mksqlite( 'result_memory_cap', 0 );
+    mksqlite( 'close' );
+    delete( dbfile );
@@ -0,0 +1,44 @@
+function sqlite_test_null_mask
+
+    clear all
+    close all
+    clc
+    dummy = mksqlite('version mex');
+    fprintf( '\n\n' );
+
+    mksqlite( 'open', ':memory:' );
+    mksqlite( 'CREATE TABLE data (a INTEGER, b REAL, c TEXT)' );
+    mksqlite( 'INSERT INTO data VALUES (1, 1.5, ''one'')' );
+    mksqlite( 'INSERT INTO data VALUES (NULL, NULL, NULL)' );
+    mksqlite( 'INSERT INTO data VALUES (3, 3.5, ''three'')' );
+
+    old_mask = mksqlite( 'null_mask', 1 );
+
+    % Struct of arrays: numeric columns stay numeric, NULLs are masked
+    old_type = mksqlite( 'result_type', 1 );
+    result = mksqlite( 'SELECT * FROM data' );
+    assert( isnumeric( result.a ) && isnan( result.a(2) ) );
+    assert( isequal( result.a_isnull, [false;true;false] ) );
+    assert( isequal( result.b_isnull, [false;true;false] ) );
+    assert( iscell( result.c ) && ~isfield( result, 'c_isnull' ) );
+    disp( result );
+
+    % Mask fields are present without NULLs, too
+    result = mksqlite( 'SELECT a, b FROM data WHERE a IS NOT NULL' );
+    assert( isequal( result.a_isnull, [false;false] ) );
+    assert( isequal( result.b_isnull, [false;false] ) );
+
+    % Mask fields don't collide with columns of the same name
+    result = mksqlite( 'SELECT a, b AS a_isnull FROM data' );
+    assert( isequal( result.a_isnull_1, [false;true;false] ) );
+    assert( isnan( result.a_isnull(2) ) );
+
+    % Cell matrix: NULL mask is the 5th output
+    mksqlite( 'result_type', 2 );
+    [result, count, colnames, rowids, isnull] = mksqlite( 'SELECT a, b FROM data' );
+    assert( isnumeric( result ) && isequal( size( result ), [3,2] ) );
+    assert( isequal( isnull, logical([0 0; 1 1; 0 0]) ) );
+
+    mksqlite( 'result_type', old_type );
+    mksqlite( 'null_mask', old_mask );
+    mksqlite( 'close' );
@@ -0,0 +1,41 @@
+function sqlite_test_open_profiles
+
+    clear all
+    close all
+    clc
+    dummy = mksqlite('version mex');
+    fprintf( '\n\n' );
+
+    dbfile = [tempname, '.db'];
+
+    % Open with a profile, page size and cache size are overridden
+    mksqlite( 'open', dbfile, 'analytics', 'page_size', 8192, 'cache_size', -16384 );
+    mksqlite( 'CREATE TABLE data (id INTEGER PRIMARY KEY, value REAL)' );
+
+    result = mksqlite( 'PRAGMA journal_mode' );
+    assert( strcmpi( result.journal_mode, 'wal' ) );
+    result = mksqlite( 'PRAGMA page_size' );
+    assert( result.page_size == 8192 );
+
+    [status, info] = mksqlite( 'status' );
+    assert( strcmp( info.open_profile, 'analytics' ) );
+    assert( strcmp( info.open_settings.cache_size, '-16384' ) );
+    disp( info.open_settings );
+    mksqlite( 'close' );
+
+    % Read-only databases keep their journal mode
+    mksqlite( 'open', dbfile, 'ro', 'safe' );
+    [status, info] = mksqlite( 'status' );
+    assert( ~isfield( info.open_settings, 'journal_mode' ) );
+    assert( strcmp( info.open_settings.synchronous, '2' ) );  % FULL
+    mksqlite( 'close' );
+
+    % Unknown settings are rejected, the database stays closed
+    try
+        mksqlite( 'open', dbfile, 'rw', 'single', 'bogus_setting', 1 );
+        error( 'unknown setting was accepted' );
+    catch err
+        fprintf( 'Rejected as expected: %s\n', err.message );
+    end
+
+    delete( dbfile );
@@ -0,0 +1,51 @@
+function sqlite_test_parallel_pack
+
+    clear all
+    close all
+    clc
+    dummy = mksqlite('version mex');
+    fprintf( '\n\n' );
+
+    NumOfBlobs = 2000;   % amount of compressed BLOBs
+    BlobSize   = 50000;  % samples per BLOB
+
+    mksqlite( 'open', ':memory:' );
+    old_typed   = mksqlite( 'typedBLOBs', 1 );
+    old_wrap    = mksqlite( 'param_wrapping', 1 );
+    old_compr   = mksqlite( 'compression', 'lz4', 9 );
+    mksqlite( 'CREATE TABLE waves (k INTEGER PRIMARY KEY, data BLOB)' );
+
+    % arguments of all rows in one cell: {k1, data1, k2, data2, ...}
+    args = cell( 2, NumOfBlobs );
+    for k = 1:NumOfBlobs
+        args{1,k} = k;
+        args{2,k} = round( 100 * sin( (1:BlobSize)' * k / BlobSize ) );
+    end
+
+    % Pack on the MATLAB thread only
+    old_threads = mksqlite( 'threads', 1 );
+    tic;
+    mksqlite( 'BEGIN' );
+    mksqlite( 'INSERT INTO waves (k, data) VALUES (?,?)', args(:) );
+    mksqlite( 'COMMIT' );
+    fprintf( '%d BLOBs packed by 1 thread: %.2fs\n', NumOfBlobs, toc );
+    serial = mksqlite( 'SELECT data FROM waves ORDER BY k' );
+
+    % Pack ahead with one thread per core
+    mksqlite( 'DELETE FROM waves' );
+    mksqlite( 'threads', 0 );
+    threads = mksqlite( 'threads' );
+    tic;
+    mksqlite( 'BEGIN' );
+    mksqlite( 'INSERT INTO waves (k, data) VALUES (?,?)', args(:) );
+    mksqlite( 'COMMIT' );
+    fprintf( '%d BLOBs packed by %d threads: %.2fs\n', NumOfBlobs, threads, toc );
+    parallel = mksqlite( 'SELECT data FROM waves ORDER BY k' );
+    assert( isequal( serial, parallel ) );
+    assert( isequal( parallel(end).data, args{2,end} ) );
+
+    mksqlite( 'threads', old_threads );
+    mksqlite( 'compression', old_compr{:} );
+    mksqlite( 'param_wrapping', old_wrap );
+    mksqlite( 'typedBLOBs', old_typed );
+    mksqlite( 'close' );
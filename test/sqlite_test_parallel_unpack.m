@@ -0,0 +1,40 @@
+function sqlite_test_parallel_unpack
+
+    clear all
+    close all
+    clc
+    dummy = mksqlite('version mex');
+    fprintf( '\n\n' );
+
+    NumOfBlobs = 2000;   % amount of compressed BLOBs
+    BlobSize   = 50000;  % samples per BLOB
+
+    mksqlite( 'open', ':memory:' );
+    old_typed = mksqlite( 'typedBLOBs', 1 );
+    old_compr = mksqlite( 'compression', 'lz4', 9 );
+    mksqlite( 'CREATE TABLE waves (k INTEGER PRIMARY KEY, data BLOB)' );
+
+    mksqlite( 'BEGIN' );
+    for k = 1:NumOfBlobs
+        mksqlite( 'INSERT INTO waves (k, data) VALUES (?,?)', k, round( 100 * sin( (1:BlobSize)' * k / BlobSize ) ) );
+    end
+    mksqlite( 'COMMIT' );
+
+    % Unpack on the MATLAB thread only
+    old_threads = mksqlite( 'threads', 1 );
+    tic;
+    serial = mksqlite( 'SELECT data FROM waves ORDER BY k' );
+    fprintf( '%d BLOBs unpacked by 1 thread: %.2fs\n', NumOfBlobs, toc );
+
+    % Unpack with one thread per core
+    mksqlite( 'threads', 0 );
+    threads = mksqlite( 'threads' );
+    tic;
+    parallel = mksqlite( 'SELECT data FROM waves ORDER BY k' );
+    fprintf( '%d BLOBs unpacked by %d threads: %.2fs\n', NumOfBlobs, threads, toc );
+    assert( isequal( serial, parallel ) );
+
+    mksqlite( 'threads', old_threads );
+    mksqlite( 'compression', old_compr{:} );
+    mksqlite( 'typedBLOBs', old_typed );
+    mksqlite( 'close' );
@@ -0,0 +1,59 @@
+function sqlite_test_prepare
+
+    clear all
+    close all
+    clc
+    dummy = mksqlite('version mex');
+    fprintf( '\n\n' );
+
+    NumOfSamples = 10000;  % amount of records to create
+
+    mksqlite( 'open', ':memory:' );
+    mksqlite( 'CREATE TABLE data (k INTEGER PRIMARY KEY, v REAL)' );
+
+    % Insert records, each call prepares the statement anew
+    tic;
+    mksqlite( 'BEGIN' );
+    for k = 1:NumOfSamples
+        mksqlite( 'INSERT INTO data (k, v) VALUES (?,?)', k, rand );
+    end
+    mksqlite( 'COMMIT' );
+    fprintf( '%d inserts with common queries: %.2fs\n', NumOfSamples, toc );
+
+    % Insert records again, statement is prepared once
+    mksqlite( 'DELETE FROM data' );
+    h = mksqlite( 'prepare', 'INSERT INTO data (k, v) VALUES (?,?)' );
+    tic;
+    mksqlite( 'BEGIN' );
+    for k = 1:NumOfSamples
+        mksqlite( 'exec', h, k, rand );
+    end
+    mksqlite( 'COMMIT' );
+    fprintf( '%d inserts with statement handle: %.2fs\n', NumOfSamples, toc );
+    mksqlite( 'finalize', h );
+
+    % Point queries, named parameters may be bound by a struct
+    q = mksqlite( 'prepare', 'SELECT k, v FROM data WHERE k=:key' );
+    tic;
+    for k = 1:NumOfSamples
+        result = mksqlite( 'exec', q, k );
+        assert( result.k == k );
+    end
+    fprintf( '%d point queries with statement handle: %.2fs\n', NumOfSamples, toc );
+
+    arg.key = 42;
+    [result, count] = mksqlite( 'exec', q, arg );
+    assert( count == 1 && result.k == 42 );
+
+    mksqlite( 'reset', q );
+    mksqlite( 'finalize', q );
+
+    % Handle is invalid now
+    try
+        mksqlite( 'exec', q, 1 );
+        error( 'Handle should be invalid' );
+    catch err
+        fprintf( 'Expected error: %s\n', err.message );
+    end
+
+    mksqlite( 'close' );
@@ -0,0 +1,43 @@
+function sqlite_test_query_profile
+
+    clear all
+    close all
+    clc
+    dummy = mksqlite('version mex');
+    fprintf( '\n\n' );
+
+    NumOfSamples = 10000;  % amount of records to create
+
+    mksqlite( 'open', ':memory:' );
+    mksqlite( 'CREATE TABLE orders (id INTEGER PRIMARY KEY, customer INTEGER, amount REAL)' );
+    mksqlite( 'CREATE TABLE customers (id INTEGER, name TEXT)' );
+    mksqlite( ['WITH RECURSIVE c(x) AS (SELECT 1 UNION ALL SELECT x+1 FROM c WHERE x<?) ' ...
+               'INSERT INTO orders SELECT x, x % 100, x / 10.0 FROM c'], NumOfSamples );
+    mksqlite( ['WITH RECURSIVE c(x) AS (SELECT 0 UNION ALL SELECT x+1 FROM c WHERE x<99) ' ...
+               'INSERT INTO customers SELECT x, ''customer '' || x FROM c'] );
+
+    sql = ['SELECT c.name, sum(o.amount) AS total FROM orders o JOIN customers c ON c.id = o.customer ' ...
+           'WHERE o.customer = ? GROUP BY c.name'];
+
+    % Without an index on customers.id and orders.customer
+    result  = mksqlite( sql, 42 );
+    profile = mksqlite( 'last_query_profile' );
+    fprintf( 'Without index: %d full scan steps, %d rows autoindexed, %d VM steps\n', ...
+             profile.fullscan_steps, profile.autoindexes, profile.vm_steps );
+    assert( profile.fullscan_steps > 0 );
+    assert( profile.runs == 1 );
+
+    for i = 1:numel( profile.loops )  % SQLITE_ENABLE_STMT_SCANSTATUS only
+        fprintf( '  %s: %d rows visited\n', profile.loops(i).explain, profile.loops(i).visits );
+    end
+
+    % With indices, the full scan is gone
+    mksqlite( 'CREATE INDEX orders_customer ON orders (customer)' );
+    mksqlite( 'CREATE INDEX customers_id ON customers (id)' );
+    result  = mksqlite( sql, 42 );
+    profile = mksqlite( 'last_query_profile' );
+    fprintf( 'With index: %d full scan steps, %d rows autoindexed, %d VM steps\n', ...
+             profile.fullscan_steps, profile.autoindexes, profile.vm_steps );
+    assert( profile.fullscan_steps == 0 );
+
+    mksqlite( 'close' );
@@ -0,0 +1,63 @@
+function sqlite_test_reader_pool
+
+    clear all
+    close all
+    clc
+    dummy = mksqlite('version mex');
+    fprintf( '\n\n' );
+
+    NumOfSamples = 1000000;  % amount of records to create
+    PoolSize     = 4;        % read-only connections
+    dbfile = [tempname '.db'];  % the pool needs a database file
+
+    mksqlite( 'open', dbfile );
+    mksqlite( 'PRAGMA journal_mode=WAL' );
+    mksqlite( 'CREATE TABLE data (v REAL, s TEXT)' );
+    mksqlite( ['WITH RECURSIVE c(x) AS (SELECT 1 UNION ALL SELECT x+1 FROM c WHERE x<?) ' ...
+               'INSERT INTO data SELECT x/2.0, ''row '' || x FROM c'], NumOfSamples );
+
+    old_size = mksqlite( 'reader_pool', PoolSize );
+    old_type = mksqlite( 'result_type', 1 );  % struct of arrays
+
+    sql = 'SELECT rowid AS r, v, s FROM data WHERE rowid BETWEEN ? AND ? AND v > ?';
+
+    tic;
+    [result, count] = mksqlite( sql, 1, NumOfSamples, 100 );
+    fprintf( 'Serial query: %.2fs\n', toc );
+
+    tic;
+    [presult, pcount] = mksqlite( 'parallel_query', sql, 1, NumOfSamples, 100 );
+    fprintf( 'Parallel query on %d connections: %.2fs\n', PoolSize, toc );
+
+    assert( pcount == count );
+    assert( isequal( presult, result ) );
+
+    % The range may span all int64 values
+    [presult, pcount] = mksqlite( 'parallel_query', 'SELECT rowid FROM data WHERE rowid BETWEEN ? AND ?', ...
+                                  intmin( 'int64' ), intmax( 'int64' ) );
+    assert( pcount == NumOfSamples );
+
+    [status, info] = mksqlite( 'status' );
+    assert( info(1).reader_connections == PoolSize );
+
+    % Tickets use the pool connections too
+    for i = 1:PoolSize
+        t(i) = mksqlite( 'submit', 'SELECT count(*) AS n FROM data WHERE rowid > ?', i );
+    end
+    for i = 1:PoolSize
+        result = mksqlite( 'wait', t(i) );
+        assert( result.n == NumOfSamples - i );
+    end
+
+    % Pool connections are read only, writing tickets get a connection of their own
+    t = mksqlite( 'submit', 'INSERT INTO data VALUES (?, ?)', -1, 'ticket' );
+    mksqlite( 'wait', t );
+    result = mksqlite( 'SELECT count(*) AS n FROM data WHERE v < 0' );
+    assert( result.n == 1 );
+    [status, info] = mksqlite( 'status' );
+    assert( info(1).reader_connections == PoolSize );
+
+    mksqlite( 'result_type', old_type );
+    mksqlite( 'close' );
+    mksqlite( 'reader_pool', old_size );
+    delete( dbfile );
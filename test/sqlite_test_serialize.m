@@ -0,0 +1,39 @@
+function sqlite_test_serialize
+
+    clear all
+    close all
+    clc
+    dummy = mksqlite('version mex');
+    fprintf( '\n\n' );
+
+    NumOfSamples = 1000;  % amount of records to create
+
+    % Build a small reference database in memory
+    db1 = mksqlite( 0, 'open', ':memory:' );
+    mksqlite( db1, 'CREATE TABLE ref (id INTEGER PRIMARY KEY, name TEXT, value REAL)' );
+    mksqlite( db1, ['WITH RECURSIVE c(x) AS (SELECT 1 UNION ALL SELECT x+1 FROM c WHERE x<?) ' ...
+                    'INSERT INTO ref (name, value) SELECT ''item '' || x, random() FROM c'], NumOfSamples );
+
+    bytes = mksqlite( db1, 'serialize' );
+    assert( isa( bytes, 'uint8' ) && ~isempty( bytes ) );
+    fprintf( 'Image size: %d bytes\n', numel( bytes ) );
+
+    % The image becomes a live database in a new slot, read-only
+    db2 = mksqlite( 0, 'deserialize', bytes, 'readonly' );
+    result = mksqlite( db2, 'SELECT count(*) AS n FROM ref' );
+    assert( result.n == NumOfSamples );
+
+    try
+        mksqlite( db2, 'DELETE FROM ref' );
+        error( 'read-only database was changed' );
+    catch err
+        fprintf( 'Rejected as expected: %s\n', err.message );
+    end
+
+    % Resizeable images may grow
+    db3 = mksqlite( 0, 'deserialize', bytes );
+    mksqlite( db3, 'INSERT INTO ref (name, value) VALUES (?, ?)', 'new', 1 );
+    result = mksqlite( db3, 'SELECT count(*) AS n FROM ref' );
+    assert( result.n == NumOfSamples + 1 );
+
+    mksqlite( 0, 'close' );
@@ -0,0 +1,40 @@
+function sqlite_test_slow_query_log
+
+    clear all
+    close all
+    clc
+    dummy = mksqlite('version mex');
+    fprintf( '\n\n' );
+
+    NumOfSamples = 100000;  % amount of records to create
+    logfile      = fullfile( pwd, 'mksqlite.log' );
+
+    try
+        old = mksqlite( 'slow_query_log', 0.001 );  % log statements running longer than 1 ms
+    catch err
+        fprintf( 'Slow query log not available: %s\n', err.message );
+        return
+    end
+    assert( old == 0 );
+
+    mksqlite( 'open', ':memory:' );
+    mksqlite( 'CREATE TABLE data (id INTEGER, grp INTEGER, value REAL)' );
+    mksqlite( ['WITH RECURSIVE c(x) AS (SELECT 1 UNION ALL SELECT x+1 FROM c WHERE x<?) ' ...
+               'INSERT INTO data SELECT x, x % 1000, random() FROM c'], NumOfSamples );
+
+    % No index on grp, so this query scans the whole table and gets logged
+    result = mksqlite( 'SELECT grp, avg(value) AS v FROM data WHERE grp > ? GROUP BY grp ORDER BY v', 10 );
+
+    old = mksqlite( 'slow_query_log', 0 );
+    assert( old == 0.001 );
+
+    mksqlite( 'close' );
+
+    fid  = fopen( logfile, 'rt' );
+    text = fread( fid, inf, '*char' )';
+    fclose( fid );
+
+    assert( ~isempty( strfind( text, 'SELECT grp, avg(value)' ) ) );
+    assert( ~isempty( strfind( text, 'query plan:' ) ) );
+    assert( ~isempty( strfind( text, 'SCAN data' ) ) );
+    fprintf( 'Slow queries logged to %s\n', logfile );
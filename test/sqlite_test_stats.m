@@ -0,0 +1,40 @@
+function sqlite_test_stats
+
+    clear all
+    close all
+    clc
+    dummy = mksqlite('version mex');
+    fprintf( '\n\n' );
+
+    NumOfSamples = 100000;  % amount of records to create
+
+    mksqlite( 'open', ':memory:' );
+    old_flag = mksqlite( 'stats', 1 );
+
+    mksqlite( 'CREATE TABLE data (k INTEGER PRIMARY KEY, v REAL, s TEXT)' );
+    mksqlite( ['WITH RECURSIVE c(x) AS (SELECT 1 UNION ALL SELECT x+1 FROM c WHERE x<?) ' ...
+               'INSERT INTO data SELECT x, x/2.0, ''row '' || x FROM c'], NumOfSamples );
+
+    mksqlite( 'stats', 'reset' );
+    result = mksqlite( 'SELECT * FROM data' );
+    stats  = mksqlite( 'stats' );
+
+    assert( stats.enabled == 1 );
+    assert( stats.calls == 1 );
+    assert( stats.rows == NumOfSamples );
+    assert( stats.text_bytes > 0 );
+    parts = stats.prepare_time + stats.step_time + stats.column_time + stats.convert_time + stats.result_time;
+    assert( parts <= stats.total_time );
+
+    fprintf( 'Query of %d rows: %.3fs\n', stats.rows, stats.total_time );
+    fprintf( '  prepare: %.3fs, step: %.3fs, columns: %.3fs, texts: %.3fs, results: %.3fs\n', ...
+             stats.prepare_time, stats.step_time, stats.column_time, stats.convert_time, stats.result_time );
+
+    % Switched off, no more counting
+    mksqlite( 'stats', 0 );
+    result = mksqlite( 'SELECT * FROM data' );
+    stats  = mksqlite( 'stats' );
+    assert( stats.calls == 1 );
+
+    mksqlite( 'stats', old_flag );
+    mksqlite( 'close' );
@@ -0,0 +1,49 @@
+function sqlite_test_stmt_cache
+
+    clear all
+    close all
+    clc
+    dummy = mksqlite('version mex');
+    fprintf( '\n\n' );
+
+    NumOfSamples = 10000;  % amount of records to create
+
+    mksqlite( 'open', ':memory:' );
+    mksqlite( 'CREATE TABLE data (k INTEGER PRIMARY KEY, v REAL)' );
+
+    % Insert records, each call prepares the statement anew
+    old_size = mksqlite( 'stmt_cache', 0 );
+    tic;
+    mksqlite( 'BEGIN' );
+    for k = 1:NumOfSamples
+        mksqlite( 'INSERT INTO data (k, v) VALUES (?,?)', k, rand );
+    end
+    mksqlite( 'COMMIT' );
+    fprintf( '%d inserts without statement cache: %.2fs\n', NumOfSamples, toc );
+
+    % Insert records again, reusing the cached statement
+    mksqlite( 'DELETE FROM data' );
+    mksqlite( 'stmt_cache', 10 );
+    tic;
+    mksqlite( 'BEGIN' );
+    for k = 1:NumOfSamples
+        mksqlite( 'INSERT INTO data (k, v) VALUES (?,?)', k, rand );
+    end
+    mksqlite( 'COMMIT' );
+    fprintf( '%d inserts with statement cache: %.2fs\n', NumOfSamples, toc );
+
+    [status, info] = mksqlite( 'status' );
+    fprintf( 'Database is %s, statement cache: %d entries, %d hits, %d misses\n', ...
+             status, info.stmt_cache_entries, info.stmt_cache_hits, info.stmt_cache_misses );
+    assert( info.stmt_cache_hits >= NumOfSamples - 1 );
+
+    % Schema changes clear the cache
+    mksqlite( 'ALTER TABLE data ADD COLUMN t TEXT' );
+    [~, info] = mksqlite( 'status' );
+    assert( info.stmt_cache_entries == 0 );
+
+    result = mksqlite( 'SELECT * FROM data WHERE k=?', 1 );
+    assert( isfield( result, 't' ) );
+
+    mksqlite( 'stmt_cache', old_size );
+    mksqlite( 'close' );
@@ -0,0 +1,54 @@
+function sqlite_test_text_dictionary
+
+    clear all
+    close all
+    clc
+    dummy = mksqlite('version mex');
+    fprintf( '\n\n' );
+
+    NumOfSamples = 100000;  % amount of records to create
+    states = { 'idle', 'running', 'stopped', 'failed' };
+
+    mksqlite( 'open', ':memory:' );
+    mksqlite( 'CREATE TABLE data (k INTEGER, state TEXT)' );
+    mksqlite( 'BEGIN' );
+    for k = 1:NumOfSamples
+        mksqlite( 'INSERT INTO data VALUES (?,?)', k, states{ mod(k,4)+1 } );
+    end
+    mksqlite( 'INSERT INTO data VALUES (0, NULL)' );
+    mksqlite( 'COMMIT' );
+
+    old_type = mksqlite( 'result_type', 1 );  % struct of arrays
+
+    % Cell array of strings
+    old_mode = mksqlite( 'text_dictionary', 0 );
+    tic;
+    plain = mksqlite( 'SELECT * FROM data ORDER BY k' );
+    fprintf( 'Cell array of strings: %.2fs\n', toc );
+
+    % uint32 codes and dictionary
+    mksqlite( 'text_dictionary', 1 );
+    tic;
+    result = mksqlite( 'SELECT * FROM data ORDER BY k' );
+    fprintf( 'Dictionary encoded:    %.2fs\n', toc );
+
+    assert( isa( result.state, 'uint32' ) && numel( result.state_dict ) == 4 );
+    assert( result.state(1) == 0 );  % NULL
+    assert( isequal( result.state_dict( result.state(2:end) ), plain.state(2:end) ) );
+
+    % Dictionary fields don't collide with columns of the same name
+    result = mksqlite( 'SELECT state, k AS state_dict FROM data ORDER BY k' );
+    assert( numel( result.state_dict_1 ) == 4 && isa( result.state_dict, 'double' ) );
+
+    % Categorical array
+    if ~verLessThan( 'matlab', '8.2' )
+        mksqlite( 'text_dictionary', 2 );
+        result = mksqlite( 'SELECT * FROM data ORDER BY k' );
+        assert( iscategorical( result.state ) && isundefined( result.state(1) ) );
+        assert( isequal( cellstr( result.state(2:end) ), plain.state(2:end) ) );
+        summary( result.state );
+    end
+
+    mksqlite( 'text_dictionary', old_mode );
+    mksqlite( 'result_type', old_type );
+    mksqlite( 'close' );
@@ -0,0 +1,66 @@
+function sqlite_test_tickets
+
+    clear all
+    close all
+    clc
+    dummy = mksqlite('version mex');
+    fprintf( '\n\n' );
+
+    NumOfSamples = 1000000;  % amount of records to create
+    dbfile = [tempname '.db'];  % tickets need a database file
+
+    mksqlite( 'open', dbfile );
+    mksqlite( 'CREATE TABLE data (k INTEGER PRIMARY KEY, v REAL)' );
+    old_wrapping = mksqlite( 'param_wrapping', 1 );
+    mksqlite( 'BEGIN' );
+    mksqlite( 'INSERT INTO data (k, v) VALUES (?,?)', [(1:NumOfSamples)', (1:NumOfSamples)'/2] );
+    mksqlite( 'COMMIT' );
+    mksqlite( 'param_wrapping', old_wrapping );
+
+    old_type = mksqlite( 'result_type', 1 );  % struct of arrays
+
+    % Run an aggregation in the background, while MATLAB continues
+    sql = 'SELECT k % 10 AS g, count(*) AS n, sum(v) AS s FROM data WHERE k > ? GROUP BY g';
+    tic;
+    t = mksqlite( 'submit', sql, 0 );
+    fprintf( 'Query submitted: %.3fs\n', toc );
+
+    % The own connection is still available meanwhile
+    result = mksqlite( 'SELECT count(*) AS n FROM data' );
+    assert( result.n == NumOfSamples );
+
+    polls = 0;
+    while ~mksqlite( 'poll', t )
+        polls = polls + 1;
+        pause( 0.01 );
+    end
+    [result, count, colnames] = mksqlite( 'wait', t );
+    fprintf( 'Query finished after %d polls: %.3fs\n', polls, toc );
+    assert( count == 10 );
+    assert( isequal( colnames, {'g'; 'n'; 's'} ) );
+    assert( isequal( result, mksqlite( sql, 0 ) ) );
+
+    % The ticket was released by 'wait'
+    failed = false;
+    try
+        mksqlite( 'wait', t );
+    catch ex
+        fprintf( 'Released ticket: %s\n', ex.message );
+        failed = true;
+    end
+    assert( failed );
+
+    % Waiting with a timeout keeps the ticket valid, if the query runs longer
+    t = mksqlite( 'submit', 'SELECT sum(a.v * b.v) AS s FROM data a, data b WHERE b.k < 100' );
+    result = mksqlite( 'wait', t, 0 );
+    if isempty( result )
+        fprintf( 'Query still running...\n' );
+        result = mksqlite( 'wait', t );
+    end
+    assert( isfield( result, 's' ) );
+
+    % Closing the database cancels pending tickets
+    t = mksqlite( 'submit', 'WITH RECURSIVE c(x) AS (SELECT 1 UNION ALL SELECT x+1 FROM c) SELECT max(x) FROM c' );
+    mksqlite( 'result_type', old_type );
+    mksqlite( 'close' );
+    delete( dbfile );
@@ -0,0 +1,33 @@
+function sqlite_test_typed_columns
+
+    clear all
+    close all
+    clc
+    dummy = mksqlite('version mex');
+    fprintf( '\n\n' );
+
+    mksqlite( 'open', ':memory:' );
+    mksqlite( 'CREATE TABLE data (id INTEGER, big INTEGER, val REAL, name TEXT)' );
+    mksqlite( 'INSERT INTO data VALUES (1, 9007199254740993, 1.5, ''one'')' );
+    mksqlite( 'INSERT INTO data VALUES (2, NULL, NULL, ''two'')' );
+    mksqlite( 'INSERT INTO data VALUES (3, 3, 3.5, NULL)' );
+
+    old_type = mksqlite( 'result_type', 3 );  % struct of typed arrays
+    result = mksqlite( 'SELECT * FROM data ORDER BY id' );
+
+    % INTEGER columns are int64 arrays, even with large values and NULLs
+    assert( isa( result.id, 'int64' ) && isequal( result.id, int64([1;2;3]) ) );
+    assert( ~isfield( result, 'id_isnull' ) );
+    assert( isa( result.big, 'int64' ) && result.big(1) == int64(9007199254740993) );
+    assert( isequal( result.big_isnull, [false;true;false] ) );
+
+    % REAL columns are double arrays, NULLs are NaN and masked
+    assert( isa( result.val, 'double' ) && isnan( result.val(2) ) );
+    assert( isequal( result.val_isnull, [false;true;false] ) );
+
+    % TEXT columns are cell arrays
+    assert( iscell( result.name ) && isempty( result.name{3} ) );
+    disp( result );
+
+    mksqlite( 'result_type', old_type );
+    mksqlite( 'close' );
@@ -0,0 +1,34 @@
+function sqlite_test_unique_fields
+
+    clear all
+    close all
+    clc
+    dummy = mksqlite('version mex');
+    fprintf( '\n\n' );
+
+    NumOfColumns = 2000;  % amount of columns to create
+    NumOfRuns    = 20;    % repeated executions
+
+    db = mksqlite( 0, 'open', ':memory:' );
+    mksqlite( db, 'check4uniquefields', 1 );
+    mksqlite( db, 'stmt_cache', 10 );
+
+    % Equal column names get consecutive numbers, names in use are skipped
+    result = mksqlite( db, 'SELECT 1 AS a_1, 2 AS a, 3 AS a, 4 AS a' );
+    assert( isequal( fieldnames( result ), {'a_1'; 'a'; 'a_2'; 'a_3'} ) );
+
+    % Wide result with many equal column names (pivoted channels)
+    columns = arrayfun( @(i) sprintf( '%d AS ch%d', i, mod( i, 40 ) ), 1:NumOfColumns, 'UniformOutput', false );
+    query   = ['SELECT ', strjoin( columns, ', ' )];
+
+    tic;
+    for i = 1:NumOfRuns
+        result = mksqlite( db, query );
+    end
+    fprintf( '%d runs with %d columns: %.3f s\n', NumOfRuns, NumOfColumns, toc );
+
+    names = fieldnames( result );
+    assert( numel( names ) == NumOfColumns );
+    assert( numel( unique( names ) ) == NumOfColumns );
+
+    mksqlite( db, 'close' );
@@ -21,6 +21,15 @@
 //#include "config.h"
 #include "global.hpp"
 //#include "locale.hpp"
+#include <functional>
+
+/* SSE2 is available on all x86-64 targets, used for the ASCII fast path of the text conversion */
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+  #include <emmintrin.h>
+  #define MKSQLITE_HAVE_SSE2 1
+#else
+  #define MKSQLITE_HAVE_SSE2 0
+#endif
 
 /* helper functions, formard declarations */
 #if defined( MATLAB_MEX_FILE)
@@ -35,6 +44,7 @@ template<class T> void    utils_free_ptr          ( T *&pmxarr );
                   double  utils_get_wall_time     ();
                   double  utils_get_cpu_time      ();
                   char*   utils_strlwr            ( char* );
+                  void    utils_parallel_for      ( size_t count, int threads, const std::function<void(size_t)>& fcn );
 
 
 #ifdef MAIN_MODULE
@@ -124,80 +134,160 @@ size_t utils_elbytes( mxClassID classID )
 #endif
 
 /**
- * @brief Convert UTF-8 string to char string
+ * @brief Count the leading ASCII characters (below 128) of a string
+ *
+ * @param [in]  s input string
+ * @param [in]  len length of \p s in bytes
+ * @returns count of leading bytes below 128
+ *
+ * Tests 16 bytes at once with SSE2, or 8 bytes as one word otherwise.
+ */
+static inline
+size_t utils_ascii_span( const unsigned char *s, size_t len )
+{
+    size_t i = 0;
+
+#if MKSQLITE_HAVE_SSE2
+    for( ; i + 16 <= len; i += 16 )
+    {
+        if( _mm_movemask_epi8( _mm_loadu_si128( (const __m128i*)( s + i ) ) ) )
+        {
+            break;
+        }
+    }
+#else
+    for( ; i + 8 <= len; i += 8 )
+    {
+        uint64_t word;
+
+        memcpy( &word, s + i, sizeof( word ) );
+        if( word & 0x8080808080808080ULL )
+        {
+            break;
+        }
+    }
+#endif
+
+    while( i < len && s[i] < 128 )
+    {
+        i++;
+    }
+
+    return i;
+}
+
+/**
+ * @brief Convert UTF-8 string of known length to char string
  *
  * @param [in]  s input string UTF8 encoded
+ * @param [in]  len length of \p s in bytes (without NUL)
  * @param [out] buffer optional pointer to where the string should be written (NULL allowed)
  * @returns always the count of bytes written (or needed) to convert input string (including NUL)
  */
-int utils_utf2latin( const unsigned char *s, unsigned char *buffer = NULL )
+static
+int utils_utf2latin_n( const unsigned char *s, size_t len, unsigned char *buffer )
 {
-    int cnt = 0;
-    unsigned char ch, *p = buffer ? buffer : &ch;
+    size_t i = 0, cnt = 0;
 
-    if( s ) 
+    while( i < len )
     {
-        while( *s ) 
+        // ASCII characters are copied as block
+        size_t n = utils_ascii_span( s + i, len - i );
+
+        if( buffer )
         {
-            if( *s < 128 ) 
-            {
-                *p = *s++;
-            }
-            else 
-            {
-                *p = ( s[0] << 6 ) | ( s[1] & 63 );
-                s += 2;
-            }
-            if( buffer ) 
+            memcpy( buffer + cnt, s + i, n );
+        }
+        i += n;
+        cnt += n;
+
+        while( i < len && s[i] >= 128 )
+        {
+            if( buffer )
             {
-                p++;
+                buffer[cnt] = (unsigned char)( ( s[i] << 6 ) | ( s[i+1] & 63 ) );
             }
+            // a truncated sequence must not skip the terminating NUL
+            i += ( i + 1 < len ) ? 2 : 1;
             cnt++;
         }
-        *p = 0;
-        cnt++;
     }
 
-    return cnt;
+    if( buffer )
+    {
+        buffer[cnt] = 0;
+    }
+
+    return (int)cnt + 1;
 }
 
 /**
- * @brief Convert char string to UTF-8 string
+ * @brief Convert char string of known length to UTF-8 string
  *
  * @param [in]  s input string 
+ * @param [in]  len length of \p s in bytes (without NUL)
  * @param [out] buffer optional pointer to where the string should be written (NULL allowed)
  * @returns always the count of bytes written (or needed) to convert input string (including NUL)
  */
-int utils_latin2utf( const unsigned char *s, unsigned char *buffer = NULL )
+static
+int utils_latin2utf_n( const unsigned char *s, size_t len, unsigned char *buffer )
 {
-    int cnt = 0;
-    unsigned char ch[2], *p = buffer ? buffer : ch;
+    size_t i = 0, cnt = 0;
 
-    if( s ) 
+    while( i < len )
     {
-        while( *s ) 
+        // ASCII characters are copied as block
+        size_t n = utils_ascii_span( s + i, len - i );
+
+        if( buffer )
         {
-            if( *s < 128 ) 
-            {
-                *p++ = *s++;
-                cnt++;
-            }
-            else 
-            {
-                *p++ = 128 + 64 + ( *s >> 6 );
-                *p++ = 128 + ( *s++ & 63 );
-                cnt += 2;
-            }
-            if( !buffer ) 
+            memcpy( buffer + cnt, s + i, n );
+        }
+        i += n;
+        cnt += n;
+
+        while( i < len && s[i] >= 128 )
+        {
+            if( buffer )
             {
-                p = ch;
+                buffer[cnt]   = (unsigned char)( 128 + 64 + ( s[i] >> 6 ) );
+                buffer[cnt+1] = (unsigned char)( 128 + ( s[i] & 63 ) );
             }
+            i++;
+            cnt += 2;
         }
-        *p = 0;
-        cnt++;
     }
 
-    return cnt;
+    if( buffer )
+    {
+        buffer[cnt] = 0;
+    }
+
+    return (int)cnt + 1;
+}
+
+/**
+ * @brief Convert UTF-8 string to char string
+ *
+ * @param [in]  s input string UTF8 encoded
+ * @param [out] buffer optional pointer to where the string should be written (NULL allowed)
+ * @returns always the count of bytes written (or needed) to convert input string (including NUL)
+ */
+int utils_utf2latin( const unsigned char *s, unsigned char *buffer = NULL )
+{
+    return s ? utils_utf2latin_n( s, strlen( (const char*)s ), buffer ) : 0;
+}
+
+/**
+ * @brief Convert char string to UTF-8 string
+ *
+ * @param [in]  s input string 
+ * @param [out] buffer optional pointer to where the string should be written (NULL allowed)
+ * @returns always the count of bytes written (or needed) to convert input string (including NUL)
+ */
+int utils_latin2utf( const unsigned char *s, unsigned char *buffer = NULL )
+{
+    return s ? utils_latin2utf_n( s, strlen( (const char*)s ), buffer ) : 0;
 }
 
 
@@ -207,36 +297,29 @@ int utils_latin2utf( const unsigned char *s, unsigned char *buffer = NULL )
  * @param [in] s input string
  * @param [in] flagConvertUTF8 String \p s expected UTF8 encoded, if flag is set
  * @returns pointer to created duplicate (allocator @ref MEM_ALLOC) and must be freed with @ref MEM_FREE
+ *
+ * The string is converted in one pass, since it never grows by recoding to char.
  */
 char* utils_strnewdup(const char* s, int flagConvertUTF8 )
 {
     char *newstr = 0;
-    
-    if( flagConvertUTF8 )
+
+    if( s )
     {
-        if( s )
-        {
-            /* get memory space needed */
-            int buflen = utils_utf2latin( (unsigned char*)s, NULL );
+        size_t len = strlen( s );
 
-            newstr = (char*)MEM_ALLOC( buflen, sizeof(char) );
-            if( newstr ) 
+        newstr = (char*)MEM_ALLOC( len + 1, sizeof(char) );
+        if( newstr )
+        {
+            if( flagConvertUTF8 )
             {
-                utils_utf2latin( (unsigned char*)s, (unsigned char*)newstr );
+                utils_utf2latin_n( (const unsigned char*)s, len, (unsigned char*)newstr );
             }
-        }
-    }
-    else
-    {
-        if( s )
-        {
-            newstr = (char*)MEM_ALLOC( strlen(s) + 1, sizeof(char) );
-            if( newstr )
+            else
             {
-                strcpy( newstr, s );
+                memcpy( newstr, s, len + 1 );
             }
         }
-
     }
     
     return newstr;
@@ -409,4 +492,53 @@ double utils_get_cpu_time()
 #endif
 
 
+#include <thread>
+#include <atomic>
+#include <vector>
+
+/**
+ * @brief Call a function for each index by a number of threads
+ * @details The calling thread takes part, so \p threads-1 worker threads
+ *          are started. Worker threads must not call any MATLAB API function!
+ *          If a thread can't be started, the others do its work.
+ * 
+ * @param count Number of indices (0..count-1)
+ * @param threads Number of threads to use
+ * @param fcn Function to call with each index
+ */
+void utils_parallel_for( size_t count, int threads, const std::function<void(size_t)>& fcn )
+{
+    std::atomic<size_t>         next( 0 );
+    std::vector<std::thread>    workers;
+
+    // each thread fetches the next index, until all are done
+    std::function<void()> work = [&next, count, &fcn]()
+    {
+        for( size_t i = next++; i < count; i = next++ )
+        {
+            fcn( i );
+        }
+    };
+
+    for( int i = 1; i < threads && (size_t)i < count; i++ )
+    {
+        try
+        {
+            workers.push_back( std::thread( work ) );
+        }
+        catch( ... )
+        {
+            break;
+        }
+    }
+
+    work();
+
+    for( size_t i = 0; i < workers.size(); i++ )
+    {
+        workers[i].join();
+    }
+}
+
+
 #endif  /* MAIN_MODULE */
@@ -22,6 +22,7 @@
 
 //#include "config.h"
 #include "global.hpp"
+#include "utils.hpp"
 #include "sqlite/sqlite3.h"
 #include <string>
 #include <vector>
@@ -29,6 +30,8 @@
 #include <string>
 #include <algorithm>
 #include <memory>
+#include <unordered_map>
+#include <type_traits>
 
 using namespace std;
 
@@ -432,6 +435,24 @@ public:
         return m_pcItem ? mxIsComplex( m_pcItem ) : false;
     }
 
+    /**
+     * \brief Returns true if item is not NULL and sparse
+     */
+    inline
+    bool IsSparse() const
+    {
+        return m_pcItem ? mxIsSparse( m_pcItem ) : false;
+    }
+
+    /**
+     * \brief Returns true if item is a numeric or logical array
+     */
+    inline
+    bool IsNumeric() const
+    {
+        return m_pcItem ? ( mxIsNumeric( m_pcItem ) || mxIsLogical( m_pcItem ) ) : false;
+    }
+
     /**
      * \brief Returns true if item consists of exact 1 element
      */
@@ -632,12 +653,11 @@ public:
         // convert to UFT
         if( flagUTF )
         {
-            char *buffer = NULL;
-            int buflen;
+            size_t len    = strlen( result );
+            char*  buffer = NULL;
 
-            /* get only the buffer size needed */
-            buflen = utils_latin2utf( (unsigned char*)result, (unsigned char*)buffer );
-            buffer = (char*) MEM_ALLOC( buflen, sizeof(char) );
+            /* each character takes 2 bytes at most, so one pass converts the string */
+            buffer = (char*) MEM_ALLOC( 2 * len + 1, sizeof(char) );
 
             if( !buffer )
             {
@@ -646,7 +666,7 @@ public:
             }
 
             /* encode string to utf now */
-            ::utils_latin2utf( (unsigned char*)result, (unsigned char*)buffer );
+            ::utils_latin2utf_n( (unsigned char*)result, len, (unsigned char*)buffer );
 
             ::utils_free_ptr( result );
 
@@ -761,6 +781,43 @@ public:
     }
 
 
+    /**
+     * \brief Get the number of a field in a struct array
+     *
+     * \param name Name of the requested field
+     * \returns Field number, or -1 if struct has no such field
+     */
+    int GetFieldNumber( const char* name ) const
+    {
+        return m_pcItem ? mxGetFieldNumber( m_pcItem, name ) : -1;
+    }
+
+
+    /**
+     * \brief Get field from a struct array by its field number
+     *
+     * \param n Index of the array
+     * \param fieldnum Number of the requested field (see GetFieldNumber())
+     * \returns Handle to mxArray
+     */
+    const mxArray* GetFieldByNumber( int n, int fieldnum ) const
+    {
+        mxArray* result = NULL;
+        
+        if( m_pcItem && fieldnum >= 0 )
+        {
+            result = mxGetFieldByNumber( m_pcItem, n, fieldnum );
+
+            if( !result )
+            {
+                // Same workaround as in GetField(): non-initialized member
+                result = mxCreateNumericMatrix( 0, 1, mxDOUBLE_CLASS, mxREAL );
+            }
+        }
+        return result;
+    }
+
+
     /**
      * @brief Sets a cell of a MATLAB cell array
      * 
@@ -1028,6 +1085,153 @@ public:
 };
 
 
+/**
+ * \brief Growable buffer for column values of native type
+ *
+ * Memory is allocated by the MATLAB memory manager (mxMalloc), not by 
+ * \ref MEM_ALLOC, so it can be adopted by a MATLAB array (mxSetData()) 
+ * without copying.
+ */
+template<typename T>
+class ValueSQLBuffer
+{
+    T*      m_data;      ///< buffer (mxMalloc)
+    size_t  m_size;      ///< number of elements used
+    size_t  m_capacity;  ///< number of elements allocated
+
+public:
+    /// Standard ctor
+    ValueSQLBuffer() : m_data( NULL ), m_size( 0 ), m_capacity( 0 )
+    {}
+
+    /// Copy ctor (deep copy)
+    ValueSQLBuffer( const ValueSQLBuffer& other ) : m_data( NULL ), m_size( 0 ), m_capacity( 0 )
+    {
+        *this = other;
+    }
+
+    /// Dtor
+    ~ValueSQLBuffer()
+    {
+        clear();
+    }
+
+    /// Assignment operator (deep copy)
+    ValueSQLBuffer& operator=( const ValueSQLBuffer& other )
+    {
+        if( this != &other )
+        {
+            clear();
+            reserve( other.m_size );
+
+            if( other.m_size )
+            {
+                memcpy( m_data, other.m_data, other.m_size * sizeof(T) );
+            }
+            m_size = other.m_size;
+        }
+        return *this;
+    }
+
+    /// Ensure space for at least \p count elements
+    void reserve( size_t count )
+    {
+        if( count > m_capacity )
+        {
+            m_data     = (T*)( m_data ? mxRealloc( m_data, count * sizeof(T) ) : mxMalloc( count * sizeof(T) ) );
+            m_capacity = count;
+        }
+    }
+
+    /// Appends a new element, buffer grows exponentially
+    void push_back( const T& value )
+    {
+        if( m_size == m_capacity )
+        {
+            reserve( m_capacity ? 2 * m_capacity : 64 );
+        }
+        m_data[m_size++] = value;
+    }
+
+    /// Appends \p count uninitialized elements and returns a pointer to the first one
+    T* grow( size_t count )
+    {
+        if( m_size + count > m_capacity )
+        {
+            reserve( std::max( m_size + count, m_capacity ? 2 * m_capacity : 64 ) );
+        }
+        m_size += count;
+        return m_data + m_size - count;
+    }
+
+    /// Exchange contents with \p other
+    void swap( ValueSQLBuffer& other )
+    {
+        std::swap( m_data, other.m_data );
+        std::swap( m_size, other.m_size );
+        std::swap( m_capacity, other.m_capacity );
+    }
+
+    /// Returns the element count
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    /// Returns the buffer
+    T* data()
+    {
+        return m_data;
+    }
+
+    /// Indexing operator
+    T& operator[]( size_t index )
+    {
+        return m_data[index];
+    }
+
+    /// Free buffer
+    void clear()
+    {
+        if( m_data )
+        {
+            mxFree( m_data );
+        }
+        m_data     = NULL;
+        m_size     = 0;
+        m_capacity = 0;
+    }
+
+    /**
+     * \brief Hand over the buffer
+     *
+     * The buffer is shrunk to its element count, the caller takes the 
+     * ownership (i.e. by mxSetData()). Buffer is empty afterwards.
+     *
+     * \returns Buffer (mxMalloc), or NULL if empty
+     */
+    T* release()
+    {
+        T* data = NULL;
+
+        if( m_size )
+        {
+            data = ( m_size < m_capacity ) ? (T*)mxRealloc( m_data, m_size * sizeof(T) ) : m_data;
+        }
+        else if( m_data )
+        {
+            mxFree( m_data );
+        }
+
+        m_data     = NULL;
+        m_size     = 0;
+        m_capacity = 0;
+
+        return data;
+    }
+};
+
+
 /**
  * \brief Class encapsulating a complete SQL table column with type and name
  *
@@ -1046,18 +1250,33 @@ public:
     string m_col_name;  ///< Table column name (SQL)
     string m_name;      ///< Table column name (MATLAB)
     bool   m_isAnyType; ///< true, if it's pure double (integer) type
+    bool   m_isTyped;   ///< true, if integer columns are kept as int64 and NULLs are masked
+    bool   m_isMasked;  ///< true, if NULLs are masked (typed columns or NULL mask flag set)
+    bool   m_isInteger; ///< true, if it's pure int64 type (typed columns only)
+    size_t m_nullCount; ///< number of masked NULL row elements (masked columns only)
+    mxClassID m_class;  ///< MATLAB class of \a m_native, or mxUNKNOWN_CLASS
+    bool   m_isDict;    ///< true, if TEXT row elements are stored as dictionary codes
     
     /// Holds one table column name (first=SQL name, second=MATLAB name)
     typedef pair<string,string>    StringPair;
     typedef vector<StringPair>     StringPairList;  ///< list of string pairs
 
-    vector<ValueSQL>  m_any;    ///< row elements with type information
-    vector<double>    m_float;  ///< row elements as pure double type
+    vector<ValueSQL>                m_any;    ///< row elements with type information
+    ValueSQLBuffer<double>          m_float;  ///< row elements as pure double type (adoptable by MATLAB arrays)
+    ValueSQLBuffer<sqlite3_int64>   m_int;    ///< row elements as pure int64 type (typed columns only)
+    ValueSQLBuffer<mxLogical>       m_isnull; ///< NULL mask for \a m_float, \a m_int or \a m_native (masked columns only)
+    ValueSQLBuffer<unsigned char>   m_native; ///< row elements of MATLAB class \a m_class (declared column type)
+    ValueSQLBuffer<unsigned int>    m_codes;  ///< row elements as dictionary codes (1 based, 0=NULL)
+    vector<string>                  m_dict;   ///< dictionary of distinct TEXT values (MATLAB encoding)
+    unordered_map<string,unsigned int> m_dictIndex; ///< dictionary codes by TEXT value (SQL encoding)
     
     /// Ctor with column name-pair
     ValueSQLCol( StringPair name )
-    : m_col_name(name.first)/*SQL*/, m_name(name.second)/*MATLAB*/, m_isAnyType(false)
+    : m_col_name(name.first)/*SQL*/, m_name(name.second)/*MATLAB*/, m_isAnyType(false),
+      m_isTyped( g_result_type == RESULT_TYPE_TYPEDCOLUMNS ), m_isInteger(false), m_nullCount(0), m_class(mxUNKNOWN_CLASS), m_isDict(false)
     {
+        m_isMasked = m_isTyped ||
+                     ( g_null_mask && ( g_result_type == RESULT_TYPE_STRUCTOFARRAYS || g_result_type == RESULT_TYPE_MATRIX ) );
     }
     
     /**
@@ -1089,7 +1308,149 @@ public:
     /// Returns the row count
     size_t size()
     {
-        return m_isAnyType ? m_any.size() : m_float.size();
+        if( m_isDict )
+        {
+            return m_codes.size();
+        }
+        
+        if( isNative() )
+        {
+            return m_native.size() / classSize( m_class );
+        }
+        
+        return m_isAnyType ? m_any.size() : ( m_isInteger ? m_int.size() : m_float.size() );
+    }
+    
+    /// Returns true, if row elements are stored in MATLAB class \a m_class
+    bool isNative()
+    {
+        return m_class != mxUNKNOWN_CLASS;
+    }
+    
+    /// Returns the element size of MATLAB classes supported for declared column types
+    static
+    size_t classSize( mxClassID classID )
+    {
+        switch( classID )
+        {
+            case mxLOGICAL_CLASS:
+            case mxINT8_CLASS:
+            case mxUINT8_CLASS:   return 1;
+            case mxINT16_CLASS:
+            case mxUINT16_CLASS:  return 2;
+            case mxINT32_CLASS:
+            case mxUINT32_CLASS:
+            case mxSINGLE_CLASS:  return 4;
+            case mxINT64_CLASS:
+            case mxUINT64_CLASS:  return 8;
+            default:              return 0;
+        }
+    }
+    
+    /**
+     * \brief Store row elements in a MATLAB class (declared column type)
+     *
+     * Only permitted before any row element is appended. If a value isn't
+     * representable by this class, the column falls back to the common storage.
+     */
+    void setNativeClass( mxClassID classID )
+    {
+        assert( !size() );
+        m_class = classSize( classID ) ? classID : mxUNKNOWN_CLASS;
+    }
+    
+    /**
+     * \brief Store TEXT row elements as dictionary codes
+     *
+     * Only permitted before any row element is appended. Each distinct TEXT
+     * value is converted and stored once. If a numeric value or a BLOB is 
+     * appended, the column falls back to the common storage.
+     */
+    void setDictionary()
+    {
+        assert( !size() );
+        m_isDict = !isNative();
+    }
+    
+    /**
+     * \brief Appends a TEXT row element to a dictionary column
+     *
+     * \param[in] text TEXT value as fetched from SQLite
+     * \returns false, if column isn't a dictionary column or memory is exhausted
+     */
+    bool appendDictText( const char* text )
+    {
+        if( !m_isDict )
+        {
+            return false;
+        }
+        
+        unordered_map<string,unsigned int>::iterator it = m_dictIndex.find( text );
+        
+        if( it != m_dictIndex.end() )
+        {
+            m_codes.push_back( it->second );
+            return true;
+        }
+        
+        // new distinct value, convert and add to dictionary
+        char* item = ::utils_strnewdup( text, g_convertUTF8 );
+        
+        if( !item )
+        {
+            return false;
+        }
+        
+        m_dict.push_back( item );
+        ::utils_free_ptr( item );
+        
+        unsigned int code = (unsigned int)m_dict.size();
+        m_dictIndex[text] = code;
+        m_codes.push_back( code );
+        return true;
+    }
+    
+    /**
+     * \brief Transform storage from dictionary codes to common storage
+     *
+     * Each row element is appended again with common storage rules.
+     */
+    void swapFromDict()
+    {
+        if( m_isDict )
+        {
+            ValueSQLBuffer<unsigned int> codes;
+            vector<string>               dict;
+            
+            codes.swap( m_codes );
+            dict.swap( m_dict );
+            m_dictIndex.clear();
+            m_isDict = false;
+            
+            for( int i = 0; i < (int)codes.size(); i++ )
+            {
+                if( codes[i] )
+                {
+                    append( ::utils_strnewdup( dict[codes[i] - 1].c_str(), /*flagConvertUTF8*/ false ) );
+                }
+                else
+                {
+                    append( (const ValueSQL&)ValueSQL() );
+                }
+            }
+        }
+    }
+    
+    /// Returns true, if any row element is a masked NULL
+    bool hasNull()
+    {
+        return m_nullCount > 0;
+    }
+    
+    /// Returns true, if row element is a masked NULL
+    bool isNull( int index )
+    {
+        return hasNull() && !m_isAnyType && m_isnull[index];
     }
     
     /**
@@ -1100,49 +1461,368 @@ public:
      */
     const ValueSQL operator[]( int index )
     {
-        return m_isAnyType ? const_cast<const ValueSQL&>(m_any[index]) : ValueSQL( m_float[index] );
+        if( m_isAnyType )
+        {
+            return const_cast<const ValueSQL&>(m_any[index]);
+        }
+        
+        if( isNull( index ) )
+        {
+            return ValueSQL();
+        }
+        
+        if( isNative() )
+        {
+            return nativeItem( m_native.data(), m_class, index );
+        }
+        
+        return m_isInteger ? ValueSQL( m_int[index] ) : ValueSQL( m_float[index] );
+    }
+    
+    /// Returns a row element from \p data stored in MATLAB class \p classID
+    static
+    ValueSQL nativeItem( const unsigned char* data, mxClassID classID, int index )
+    {
+        switch( classID )
+        {
+            case mxLOGICAL_CLASS: return ValueSQL( (sqlite3_int64)((mxLogical*)data)[index] );
+            case mxINT8_CLASS:    return ValueSQL( (sqlite3_int64)((int8_t*)data)[index] );
+            case mxUINT8_CLASS:   return ValueSQL( (sqlite3_int64)((uint8_t*)data)[index] );
+            case mxINT16_CLASS:   return ValueSQL( (sqlite3_int64)((int16_t*)data)[index] );
+            case mxUINT16_CLASS:  return ValueSQL( (sqlite3_int64)((uint16_t*)data)[index] );
+            case mxINT32_CLASS:   return ValueSQL( (sqlite3_int64)((int32_t*)data)[index] );
+            case mxUINT32_CLASS:  return ValueSQL( (sqlite3_int64)((uint32_t*)data)[index] );
+            case mxINT64_CLASS:   return ValueSQL( (sqlite3_int64)((int64_t*)data)[index] );
+            case mxUINT64_CLASS:  return ValueSQL( (sqlite3_int64)((uint64_t*)data)[index] );  // stored from int64 values only
+            case mxSINGLE_CLASS:  return ValueSQL( (double)((float*)data)[index] );
+            default:              assert( false ); return ValueSQL();
+        }
+    }
+    
+    /// Returns true, if \p item is negative (signed types)
+    template<typename T>
+    static bool isNegative( T item, std::true_type )
+    {
+        return item < 0;
+    }
+    
+    /// Returns false, unsigned types and logicals are never negative
+    template<typename T>
+    static bool isNegative( T, std::false_type )
+    {
+        return false;
+    }
+    
+    /// Appends an integer in MATLAB class T, if it's representable
+    template<typename T>
+    bool appendNativeInt( sqlite3_int64 value )
+    {
+        T item = (T)value;
+        
+        // overflow check: value must survive the round trip with same sign
+        if( (sqlite3_int64)item != value || ( value < 0 ) != isNegative( item, std::is_signed<T>() ) )
+        {
+            return false;
+        }
+        
+        *(T*)m_native.grow( sizeof(T) ) = item;
+        return true;
+    }
+    
+    /// Appends an integer to a column of MATLAB class \a m_class
+    bool appendNative( sqlite3_int64 value )
+    {
+        bool ok = false;
+        
+        switch( m_class )
+        {
+            case mxLOGICAL_CLASS: ok = ( value == 0 || value == 1 ) && appendNativeInt<mxLogical>( value ); break;
+            case mxINT8_CLASS:    ok = appendNativeInt<int8_t>( value );   break;
+            case mxUINT8_CLASS:   ok = appendNativeInt<uint8_t>( value );  break;
+            case mxINT16_CLASS:   ok = appendNativeInt<int16_t>( value );  break;
+            case mxUINT16_CLASS:  ok = appendNativeInt<uint16_t>( value ); break;
+            case mxINT32_CLASS:   ok = appendNativeInt<int32_t>( value );  break;
+            case mxUINT32_CLASS:  ok = appendNativeInt<uint32_t>( value ); break;
+            case mxINT64_CLASS:   ok = appendNativeInt<int64_t>( value );  break;
+            case mxUINT64_CLASS:  ok = appendNativeInt<uint64_t>( value ); break;
+            case mxSINGLE_CLASS:
+                ok = (sqlite3_int64)(float)value == value;
+                if( ok )
+                {
+                    *(float*)m_native.grow( sizeof(float) ) = (float)value;
+                }
+                break;
+            default:
+                assert( false );
+                break;
+        }
+        
+        if( ok && m_isMasked )
+        {
+            m_isnull.push_back( false );
+        }
+        
+        return ok;
+    }
+    
+    /// Appends a floating point value to a column of MATLAB class \a m_class
+    bool appendNative( double value )
+    {
+        if( m_class == mxSINGLE_CLASS )
+        {
+            float item = (float)value;
+            
+            // overflow check (precision loss is intended by declared type)
+            if( DBL_ISINF( (double)item ) && !DBL_ISINF( value ) )
+            {
+                return false;
+            }
+            
+            *(float*)m_native.grow( sizeof(float) ) = item;
+            
+            if( m_isMasked )
+            {
+                m_isnull.push_back( false );
+            }
+            return true;
+        }
+        
+        // integer classes take integral values only
+        if( value != floor( value ) || fabs( value ) >= 9.2233720368547758e18 )
+        {
+            return false;
+        }
+        
+        return appendNative( (sqlite3_int64)value );
+    }
+    
+    /// Appends a NULL to a column of MATLAB class \a m_class (masked columns only)
+    bool appendNativeNull()
+    {
+        if( !m_isMasked )
+        {
+            return false;
+        }
+        
+        unsigned char* item = m_native.grow( classSize( m_class ) );
+        
+        if( m_class == mxSINGLE_CLASS )
+        {
+            *(float*)item = (float)DBL_NAN;
+        }
+        else
+        {
+            memset( item, 0, classSize( m_class ) );
+        }
+        
+        m_isnull.push_back( true );
+        m_nullCount++;
+        return true;
+    }
+    
+    /**
+     * \brief Transform storage from MATLAB class \a m_class to common storage
+     *
+     * Each row element is appended again with common storage rules.
+     */
+    void swapFromNative()
+    {
+        if( isNative() )
+        {
+            ValueSQLBuffer<unsigned char> native;
+            ValueSQLBuffer<mxLogical>     isnull;
+            mxClassID classID = m_class;
+            int rows = (int)size();
+            
+            native.swap( m_native );
+            isnull.swap( m_isnull );
+            m_class     = mxUNKNOWN_CLASS;
+            m_nullCount = 0;
+            
+            for( int i = 0; i < rows; i++ )
+            {
+                if( isnull.size() && isnull[i] )
+                {
+                    appendNull();
+                }
+                else
+                {
+                    append( (const ValueSQL&)nativeItem( native.data(), classID, i ) );
+                }
+            }
+        }
     }
     
     /**
      * \brief Transform storage type
      *
-     * Switches from pure double representation to individual value types.
+     * Switches from pure double (or int64) representation to individual value types.
      * Each former double element will be converted to ValueSQL type.
      */
     void swapToAnyType()
     {
+        swapFromDict();
+        swapFromNative();
+        
         if( !m_isAnyType )
         {
             assert( !m_any.size() );
             
             // convert each element to ValueSQL type
-            for( int i = 0; i < (int)m_float.size(); i++ )
+            for( int i = 0; i < (int)size(); i++ )
             {
-                m_any.push_back( ValueSQL(m_float[i]) );
+                m_any.push_back( (*this)[i] );
             }
 
             // clear old value vector (double types) and flag new column type
             m_float.clear();
+            m_int.clear();
+            m_isnull.clear();
             m_isAnyType = true;
+            m_isInteger = false;
+            m_nullCount = 0;
+        }
+    }
+    
+    /**
+     * \brief Transform storage type from int64 to double (typed columns only)
+     *
+     * If any integer has no precise double representation, the column is
+     * transformed to individual value types.
+     */
+    void swapToFloatType()
+    {
+        if( !m_isAnyType && m_isInteger )
+        {
+            // Test if all integer values can be represented as double type
+            for( int i = 0; i < (int)m_int.size(); i++ )
+            {
+                if( (sqlite3_int64)(double)m_int[i] != m_int[i] )
+                {
+                    swapToAnyType();
+                    return;
+                }
+            }
+
+            m_float.reserve( m_int.size() );
+            for( int i = 0; i < (int)m_int.size(); i++ )
+            {
+                m_float.push_back( isNull(i) ? DBL_NAN : (double)m_int[i] );
+            }
+
+            m_int.clear();
+            m_isInteger = false;
+        }
+    }
+    
+    /**
+     * \brief Transform storage type from double to int64 (typed columns only)
+     *
+     * Only permitted as long as all row elements are NULL.
+     */
+    void swapToIntegerType()
+    {
+        if( !m_isAnyType && !m_isInteger )
+        {
+            assert( m_float.size() == m_nullCount );
+            
+            m_int.reserve( m_float.size() );
+            for( int i = 0; i < (int)m_float.size(); i++ )
+            {
+                m_int.push_back( 0 );
+            }
+
+            m_float.clear();
+            m_isInteger = true;
+        }
+    }
+    
+    /// Appends a NULL row element to masked column
+    void appendNull()
+    {
+        assert( m_isMasked );
+        
+        if( m_isAnyType )
+        {
+            m_any.push_back( ValueSQL() );
+        }
+        else
+        {
+            if( m_isInteger )
+            {
+                m_int.push_back( 0 );
+            }
+            else
+            {
+                m_float.push_back( DBL_NAN );
+            }
+            m_isnull.push_back( true );
+            m_nullCount++;
         }
     }
     
     /// Appends a new row element (floating point)
     void append( double value )
     {
+        swapFromDict();
+        
+        if( isNative() )
+        {
+            if( appendNative( value ) ) return;
+            swapFromNative();  // not representable, fall back
+        }
+        
         if( m_isAnyType )
         {
             m_any.push_back( ValueSQL(value) );
         }
         else
         {
+            if( m_isInteger )
+            {
+                // typed column with mixed integer and floating point values
+                swapToFloatType();
+                
+                if( m_isAnyType )
+                {
+                    m_any.push_back( ValueSQL(value) );
+                    return;
+                }
+            }
+            
             m_float.push_back( value );
+            
+            if( m_isMasked )
+            {
+                m_isnull.push_back( false );
+            }
         }
     }
     
     /// Appends a new row element (integer)
     void append( sqlite3_int64 value )
     {
+        swapFromDict();
+        
+        if( isNative() )
+        {
+            if( appendNative( value ) ) return;
+            swapFromNative();  // not representable, fall back
+        }
+        
+        if( m_isTyped && !m_isAnyType && !m_isInteger && m_float.size() == m_nullCount )
+        {
+            // first non-NULL value of typed column is an integer
+            swapToIntegerType();
+        }
+        
+        if( m_isInteger && !m_isAnyType )
+        {
+            m_int.push_back( value );
+            m_isnull.push_back( false );
+            return;
+        }
+        
         /* Test if integer value can be represented as double type */
         double    dVal  = (double)(value);
         long long llVal = (sqlite3_int64) dVal;
@@ -1201,7 +1881,23 @@ public:
             return;
             
           case SQLITE_NULL:
-            if( g_NULLasNaN )
+            if( m_isDict )
+            {
+                m_codes.push_back( 0 );
+                return;  // NULL is code 0
+            }
+            
+            if( isNative() && appendNativeNull() )
+            {
+                return;  // NULL is masked
+            }
+            swapFromNative();  // not representable, fall back
+            
+            if( m_isMasked )
+            {
+                appendNull();
+            }
+            else if( g_NULLasNaN )
             {
                 append( DBL_NAN );
             }